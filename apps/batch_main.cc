@@ -0,0 +1,52 @@
+#include <core/batch_runner.h>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+
+using idealgas::BatchRunner;
+using idealgas::RunConfig;
+using idealgas::SpeciesConfig;
+
+/* Headless parameter sweep: num_seeds runs at each of several initial speeds, with the app's three species scaled
+   down to a small box. With a check interval, each run stops early once every species has equilibrated.
+   Usage: ideal-gas-batch output.csv [num_seeds] [num_steps] [num_threads] [equilibrium_check_interval] */
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "usage: " << argv[0] << " output.csv [num_seeds] [num_steps] [num_threads] [equilibrium_check_interval]" << std::endl;
+        return 1;
+    }
+
+    std::ofstream out(argv[1]);
+    if (!out) {
+        std::cerr << "couldn't open " << argv[1] << std::endl;
+        return 1;
+    }
+    size_t num_seeds = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 100;
+    size_t num_steps = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 2000;
+    size_t num_threads = argc > 4 ? std::strtoul(argv[4], nullptr, 10) : 0;
+    size_t equilibrium_check_interval = argc > 5 ? std::strtoul(argv[5], nullptr, 10) : 0;
+
+    const float kInitialSpeeds[] = {1.0f, 2.5f, 5.0f};
+    vector<SpeciesConfig> species = {{1, 40, 10, 5}, {2, 20, 50, 10}, {3, 15, 300, 15}};
+
+    vector<RunConfig> configs;
+    for (float speed : kInitialSpeeds) {
+        for (size_t seed = 0; seed < num_seeds; ++seed) {
+            RunConfig config;
+            config.run_id = configs.size();
+            config.seed = static_cast<uint32_t>(seed);
+            config.num_steps = num_steps;
+            config.box_width = 300;
+            config.max_initial_speed = speed;
+            config.species = species;
+            config.num_bins = 9;
+            config.equilibrium_check_interval = equilibrium_check_interval;
+            configs.push_back(config);
+        }
+    }
+
+    BatchRunner runner(out, num_threads);
+    runner.Run(configs);
+    std::cout << "wrote " << runner.GetNumCompleted() << " runs to " << argv[1] << std::endl;
+    return 0;
+}
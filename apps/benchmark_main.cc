@@ -0,0 +1,83 @@
+#include <core/performance_scenarios.h>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+
+using idealgas::PerformanceResult;
+using idealgas::PerformanceScenario;
+
+/* Headless benchmark: runs the performance suite's scenarios and prints their throughput. With --compare, each
+   scenario's speedup over a results file written by another build (e.g. Debug) is printed too, along with the
+   geometric mean over all scenarios; --output writes this build's results in the same format. Also the training
+   run for PGO builds (see the pgo target).
+   Usage: ideal-gas-benchmark [--runs n] [--output results.txt] [--compare reference.txt] */
+int main(int argc, char* argv[]) {
+    size_t num_runs = 3;
+    const char* output_path = nullptr;
+    const char* compare_path = nullptr;
+    for (int i = 1; i < argc; ++i) {
+        bool has_value = i + 1 < argc;
+        if (has_value && std::strcmp(argv[i], "--runs") == 0) {
+            num_runs = std::strtoul(argv[++i], nullptr, 10);
+        } else if (has_value && std::strcmp(argv[i], "--output") == 0) {
+            output_path = argv[++i];
+        } else if (has_value && std::strcmp(argv[i], "--compare") == 0) {
+            compare_path = argv[++i];
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--runs n] [--output results.txt] [--compare reference.txt]" << std::endl;
+            return 1;
+        }
+    }
+
+    std::map<string, PerformanceResult> references;
+    if (compare_path != nullptr) {
+        references = idealgas::ReadPerformanceResults(compare_path);
+        if (references.empty()) {
+            std::cerr << "no results in " << compare_path << std::endl;
+            return 1;
+        }
+    }
+    std::ofstream out;
+    if (output_path != nullptr) {
+        out.open(output_path);
+        if (!out) {
+            std::cerr << "couldn't open " << output_path << std::endl;
+            return 1;
+        }
+        out << "# scenario steps_per_second collisions, written by ideal-gas-benchmark\n";
+    }
+
+    double log_speedup_sum = 0;
+    size_t num_compared = 0;
+    std::cout << std::fixed << std::setprecision(1);
+    for (const PerformanceScenario& scenario : idealgas::kPerformanceScenarios) {
+        PerformanceResult result = {idealgas::MeasureStepsPerSecond(scenario, num_runs), idealgas::CountScenarioCollisions(scenario)};
+        if (out.is_open()) idealgas::WritePerformanceResult(out, scenario.name, result);
+
+        std::cout << std::left << std::setw(26) << scenario.name << std::right << std::setw(10) << result.steps_per_second
+                  << " steps/s";
+        if (references.count(scenario.name) > 0) {
+            const PerformanceResult& reference = references[scenario.name];
+            double speedup = result.steps_per_second / reference.steps_per_second;
+            log_speedup_sum += std::log(speedup);
+            num_compared++;
+            std::cout << std::setw(10) << reference.steps_per_second << " reference  " << std::setprecision(2) << speedup
+                      << "x" << std::setprecision(1);
+            //the builds did different work (different precision, or the physics changed), so timings don't compare
+            if (reference.num_collisions != result.num_collisions) {
+                std::cout << "  (collisions " << result.num_collisions << " vs " << reference.num_collisions << ")";
+            }
+        }
+        std::cout << std::endl;
+    }
+
+    if (num_compared > 0) {
+        std::cout << "geometric mean speedup over " << compare_path << ": " << std::setprecision(2)
+                  << std::exp(log_speedup_sum / num_compared) << "x" << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,137 @@
+#include <core/frame_encoder.h>
+#include <core/frame_rasterizer.h>
+#include <core/histogram_reducer.h>
+#include <core/maxwell_boltzmann_fit.h>
+#include <core/particle_controller.h>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+using idealgas::CaptureSink;
+using idealgas::FrameEncoder;
+using idealgas::FrameRasterizer;
+using idealgas::FullQueuePolicy;
+using idealgas::Histogram;
+using idealgas::HistogramReducer;
+using idealgas::MaxwellBoltzmannFit;
+using idealgas::Particle;
+using idealgas::ParticleController;
+using idealgas::ParticleSpecies;
+using idealgas::PlacementStrategy;
+
+/* What one frame shows, copied from the simulation so the frame can be drawn on the encoder thread while the
+   simulation moves on */
+struct CapturedState {
+    vector<Particle> particles;
+    float piston_x;
+    vector<vector<float>> bin_frequencies; //per species
+    vector<vector<float>> expected_frequencies; //per species, empty before the first fit
+};
+
+/* Headless capture: runs the app's box without a window or GPU and draws each frame on the CPU in the app's layout
+   (without text). Drawing and encoding happen on a background thread, the simulation only copies what each frame
+   shows. Frames the encoder can't keep up with are dropped, up to 16 can wait; --wait makes the simulation wait
+   for room instead, so a movie made offline doesn't skip. --until-equilibrated ends the capture early, once every
+   species' speeds match a Maxwell-Boltzmann distribution.
+   Usage: ideal-gas-capture [--wait] [--until-equilibrated] frames/run_ [num_frames]        (PNG sequence frames/run_000000.png...)
+          ideal-gas-capture [--wait] [--until-equilibrated] --pipe "ffmpeg -f rawvideo -pix_fmt rgb24 -s 1300x900 -r 60 -i - run.mp4" [num_frames] */
+int main(int argc, char* argv[]) {
+    bool is_pipe = false;
+    bool should_stop_at_equilibrium = false;
+    FullQueuePolicy policy = FullQueuePolicy::kDrop;
+    int target_arg = 1;
+    for (; target_arg < argc && std::strncmp(argv[target_arg], "--", 2) == 0; ++target_arg) {
+        if (std::strcmp(argv[target_arg], "--pipe") == 0) {
+            is_pipe = true;
+        } else if (std::strcmp(argv[target_arg], "--until-equilibrated") == 0) {
+            should_stop_at_equilibrium = true;
+        } else if (std::strcmp(argv[target_arg], "--wait") == 0) {
+            policy = FullQueuePolicy::kWait;
+        } else {
+            target_arg = argc; //unknown flag, show usage
+        }
+    }
+    if (argc <= target_arg) {
+        std::cerr << "usage: " << argv[0] << " [--wait] [--until-equilibrated] output_prefix [num_frames]" << std::endl
+                  << "       " << argv[0] << " [--wait] [--until-equilibrated] --pipe \"encoder command reading rgb24 1300x900 from stdin\" [num_frames]" << std::endl;
+        return 1;
+    }
+    size_t num_frames = argc > target_arg + 1 ? std::strtoul(argv[target_arg + 1], nullptr, 10) : 600;
+
+    //same window and layout as IdealGasApp
+    const size_t kWindowWidth = 1300;
+    const size_t kWindowHeight = 900;
+    const size_t kMargin = 80;
+    const size_t kBoxWidth = kWindowHeight - 2 * kMargin;
+    const glm::vec2 kBoxTopLeft(kMargin - 30, kMargin);
+    const float kBoxBorderWidth = 25;
+    const size_t kHistWidth = 405;
+    const size_t kHistHeight = 210;
+    const glm::vec2 kHistTopLeft(kMargin + kBoxWidth + 50, kMargin);
+
+    ParticleController particle_controller(kBoxWidth, kBoxTopLeft, kBoxBorderWidth - 10, PlacementStrategy::kLatticeJitter);
+    particle_controller.SetHierarchicalGrid(true);
+
+    //one histogram and fit per species, in type order, as in Histograms
+    const vector<size_t> kTypes = {1, 2, 3};
+    vector<Histogram> histograms = idealgas::MakeSpeciesHistograms(particle_controller, kTypes);
+    vector<MaxwellBoltzmannFit> fits;
+    vector<cinder::Colorf> colors;
+    for (const size_t type : kTypes) {
+        ParticleSpecies species = particle_controller.GetSpecies(type);
+        fits.push_back(MaxwellBoltzmannFit(species.mass));
+        colors.push_back(species.color);
+    }
+    HistogramReducer reducer;
+
+    try {
+        //only used by frames being drawn on the encoder thread, and outlives the encoder
+        FrameRasterizer rasterizer(kWindowWidth, kWindowHeight);
+        FrameEncoder encoder(argv[target_arg], is_pipe ? CaptureSink::kPipe : CaptureSink::kPngSequence, kWindowWidth, kWindowHeight,
+                             16, policy);
+
+        bool is_equilibrated = false;
+        size_t num_skipped = 0;
+        for (size_t frame = 0; frame < num_frames && !(should_stop_at_equilibrium && is_equilibrated); ++frame) {
+            particle_controller.UpdateParticles();
+            reducer.Reduce(histograms, particle_controller.GetParticles());
+            is_equilibrated = MaxwellBoltzmannFit::UpdateAll(fits, histograms);
+
+            //a frame that would be dropped isn't worth copying the state for
+            if (encoder.IsFull()) {
+                num_skipped++;
+                continue;
+            }
+
+            //shared rather than captured by value, so the particles are copied once
+            std::shared_ptr<CapturedState> state = std::make_shared<CapturedState>();
+            state->particles = particle_controller.GetParticles();
+            state->piston_x = particle_controller.GetXMax();
+            for (size_t i = 0; i < histograms.size(); ++i) {
+                state->bin_frequencies.push_back(histograms[i].GetBinFrequencies());
+                state->expected_frequencies.push_back(fits[i].GetLastFit().expected_frequencies);
+            }
+            encoder.Submit([&, state](vector<uint8_t>& rgb) {
+                rasterizer.Clear(cinder::Colorf(0, 0, 0));
+                rasterizer.DrawBox(state->particles, kBoxTopLeft, kBoxWidth, kBoxBorderWidth, state->piston_x);
+                glm::vec2 hist_top_left = kHistTopLeft;
+                for (size_t i = 0; i < state->bin_frequencies.size(); ++i) {
+                    rasterizer.DrawHistogram(state->bin_frequencies[i], state->expected_frequencies[i], hist_top_left,
+                                             kHistWidth, kHistHeight, colors[i]);
+                    hist_top_left.y += kHistHeight + 73;
+                }
+                rgb = rasterizer.GetPixels();
+            });
+        }
+
+        encoder.Finish();
+        std::cout << "captured " << encoder.GetNumEncoded() << " frames, dropped " << encoder.GetNumDropped() + num_skipped
+                  << (is_equilibrated ? ", equilibrated" : "") << std::endl;
+    } catch (const std::exception& e) {
+        std::cerr << "capture failed: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
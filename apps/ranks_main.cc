@@ -0,0 +1,129 @@
+#include <core/domain_decomposition.h>
+#include <core/particle_placer.h>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+
+#ifdef IDEALGAS_WITH_MPI
+#include <mpi.h>
+#endif
+
+using idealgas::DomainDecomposition;
+using idealgas::Particle;
+using idealgas::ParticlePlacer;
+using idealgas::ParticleTransport;
+
+/* Size of the box and its particles, the same on every rank */
+struct RanksConfig {
+    int num_ranks = 2;
+    size_t num_particles = 2000;
+    size_t num_steps = 500;
+    float box_width = 800;
+    float box_height = 200;
+    float radius = 1;
+    uint32_t seed = 1;
+};
+
+/* Every rank places the whole box's particles from the same seed, keeps its slab's share and steps it, so no
+   particles have to be sent at the start */
+static vector<Particle> RunRank(ParticleTransport& transport, const RanksConfig& config) {
+    ParticlePlacer placer(0, config.box_width, 0, config.box_height, config.seed);
+    vector<Particle> particles = placer.MakeParticles({{1, config.num_particles, 1, config.radius, 2, cinder::Colorf(1, 1, 1)}});
+
+    DomainDecomposition domain(transport, particles, 0, config.box_width, 0, config.box_height, 2 * config.radius);
+    for (size_t step = 0; step < config.num_steps; ++step) {
+        domain.Step();
+    }
+    std::cout << "rank " << transport.GetRank() << ": " << domain.GetController().GetParticles().size()
+              << " particles, " << domain.GetNumMigrated() << " migrated" << std::endl;
+    return domain.GetController().GetParticles();
+}
+
+/* Particles can only move between slabs, so a total that changed means some were lost or duplicated */
+static int CheckTotal(const size_t num_particles, const RanksConfig& config) {
+    std::cout << num_particles << " particles on " << config.num_ranks << " ranks after " << config.num_steps
+              << " steps" << std::endl;
+    if (num_particles != config.num_particles) {
+        std::cerr << "expected " << config.num_particles << " particles" << std::endl;
+        return 1;
+    }
+    return 0;
+}
+
+/* Headless domain decomposition: the box is split along x into one slab per rank. By default the ranks are forked
+   processes on this machine connected by UNIX sockets; with --mpi (builds with IDEALGAS_WITH_MPI) they are the
+   processes of an MPI job, e.g. mpiexec -n 4 ideal-gas-ranks --mpi. Exits non-zero if particles were lost.
+   Usage: ideal-gas-ranks [--ranks n] [--particles n] [--steps n] [--width px] [--height px] [--seed n] [--mpi] */
+int main(int argc, char* argv[]) {
+    RanksConfig config;
+    bool is_mpi = false;
+    for (int i = 1; i < argc; ++i) {
+        bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--mpi") == 0) {
+            is_mpi = true;
+        } else if (has_value && std::strcmp(argv[i], "--ranks") == 0) {
+            config.num_ranks = std::atoi(argv[++i]);
+        } else if (has_value && std::strcmp(argv[i], "--particles") == 0) {
+            config.num_particles = std::strtoul(argv[++i], nullptr, 10);
+        } else if (has_value && std::strcmp(argv[i], "--steps") == 0) {
+            config.num_steps = std::strtoul(argv[++i], nullptr, 10);
+        } else if (has_value && std::strcmp(argv[i], "--width") == 0) {
+            config.box_width = std::strtof(argv[++i], nullptr);
+        } else if (has_value && std::strcmp(argv[i], "--height") == 0) {
+            config.box_height = std::strtof(argv[++i], nullptr);
+        } else if (has_value && std::strcmp(argv[i], "--seed") == 0) {
+            config.seed = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else {
+            std::cerr << "usage: " << argv[0] << " [--ranks n] [--particles n] [--steps n] [--width px] [--height px]"
+                      << " [--seed n] [--mpi]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (is_mpi) {
+#ifdef IDEALGAS_WITH_MPI
+        MPI_Init(&argc, &argv);
+        int exit_code = 0;
+        try {
+            idealgas::MpiTransport transport;
+            config.num_ranks = transport.GetNumRanks();
+            unsigned long long num_local = RunRank(transport, config).size();
+            unsigned long long num_particles = 0;
+            MPI_Reduce(&num_local, &num_particles, 1, MPI_UNSIGNED_LONG_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+            if (transport.GetRank() == 0) exit_code = CheckTotal(num_particles, config);
+        } catch (const std::exception& e) {
+            std::cerr << e.what() << std::endl;
+            MPI_Abort(MPI_COMM_WORLD, 1);
+        }
+        MPI_Finalize();
+        return exit_code;
+#else
+        std::cerr << "this build has no MPI transport, configure with -DIDEALGAS_WITH_MPI=ON" << std::endl;
+        return 1;
+#endif
+    }
+
+#ifndef _WIN32
+    if (config.num_ranks < 1) {
+        std::cerr << "--ranks must be at least 1" << std::endl;
+        return 1;
+    }
+    try {
+        vector<vector<Particle>> results = idealgas::RunForkedRanks(config.num_ranks, [&](ParticleTransport& transport) {
+            return RunRank(transport, config);
+        });
+        size_t num_particles = 0;
+        for (const vector<Particle>& particles : results) {
+            num_particles += particles.size();
+        }
+        return CheckTotal(num_particles, config);
+    } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+#else
+    std::cerr << "ranks on one machine need UNIX sockets, use --mpi" << std::endl;
+    return 1;
+#endif
+}
@@ -0,0 +1,94 @@
+# Profile guided Release build, run by the pgo target:
+#   1. a Debug build of ideal-gas-benchmark measures the reference throughput
+#   2. an instrumented Release build runs the benchmark scenarios once, writing profiles
+#   3. the same build directory is reconfigured to use the profiles and every target is rebuilt (GCC finds profiles
+#      by object path, so it has to be the same directory)
+#   4. the tuned ideal-gas-benchmark reports its speedup over Debug
+# Can also be run by hand: cmake -D SOURCE_DIR=. -D WORK_DIR=build/pgo [-D NATIVE=ON] -P cmake/pgo_build.cmake
+
+foreach(required SOURCE_DIR WORK_DIR)
+    if(NOT DEFINED ${required})
+        message(FATAL_ERROR "pgo_build.cmake needs -D ${required}=...")
+    endif()
+endforeach()
+
+set(PROFILE_DIR "${WORK_DIR}/profiles")
+set(DEBUG_DIR "${WORK_DIR}/debug")
+set(TUNED_DIR "${WORK_DIR}/tuned")
+set(DEBUG_RESULTS "${WORK_DIR}/debug_results.txt")
+
+# Configure options forwarded from the build the target was run in
+set(CONFIGURE_ARGS "")
+if(GENERATOR)
+    list(APPEND CONFIGURE_ARGS -G ${GENERATOR})
+endif()
+if(C_COMPILER)
+    list(APPEND CONFIGURE_ARGS -D CMAKE_C_COMPILER=${C_COMPILER})
+endif()
+if(CXX_COMPILER)
+    list(APPEND CONFIGURE_ARGS -D CMAKE_CXX_COMPILER=${CXX_COMPILER})
+endif()
+foreach(option PRECISION NATIVE LTO)
+    if(DEFINED ${option})
+        list(APPEND CONFIGURE_ARGS -D IDEALGAS_${option}=${${option}})
+    endif()
+endforeach()
+
+function(run_step description)
+    message(STATUS "pgo: ${description}")
+    execute_process(COMMAND ${ARGN} RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "pgo: ${description} failed (${result})")
+    endif()
+endfunction()
+
+function(configure_build dir build_type pgo)
+    file(MAKE_DIRECTORY ${dir})
+    message(STATUS "pgo: configuring ${dir} as ${build_type}, IDEALGAS_PGO=${pgo}")
+    execute_process(COMMAND ${CMAKE_COMMAND} ${CONFIGURE_ARGS} -D CMAKE_BUILD_TYPE=${build_type}
+                            -D IDEALGAS_PGO=${pgo} -D IDEALGAS_PGO_DIR=${PROFILE_DIR} ${SOURCE_DIR}
+                    WORKING_DIRECTORY ${dir}
+                    RESULT_VARIABLE result)
+    if(NOT result EQUAL 0)
+        message(FATAL_ERROR "pgo: configuring ${dir} failed (${result})")
+    endif()
+endfunction()
+
+# Builds the given targets, or everything if there are none
+function(build dir build_type)
+    set(targets "")
+    foreach(target ${ARGN})
+        list(APPEND targets --target ${target})
+    endforeach()
+    run_step("building ${dir}" ${CMAKE_COMMAND} --build ${dir} --config ${build_type} --parallel ${targets})
+endfunction()
+
+function(run_benchmark dir build_type description)
+    file(READ "${dir}/ideal-gas-benchmark-${build_type}.path" benchmark)
+    run_step(${description} ${benchmark} ${ARGN})
+endfunction()
+
+configure_build(${DEBUG_DIR} Debug OFF)
+build(${DEBUG_DIR} Debug ideal-gas-benchmark)
+run_benchmark(${DEBUG_DIR} Debug "measuring the Debug build" --output ${DEBUG_RESULTS})
+
+# Stale profiles would be merged with (GCC) or override (Clang) the new ones
+file(REMOVE_RECURSE ${PROFILE_DIR})
+configure_build(${TUNED_DIR} Release GENERATE)
+build(${TUNED_DIR} Release ideal-gas-benchmark)
+run_benchmark(${TUNED_DIR} Release "training on the benchmark scenarios" --runs 1)
+
+if(COMPILER_ID MATCHES "Clang")
+    get_filename_component(compiler_dir "${CXX_COMPILER}" DIRECTORY)
+    find_program(LLVM_PROFDATA NAMES llvm-profdata HINTS ${compiler_dir})
+    if(NOT LLVM_PROFDATA)
+        message(FATAL_ERROR "pgo: Clang profiles need llvm-profdata to merge them, which wasn't found")
+    endif()
+    file(GLOB raw_profiles "${PROFILE_DIR}/*.profraw")
+    run_step("merging profiles" ${LLVM_PROFDATA} merge -output=${PROFILE_DIR}/default.profdata ${raw_profiles})
+endif()
+
+configure_build(${TUNED_DIR} Release USE)
+build(${TUNED_DIR} Release)
+run_benchmark(${TUNED_DIR} Release "measuring the tuned build" --compare ${DEBUG_RESULTS})
+message(STATUS "pgo: tuned binaries are in ${TUNED_DIR}")
@@ -0,0 +1,117 @@
+#ifndef IDEALGAS_CAPI_IDEALGAS_H
+#define IDEALGAS_CAPI_IDEALGAS_H
+
+/* C interface to the physics core (libidealgas), for driving a box from other languages and services without
+   Cinder or C++ in the caller. Only opaque handles, plain C types and views into the library's own storage cross
+   the boundary: particle data is never copied, callers read it in place through strided views.
+
+   Functions that can fail return an idealgas_status; idealgas_last_error describes the last failure on the
+   calling thread. A box must only be used by one thread at a time. */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(_WIN32)
+#if defined(IDEALGAS_BUILDING_LIBRARY)
+#define IDEALGAS_API __declspec(dllexport)
+#else
+#define IDEALGAS_API __declspec(dllimport)
+#endif
+#else
+#define IDEALGAS_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Bumped whenever a function or struct in this header changes incompatibly */
+#define IDEALGAS_API_VERSION 1
+
+typedef enum idealgas_status {
+    IDEALGAS_OK = 0,
+    IDEALGAS_INVALID_ARGUMENT = 1, /* null handle or pointer, out of range index, negative size... */
+    IDEALGAS_INVALID_STATE = 2, /* e.g. adding a species after particles have been placed */
+    IDEALGAS_OUT_OF_MEMORY = 3,
+    IDEALGAS_INTERNAL_ERROR = 4
+} idealgas_status;
+
+/* Type of each component of a view's elements */
+typedef enum idealgas_scalar_type {
+    IDEALGAS_FLOAT32 = 0,
+    IDEALGAS_FLOAT64 = 1,
+    IDEALGAS_FIXED32 = 2, /* int32_t fixed point, value = raw / 2^fraction_bits */
+    IDEALGAS_UINT32 = 3,
+    IDEALGAS_SIZE_T = 4
+} idealgas_scalar_type;
+
+/* Read-only view of one field of every particle, in the library's storage order. Element i's first component is
+   at (const char*)data + i * stride, and its other components follow it directly. A view stays valid until the
+   box is next stepped or destroyed (stepping may move particles around in storage), so get a new one after each
+   step; getting one is O(1) */
+typedef struct idealgas_view {
+    const void* data; /* NULL if there are no particles */
+    size_t count;
+    size_t stride; /* bytes between consecutive elements */
+    size_t num_components; /* 2 for positions and velocities, 1 otherwise */
+    idealgas_scalar_type type;
+    int fraction_bits; /* only for IDEALGAS_FIXED32 */
+} idealgas_view;
+
+/* Opaque handle to a box of particles */
+typedef struct idealgas_box idealgas_box;
+
+/* IDEALGAS_API_VERSION the library was built with, for checking it matches the header */
+IDEALGAS_API uint32_t idealgas_api_version(void);
+
+/* Message describing the last failed call on this thread, "" if there wasn't one. Owned by the library */
+IDEALGAS_API const char* idealgas_last_error(void);
+
+/* Creates an empty box spanning [0, width] x [0, height], whose species' speeds are binned into num_bins bins.
+   The seed picks initial positions and velocities. Returns NULL on failure */
+IDEALGAS_API idealgas_box* idealgas_box_create(float width, float height, size_t num_bins, uint32_t seed);
+
+/* Destroys a box and everything viewed through it, NULL is ignored */
+IDEALGAS_API void idealgas_box_destroy(idealgas_box* box);
+
+/* Adds a species of count particles, with each velocity component starting uniform in
+   [-max_initial_speed, max_initial_speed]. Species get types 1, 2, 3... in the order they're added, and can only
+   be added before the first step */
+IDEALGAS_API idealgas_status idealgas_box_add_species(idealgas_box* box, float mass, float radius, size_t count,
+                                                      float max_initial_speed);
+
+/* Advances the box num_steps steps, then bins every species' speeds. The first call places the particles without
+   overlaps (num_steps can be 0 to only place them) */
+IDEALGAS_API idealgas_status idealgas_box_step(idealgas_box* box, size_t num_steps);
+
+/* Like idealgas_box_step, but fits every species' speeds to a Maxwell-Boltzmann distribution every check_interval
+   steps and stops early once all of them have equilibrated (matched the fit 30 times in a row), e.g. so headless
+   runs don't step longer than needed. Runs at most max_steps steps, and sets *num_steps (if not NULL) to the number
+   run; whether equilibrium was reached is given by idealgas_box_is_equilibrated */
+IDEALGAS_API idealgas_status idealgas_box_step_until_equilibrated(idealgas_box* box, size_t max_steps, size_t check_interval,
+                                                                  size_t* num_steps);
+
+/* 1 once idealgas_box_step_until_equilibrated has found every species equilibrated, else 0 */
+IDEALGAS_API int idealgas_box_is_equilibrated(const idealgas_box* box);
+
+/* Number of particles (0 before the first step) and mean kinetic energy per particle measured in the last step */
+IDEALGAS_API size_t idealgas_box_num_particles(const idealgas_box* box);
+IDEALGAS_API float idealgas_box_temperature(const idealgas_box* box);
+
+/* Views of every particle's position (x, y), velocity (x, y), stable id, and type (species) */
+IDEALGAS_API idealgas_status idealgas_box_positions(const idealgas_box* box, idealgas_view* view);
+IDEALGAS_API idealgas_status idealgas_box_velocities(const idealgas_box* box, idealgas_view* view);
+IDEALGAS_API idealgas_status idealgas_box_ids(const idealgas_box* box, idealgas_view* view);
+IDEALGAS_API idealgas_status idealgas_box_types(const idealgas_box* box, idealgas_view* view);
+
+/* Histogram of the speeds of species species_index (type - 1) as of the last step: speeds points to the
+   num_bins + 1 bin edges, frequencies to the fraction of the species in each of the num_bins bins. Both stay valid
+   until the next step */
+IDEALGAS_API idealgas_status idealgas_box_histogram(const idealgas_box* box, size_t species_index, const float** speeds,
+                                                    const float** frequencies, size_t* num_bins);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <vector>
+#include "histogram.h"
+#include "particle_placer.h"
+#include "work_stealing_pool.h"
+
+using std::vector;
+
+namespace idealgas {
+    /* One species of particle in a batch run */
+    struct SpeciesConfig {
+        size_t type;
+        size_t count;
+        float mass;
+        float radius;
+    };
+
+    /* Parameters of one independent run: a square box of particles placed from the seed, stepped num_steps times */
+    struct RunConfig {
+        size_t run_id;
+        uint32_t seed; //same seed, same run, whichever thread runs it
+        size_t num_steps;
+        float box_width;
+        float max_initial_speed; //each velocity component starts uniform in [-max, max]
+        vector<SpeciesConfig> species;
+        size_t num_bins;
+        PlacementStrategy placement = PlacementStrategy::kLatticeJitter; //kUniformRandom lets particles overlap
+        
+        /* 0 always runs num_steps steps. Otherwise every species' speeds are fitted to a Maxwell-Boltzmann
+           distribution every this many steps, and the run stops as soon as all of them have equilibrated (with
+           num_steps as the limit) */
+        size_t equilibrium_check_interval = 0;
+    };
+
+    /* Observables of one species at the end of a run */
+    struct SpeciesResult {
+        size_t type;
+        size_t num_particles;
+        float mean_speed;
+        vector<float> x_values;
+        vector<float> bin_frequencies;
+    };
+
+    /* Observables at the end of a run */
+    struct RunResult {
+        size_t run_id;
+        uint32_t seed;
+        float temperature;
+        size_t num_steps; //steps actually run, fewer than configured if the run stopped at equilibrium
+        bool is_equilibrated; //false if equilibrium wasn't checked for
+        vector<SpeciesResult> species;
+    };
+
+    /* Runs many independent boxes (e.g. a sweep over seeds, speeds and species mixes) on a work stealing pool, and
+       streams each run's results as CSV lines to one output as soon as the run finishes. Runs finish in any order,
+       so lines are tagged with the run id */
+    class BatchRunner {
+        public:
+            /* Writes results to out, which must outlive the runner; 0 threads means one per hardware thread */
+            explicit BatchRunner(std::ostream& out, const size_t num_threads = 0);
+
+            /* Writes the CSV header, then runs every config, returning once all are done */
+            void Run(const vector<RunConfig>& configs);
+
+            /* Runs one config on the calling thread */
+            static RunResult RunOne(const RunConfig& config);
+
+            /* Initial particles of a run, species in config order; throws std::runtime_error if they don't fit */
+            static vector<Particle> PlaceParticles(const RunConfig& config);
+
+            /* Number of runs finished so far */
+            size_t GetNumCompleted() const;
+
+        private:
+            std::ostream& out_;
+            WorkStealingPool pool_;
+
+            /* Guards out_ and num_completed_, results arrive from every pool thread */
+            mutable std::mutex out_mutex_;
+            size_t num_completed_ = 0;
+
+            /* Helper method for writing a run's CSV lines (one per species) */
+            void WriteResult(const RunResult& result);
+    };
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "particle.h"
+
+using std::vector;
+
+namespace idealgas {
+    /* Resolves an elastic collision between p1 and p2 if they are touching and moving towards each other, returns
+       true if they collided. The impulse both particles share is computed once from squared distances (no sqrt),
+       and the velocity update is the same multiply-add whether they collide or not (the impulse is just 0) */
+    bool ResolvePair(Particle& p1, Particle& p2);
+
+    /* Resolves p against each of its neighbours (particles[id_to_index[id]] for each of the num_neighbours ids) in
+       order, with the same result as calling ResolvePair for each of them in order. The neighbours are gathered
+       into fixed size batches of separate arrays so the compiler can vectorize the contact tests, and only pairs
+       that pass are resolved (after which the rest of the batch is tested again, since p's velocity changed).
+       Used for neighbour list rows and grid candidates. Returns the number of collisions */
+    size_t ResolveNeighbours(Particle& p, vector<Particle>& particles, const vector<uint32_t>& id_to_index,
+                             const uint32_t* neighbour_ids, const size_t num_neighbours);
+}
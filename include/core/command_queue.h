@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+
+using std::vector;
+
+namespace idealgas {
+    /* Kinds of runtime adjustments the simulation applies at the start of a step */
+    enum class CommandType {
+        kTemperatureRamp, //multiply temperature by value, spread evenly over num_steps steps
+        kMoveWall, //move the right wall (piston) to x = value over num_steps steps
+        kPause,
+        kResume,
+        kSingleStep //advance one step while paused
+    };
+
+    struct SimulationCommand {
+        CommandType type;
+        float value;
+        size_t num_steps;
+
+        /* Helper constructors for each kind of command */
+        static SimulationCommand TemperatureRamp(const float temperature_factor, const size_t num_steps);
+        static SimulationCommand MoveWall(const float x_max, const size_t num_steps);
+        static SimulationCommand Pause();
+        static SimulationCommand Resume();
+        static SimulationCommand SingleStep();
+    };
+
+    /* Thread-safe queue of commands: any thread (e.g. the UI) pushes, the simulation drains at step boundaries */
+    class CommandQueue {
+        public:
+            /* Adds a command to be applied at the start of the next step */
+            void Push(const SimulationCommand& command);
+
+            /* Removes and returns every queued command, in the order they were pushed */
+            vector<SimulationCommand> Drain();
+
+        private:
+            vector<SimulationCommand> commands_;
+            std::mutex mutex_;
+    };
+}
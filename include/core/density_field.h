@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "particle.h"
+
+using std::vector;
+
+namespace idealgas {
+    /* Image of where particles are, for drawing more particles than there are pixels: each pixel is the average
+       color of the particles over it, brightened by how many there are (log scale, relative to the densest pixel) */
+    class DensityField {
+        public:
+            /* Size of the image in pixels */
+            DensityField(const size_t width, const size_t height);
+
+            /* Counts every particle whose center is in [x_min, x_max) x [y_min, y_max) into the pixel it lands on
+               and rebuilds the image. Threads count into their own buffers, which are then summed per pixel */
+            void Splat(const vector<Particle>& particles, const float x_min, const float x_max, const float y_min, const float y_max);
+
+            /* Number of particles whose center is in [x_min, x_max) x [y_min, y_max), the region Splat would count,
+               stopping once it's past max_count (which is then returned plus one) */
+            static size_t CountInView(const vector<Particle>& particles, const float x_min, const float x_max, const float y_min,
+                                      const float y_max, const size_t max_count);
+
+            /* RGBA bytes, rows from the top (min y) down; pixels without particles are fully transparent */
+            const vector<uint8_t>& GetPixels() const;
+
+            /* Number of particles counted into the pixel at column x, row y in the last Splat */
+            uint32_t GetCount(const size_t x, const size_t y) const;
+
+            size_t GetWidth() const;
+            size_t GetHeight() const;
+
+        private:
+            const size_t kWidth;
+            const size_t kHeight;
+
+            /* Particles per thread below which splatting isn't split across threads */
+            const size_t kMinPerThread = 65536;
+
+            /* Per thread sums of red, green, blue and counts of each pixel */
+            vector<vector<float>> thread_colors_;
+            vector<vector<uint32_t>> thread_counts_;
+
+            vector<uint32_t> counts_;
+            vector<uint8_t> pixels_;
+    };
+}
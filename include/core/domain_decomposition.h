@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "particle_controller.h"
+#include "particle_transport.h"
+
+using std::vector;
+
+namespace idealgas {
+    /* One rank's part of a box split along x into equal slabs, one per rank. The slab is simulated by its own
+       ParticleController with open walls towards its neighbours. Every step, particles within the halo width of a
+       boundary are copied to the neighbour as ghosts so collisions across the boundary happen on both sides, and
+       particles that crossed a boundary move to the neighbour that now owns them */
+    class DomainDecomposition {
+        public:
+            /* Keeps the particles (given for the whole box or just this slab) that lie in this rank's slab;
+               halo_width should be at least the largest particle diameter */
+            DomainDecomposition(ParticleTransport& transport, const vector<Particle>& particles, const float x_min,
+                                const float x_max, const float y_min, const float y_max, const float halo_width);
+
+            /* Exchanges halos, updates the slab, then hands particles that left the slab to the neighbours.
+               Every rank has to call it, once per step */
+            void Step();
+
+            /* Controller for this slab, holds only particles this rank owns between steps */
+            ParticleController& GetController();
+
+            /* Bounds of this rank's slab, particles with kSlabXMin <= x < kSlabXMax belong to it */
+            float GetSlabXMin() const;
+            float GetSlabXMax() const;
+
+            /* Number of ghosts received in the last step and particles sent to / received from neighbours since
+               the start */
+            size_t GetNumGhosts() const;
+            size_t GetNumMigrated() const;
+
+        private:
+            ParticleTransport& transport_;
+            const float kSlabXMin;
+            const float kSlabXMax;
+            const float kHaloWidth;
+
+            ParticleController controller_;
+
+            size_t num_ghosts_ = 0;
+            size_t num_migrated_ = 0;
+
+            /* Helper methods for each part of a step */
+            void ExchangeHalos();
+            void RemoveGhosts();
+            void MigrateParticles();
+
+            /* Helper methods for picking the particles of the whole box that belong to a slab, and for slab bounds */
+            static vector<Particle> SelectSlab(const vector<Particle>& particles, const float slab_x_min, const float slab_x_max);
+            static float SlabXMin(const ParticleTransport& transport, const float x_min, const float x_max, const int rank);
+    };
+}
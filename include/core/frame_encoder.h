@@ -0,0 +1,105 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+using std::vector;
+
+namespace idealgas {
+    /* Where captured frames go */
+    enum class CaptureSink {
+        kPngSequence, //one PNG per frame: target is a path prefix, frames are <prefix>000000.png, <prefix>000001.png...
+        kPipe //raw RGB24 frames written to the stdin of the shell command in target, e.g.
+              //ffmpeg -f rawvideo -pix_fmt rgb24 -s 1300x900 -r 60 -i - run.mp4
+    };
+
+    /* What Submit does when kMaxQueuedFrames are already waiting to be encoded */
+    enum class FullQueuePolicy {
+        kDrop, //drop the new frame, so a live simulation never waits on the encoder
+        kWait //wait for room, so every frame is kept (for movies made offline)
+    };
+
+    /* Encodes frames on a background thread, so the simulation only pays for copying each frame into the queue.
+       Frames can also be drawn on that thread, from a copy of what they show */
+    class FrameEncoder {
+        public:
+            /* Throws std::runtime_error if a pipe's command can't be started */
+            FrameEncoder(const std::string& target, const CaptureSink sink, const size_t width, const size_t height,
+                         const size_t max_queued_frames = 8, const FullQueuePolicy policy = FullQueuePolicy::kDrop);
+
+            /* Finishes encoding queued frames; errors are only reported by Finish */
+            ~FrameEncoder();
+
+            FrameEncoder(const FrameEncoder&) = delete;
+            FrameEncoder& operator=(const FrameEncoder&) = delete;
+
+            /* Queues a frame of RGB bytes (rows from the top), returns false if it was dropped */
+            bool Submit(const vector<uint8_t>& rgb);
+
+            /* Queues a frame that the encoder thread draws by calling draw, which fills rgb like the bytes passed to
+               the other Submit. draw should hold copies of what it shows (anything it shares with the caller, e.g. a
+               rasterizer, must only be used by draw), returns false if it was dropped */
+            bool Submit(std::function<void(vector<uint8_t>& rgb)> draw);
+
+            /* Returns true if a frame submitted now would be dropped (never under kWait, which waits for room).
+               Only the encoder thread takes frames off the queue, so until the caller submits, false stays false.
+               Callers that copy what a frame shows can check first and skip the copy; frames skipped that way
+               aren't counted by GetNumDropped */
+            bool IsFull() const;
+
+            /* Waits for every queued frame to be encoded and closes the output, then rethrows the first error the
+               encoder thread hit (e.g. a file that couldn't be written) */
+            void Finish();
+
+            size_t GetNumEncoded() const;
+            size_t GetNumDropped() const;
+
+        private:
+            const std::string kTarget;
+            const CaptureSink kSink;
+            const size_t kWidth;
+            const size_t kHeight;
+            const size_t kMaxQueuedFrames;
+            const FullQueuePolicy kPolicy;
+
+            FILE* pipe_ = nullptr;
+            std::thread encoder_thread_;
+
+            /* A frame waiting to be encoded: its bytes, or how to draw them if draw is set */
+            struct QueuedFrame {
+                vector<uint8_t> rgb;
+                std::function<void(vector<uint8_t>&)> draw;
+            };
+
+            /* Frames waiting to be encoded and counts, guarded by mutex_ */
+            mutable std::mutex mutex_;
+            std::condition_variable frame_ready_;
+            std::condition_variable frame_taken_;
+            std::deque<QueuedFrame> queue_;
+            bool is_finishing_ = false;
+            bool is_finished_ = false;
+            size_t num_encoded_ = 0;
+            size_t num_dropped_ = 0;
+            std::exception_ptr error_;
+
+            /* Helper method for queueing a frame under the full queue policy, returns false if it was dropped */
+            bool Enqueue(QueuedFrame& frame);
+
+            /* Encoder thread: takes frames off the queue until Finish is called and the queue is empty. SIGPIPE is
+               blocked on this thread, so a pipe command that exits early fails the write instead of killing the
+               process */
+            void EncodeFrames();
+
+            /* Helper method for writing one frame to the sink */
+            void EncodeFrame(const vector<uint8_t>& rgb, const size_t index);
+    };
+}
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+#include "density_field.h"
+#include "particle.h"
+
+using std::vector;
+
+namespace idealgas {
+    /* Draws frames into an RGB image on the CPU, for capturing runs on machines without a GPU or a window. Box
+       and histograms are laid out like the app's Box and Histograms, without text */
+    class FrameRasterizer {
+        public:
+            FrameRasterizer(const size_t width, const size_t height);
+
+            /* Primitives, in pixels from the top left; anything outside the image is clipped */
+            void Clear(const cinder::Colorf& color);
+            void FillRect(const float x1, const float y1, const float x2, const float y2, const cinder::Colorf& color);
+            /* Outline centered on the rectangle's edges, like gl::drawStrokedRect */
+            void StrokeRect(const float x1, const float y1, const float x2, const float y2, const float line_width, const cinder::Colorf& color);
+            void FillCircle(const glm::vec2& center, const float radius, const cinder::Colorf& color);
+            void DrawLine(const glm::vec2& start, const glm::vec2& end, const cinder::Colorf& color);
+
+            /* Box::DrawBox: particles (or a density field above kDensityThreshold particles), border, and piston
+               up to piston_x */
+            void DrawBox(const vector<Particle>& particles, const glm::vec2& top_left, const float width, const float border_width,
+                         const float piston_x);
+
+            /* Histograms::DrawHistogram: border and a bar per bin frequency, plus the fitted frequencies if there are
+               any */
+            void DrawHistogram(const vector<float>& bin_frequencies, const vector<float>& expected_frequencies, const glm::vec2& top_left,
+                               const float width, const float height, const cinder::Colorf& color);
+
+            /* RGB bytes, rows from the top */
+            const vector<uint8_t>& GetPixels() const;
+            size_t GetWidth() const;
+            size_t GetHeight() const;
+
+        private:
+            const size_t kWidth;
+            const size_t kHeight;
+            vector<uint8_t> pixels_;
+
+            /* Particles above which the box is drawn as a density field, as in Box */
+            const size_t kDensityThreshold = 20000;
+            std::unique_ptr<DensityField> density_field_; //made on first use, one texel per pixel of the box
+
+            /* Helper method for setting one pixel, if it's inside the image */
+            void SetPixel(const long x, const long y, const uint8_t r, const uint8_t g, const uint8_t b);
+    };
+}
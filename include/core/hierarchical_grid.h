@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "particle.h"
+
+using std::vector;
+
+namespace idealgas {
+    /* Broadphase for particles of very different sizes: one uniform grid per radius class, where level k has cells
+       at least 2^k px wide and holds the particles whose diameter is over 2^(k-1) and at most 2^k px, so each
+       particle sits at the finest level with cells as wide as it. A particle only has to look in the cells next
+       to it on its own level and every coarser one, and is found by the particles on finer levels, so every
+       touching pair is found and a particle's cost doesn't depend on how much bigger or smaller the others are.
+       Particles outside the bounds are kept in the nearest border cell, which still finds all their neighbours */
+    class HierarchicalGrid {
+        public:
+            HierarchicalGrid(const float x_min, const float x_max, const float y_min, const float y_max);
+
+            /* Adds p at its radius's level, in the cell containing its position */
+            void Insert(const Particle& p);
+
+            /* Removes p from the cell it was last inserted or moved into */
+            void Remove(const Particle& p);
+
+            /* Moves p into the cell containing its current position, if it has left its cell */
+            void Move(const Particle& p);
+
+            /* Replaces candidate_ids with the ids of particles on p's level and coarser levels in the cells within
+               p's radius plus the level's largest radius of p (not p itself), which includes every particle on those
+               levels that p can be touching */
+            void GatherCandidates(const Particle& p, vector<uint32_t>& candidate_ids) const;
+
+            /* Level a particle with the given radius is inserted at */
+            static size_t GetLevel(const float radius);
+
+            /* Number of levels that currently hold particles */
+            size_t GetNumLevels() const;
+
+            /* Right edge of the bounds, past which particles are kept in the last column of cells */
+            float GetXMax() const;
+
+        private:
+            /* One uniform grid, cells are stored row by row */
+            struct Level {
+                float cell_size = 0;
+                float max_radius = 0; //largest radius inserted so far
+                size_t num_cols = 0;
+                size_t num_rows = 0;
+                size_t num_particles = 0;
+                vector<vector<uint32_t>> cells;
+            };
+
+            const float kXMin;
+            const float kXMax;
+            const float kYMin;
+            const float kYMax;
+
+            /* Most cells a level can have before its cells are made wider than 2^k */
+            const size_t kMaxCellsPerLevel = 1 << 20;
+
+            /* Value in cell_of_id_ for ids that aren't in the grid */
+            static const uint32_t kNotInserted = 0xffffffff;
+
+            vector<Level> levels_;
+
+            /* Level and cell each particle (by id) is currently in */
+            vector<uint32_t> level_of_id_;
+            vector<uint32_t> cell_of_id_;
+
+            /* Helper method for making a level's cells the first time a particle is inserted at it */
+            void MakeLevel(const size_t level);
+
+            /* Helper methods for the column / row of the cell containing pos on a level, clamped to the grid */
+            size_t GetCol(const Level& level, const Real x) const;
+            size_t GetRow(const Level& level, const Real y) const;
+    };
+}
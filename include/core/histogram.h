@@ -2,26 +2,59 @@
 
 #include <vector>
 #include "particle.h"
+#include "particle_controller.h"
+#include "quantile_sketch.h"
 
 using std::vector;
 
 namespace idealgas {
+    /* How a histogram places its bin edges between the slowest and fastest speeds */
+    enum class BinningStrategy {
+        kFixedWidth, //equal width bins from min to max speed
+        kLogScale, //bin edges grow geometrically, for distributions with a long tail
+        kQuantileSketch //equal width bins between low and high quantiles, so outliers can't stretch the bins
+    };
+
     class Histogram {
         public:
-            /* Initializes particles_ vector with passed in particles */
-            Histogram(vector<Particle*> particles);
+            /* Initializes ids_ with the ids of particles in particle_controller to display, and bins them using the given strategy */
+            Histogram(ParticleController& particle_controller, vector<uint32_t> ids,
+                      BinningStrategy strategy = BinningStrategy::kFixedWidth, size_t num_bins = 9);
             
             /* Updates the values displayed by the histogram */
             void UpdateHistogram();
+            
+            /* Sets bin edges from a range of speeds that was found elsewhere (e.g. by a parallel pass); the quantile
+               sketch strategy places edges using the sketch instead, which must already hold the speeds */
+            void SetXValues(const float min_speed, const float max_speed);
+            
+            /* Sets bin frequencies from the number of particles counted in each bin elsewhere */
+            void SetBinCounts(const vector<size_t>& counts, const size_t num_particles);
+            
+            /* Adds / removes a particle from the histogram in O(1), for particles added or removed during a run */
+            void AddId(const uint32_t id);
+            void RemoveId(const uint32_t id);
+            
+            /* Returns which bin a speed falls in, using the current x values */
+            size_t GetBinIndex(const float speed) const;
 
             /* Getters */
             vector<float>& GetXValues();
             vector<float>& GetBinFrequencies();
-            vector<Particle*>& GetParticles();
+            vector<uint32_t>& GetIds();
+            BinningStrategy GetBinningStrategy() const;
+            size_t GetNumBins() const;
+            QuantileSketch& GetSketch();
             
         private:
-            /* List of particles whose info will be displayed by this histogram */
-            vector<Particle*> particles_;
+            /* Owns the particles, looks up each id's current location so particles can be reordered in storage */
+            ParticleController& particle_controller_;
+            
+            /* Stable ids of particles whose info will be displayed by this histogram */
+            vector<uint32_t> ids_;
+            
+            /* id_slots_[id] is the index of id in ids_, so ids can be swap-removed */
+            vector<size_t> id_slots_;
             
             /* List of x values of histogram (bin values, which are speeds) */
             vector<float> x_values_;
@@ -29,11 +62,30 @@ namespace idealgas {
             /* List of frequencies as percentages for each bin in x_values_, used to determine height of hist bars */
             vector<float> bin_frequencies_;
             
+            /* How bin edges are chosen */
+            const BinningStrategy kBinningStrategy;
+            
             /* Number of bins (bars) on histogram */
-            const size_t kNumBins = 9;
+            const size_t kNumBins;
+            
+            /* Bounded-memory summary of speeds, only used by the quantile sketch strategy */
+            QuantileSketch sketch_;
+            
+            /* Quantiles that bound the bins for the quantile sketch strategy, speeds outside go in the outer bins */
+            const float kLowQuantile = 0.01f;
+            const float kHighQuantile = 0.99f;
+            
+            /* Smallest first edge for log scale bins, as a fraction of max speed (log scale can't start at 0) */
+            const float kMinLogFraction = 0.001f;
             
             /* Helper methods for updating histogram */
             void SetXValues();
             void SetBinFrequencies();
+            void SetLinearXValues(const float min_speed, const float max_speed);
+            void SetLogXValues(const float min_speed, const float max_speed);
     };
-}
\ No newline at end of file
+
+    /* One histogram per species, histograms[i] holding every particle of type types[i] in particle_controller */
+    vector<Histogram> MakeSpeciesHistograms(ParticleController& particle_controller, const vector<size_t>& types,
+                                            BinningStrategy strategy = BinningStrategy::kFixedWidth, size_t num_bins = 9);
+}
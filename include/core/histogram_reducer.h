@@ -0,0 +1,66 @@
+#pragma once
+
+#include <vector>
+#include "histogram.h"
+#include "particle.h"
+
+using std::vector;
+
+namespace idealgas {
+    class HistogramReducer {
+        public:
+            /* Updates every histogram in one parallel pass over the contiguous particles: each particle is binned
+               into the histogram whose ids hold its id (if any), so the result is the same as updating each one */
+            void Reduce(vector<Histogram>& histograms, const vector<Particle>& particles);
+            
+            /* Reduce spread over calls that each bin a slice of the particles on the calling thread, for callers
+               that can only spend a bounded time per call: StartSlices, then AddRangeSlice over consecutive slices
+               covering every particle, then FinishRanges, then the same for counts. Same result as Reduce */
+            void StartSlices(vector<Histogram>& histograms);
+            void AddRangeSlice(vector<Histogram>& histograms, const vector<Particle>& particles, const size_t begin, const size_t end);
+            void FinishRanges(vector<Histogram>& histograms);
+            void AddCountSlice(vector<Histogram>& histograms, const vector<Particle>& particles, const size_t begin, const size_t end);
+            void FinishCounts(vector<Histogram>& histograms);
+
+        private:
+            /* Min / max speed and quantile sketch of each species, found by one thread */
+            struct SpeedRange {
+                vector<float> min_speeds;
+                vector<float> max_speeds;
+                vector<QuantileSketch> sketches;
+            };
+
+            /* Results of each thread, only written once that thread has finished its chunk (sliced reductions
+               only use the first) */
+            vector<SpeedRange> thread_ranges_;
+            vector<vector<size_t>> thread_counts_;
+            
+            /* Every species' bins live in one flat array of counts, histogram h's bins start at bin_offsets_[h] and
+               the last num histograms slots hold the number of particles of each species */
+            vector<size_t> bin_offsets_;
+
+            /* id_histograms_[id] is the index of the histogram holding particle id, or the number of histograms if
+               none does. Rebuilt from the histograms' ids every reduction, since ids can be added or removed */
+            vector<size_t> id_histograms_;
+
+            /* Particles per thread, below this the pass runs on the calling thread */
+            const size_t kMinParticlesPerThread = 16384;
+
+            /* Helper methods for the two passes: finding each species' range, then counting bins */
+            void ReduceRanges(vector<Histogram>& histograms, const vector<Particle>& particles);
+            void ReduceCounts(vector<Histogram>& histograms, const vector<Particle>& particles);
+            
+            /* Helper methods shared by the parallel and sliced passes: starting an empty range / counts, adding
+               particles [begin, end) to one, and combining every thread's into the histograms */
+            SpeedRange MakeEmptyRange(const size_t num_hists) const;
+            void SetIdHistograms(vector<Histogram>& histograms);
+            size_t GetHistogramIndex(const uint32_t id, const size_t num_hists) const;
+            void AddToRange(SpeedRange& range, vector<Histogram>& histograms, const vector<Particle>& particles,
+                            const size_t begin, const size_t end) const;
+            void CombineRanges(vector<Histogram>& histograms);
+            void SetBinOffsets(const vector<Histogram>& histograms);
+            void AddToCounts(vector<size_t>& counts, vector<Histogram>& histograms, const vector<Particle>& particles,
+                             const size_t begin, const size_t end) const;
+            void CombineCounts(vector<Histogram>& histograms);
+    };
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include "particle.h"
+
+namespace idealgas {
+    /* What an InvariantMonitor does when a step drifts past its tolerance */
+    enum class InvariantPolicy {
+        kRecord, //count the violation, for tests to check afterwards
+        kThrow //throw InvariantViolation, aborting the run
+    };
+
+    /* Thrown by an InvariantMonitor with the kThrow policy */
+    class InvariantViolation : public std::runtime_error {
+        public:
+            explicit InvariantViolation(const std::string& message);
+    };
+
+    /* Checks that particle-particle collisions conserve kinetic energy and momentum. Each collision's change is
+       accumulated inside ParticleController's resolve step, so checking costs a few multiplies per collision and
+       no extra pass over the particles. Walls and thermostats are left out since they change both on purpose */
+    class InvariantMonitor {
+        public:
+            /* Tolerances are relative: total change over a step divided by the total before the collisions */
+            InvariantMonitor(const float energy_tolerance = 1e-4f, const float momentum_tolerance = 1e-4f,
+                             const InvariantPolicy policy = InvariantPolicy::kRecord);
+
+            /* Called by ParticleController before each step */
+            void BeginStep();
+
+            /* Called by ParticleController for each collision, with both particles before and after it */
+            void RecordCollision(const Particle& p1_before, const Particle& p2_before, const Particle& p1_after, const Particle& p2_after);
+
+            /* Called by ParticleController after each step, checks the step's drift against the tolerances */
+            void EndStep();
+
+            /* Relative energy and momentum drift of the last step (0 if nothing collided) */
+            float GetEnergyDrift() const;
+            float GetMomentumDrift() const;
+
+            /* Largest drifts seen over all steps */
+            float GetMaxEnergyDrift() const;
+            float GetMaxMomentumDrift() const;
+
+            /* Number of steps that went past a tolerance, and collisions checked, over all steps */
+            size_t GetNumViolations() const;
+            size_t GetNumCollisions() const;
+
+        private:
+            const float kEnergyTolerance;
+            const float kMomentumTolerance;
+            const InvariantPolicy kPolicy;
+
+            /* Sums over the current step: signed change in energy, absolute change in momentum, and the totals
+               before the collisions (which the changes are relative to) */
+            double energy_change_ = 0;
+            double momentum_change_ = 0;
+            double energy_before_ = 0;
+            double momentum_before_ = 0;
+
+            float energy_drift_ = 0;
+            float momentum_drift_ = 0;
+            float max_energy_drift_ = 0;
+            float max_momentum_drift_ = 0;
+            size_t num_violations_ = 0;
+            size_t num_collisions_ = 0;
+            size_t num_steps_ = 0;
+    };
+}
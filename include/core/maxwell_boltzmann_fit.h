@@ -0,0 +1,54 @@
+#pragma once
+
+#include <vector>
+#include "histogram.h"
+
+using std::vector;
+
+namespace idealgas {
+    /* Result of fitting a 2D Maxwell-Boltzmann speed distribution to a histogram's bins */
+    struct FitResult {
+        float temperature; //kT, in mass * (px/frame)^2
+        float chi_square; //Pearson statistic over the histogram's bins
+        float ks_statistic; //largest gap between observed and expected cumulative frequencies
+        vector<float> expected_frequencies; //fitted frequency (as a fraction) of each bin
+    };
+
+    class MaxwellBoltzmannFit {
+        public:
+            /* Initializes a fit for a species of the given mass; the gas counts as equilibrated once
+               sqrt(n) * ks_statistic stays below ks_critical_value for num_stable_updates updates in a row */
+            MaxwellBoltzmannFit(const float mass, const float ks_critical_value = 1.36f, const size_t num_stable_updates = 30);
+
+            /* Fits the distribution to the histogram's current bins and updates the equilibration state */
+            FitResult Update(Histogram& hist);
+
+            /* Fits the distribution to bin edges and bin frequencies (as fractions of num_particles), no particle rescan */
+            FitResult Fit(const vector<float>& x_values, const vector<float>& bin_frequencies, const size_t num_particles) const;
+
+            /* Returns true once the histogram has matched the fitted distribution for num_stable_updates updates in a row */
+            bool IsEquilibrated() const;
+
+            /* Updates each fit from the histogram at the same index, and returns true if every species has
+               equilibrated (e.g. for stopping a headless run early) */
+            static bool UpdateAll(vector<MaxwellBoltzmannFit>& fits, vector<Histogram>& histograms);
+
+            /* Getters */
+            float GetMass() const;
+            FitResult& GetLastFit();
+
+            /* Fraction of particles with speed <= speed in a 2D Maxwell-Boltzmann distribution: 1 - e^(-mv^2 / 2kT) */
+            static float CumulativeProbability(const float speed, const float mass, const float temperature);
+
+        private:
+            const float kMass;
+            const float kKsCriticalValue;
+            const size_t kNumStableUpdates;
+
+            /* Number of consecutive updates that passed the KS test */
+            size_t num_passing_updates_ = 0;
+
+            /* Most recent fit, kept for drawing */
+            FitResult last_fit_;
+    };
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "particle.h"
+
+using std::vector;
+
+namespace idealgas {
+    /* Verlet neighbour list: for each particle, the ids of every particle that was within 2 * largest radius + skin
+       of it when the list was built. No particle can reach one that isn't in its list until one of them has moved
+       more than half the skin since the build, so for slow particles one build serves many steps. Each build widens
+       the skin to at least 4 steps' travel of the fastest particle, so a list always outlasts the step it's built in.
+       Stored in compressed sparse row layout: the neighbours of the particle with id i are
+       GetNeighbourIds()[GetOffsets()[i]] up to (not including) GetNeighbourIds()[GetOffsets()[i + 1]] */
+    class NeighbourList {
+        public:
+            explicit NeighbourList(const float skin);
+
+            /* Rebuilds the list from the particles' current positions with a grid of cells at least as wide as the
+               search range, num_ids is one more than the largest id any particle has */
+            void Build(const vector<Particle>& particles, const size_t num_ids, const float max_radius);
+
+            /* Returns true if p has moved more than half the last build's skin since that build (or wasn't in it),
+               after which the list may be missing pairs that touch */
+            bool HasMovedTooFar(const Particle& p) const;
+
+            /* Marks the list as out of date, e.g. when particles are added or removed, so it's rebuilt before use */
+            void Invalidate();
+            bool IsValid() const;
+
+            const vector<uint32_t>& GetOffsets() const;
+            const vector<uint32_t>& GetNeighbourIds() const;
+
+            /* Skin the last build used, at least the one the list was made with */
+            float GetSkin() const;
+
+            /* Number of times the list has been built, for seeing how many steps each build lasts */
+            size_t GetNumBuilds() const;
+
+        private:
+            const float kSkin;
+
+            /* Particles per thread when building in parallel */
+            const size_t kMinPerThread = 4096;
+
+            /* CSR rows indexed by id, and each particle's position (by id) when the list was built */
+            vector<uint32_t> offsets_;
+            vector<uint32_t> neighbour_ids_;
+            vector<Vec2> build_positions_;
+
+            float build_skin_ = 0;
+            bool is_valid_ = false;
+            size_t num_builds_ = 0;
+    };
+}
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace idealgas {
+    /* Splits [0, num_items) into one contiguous chunk per thread and calls func(begin, end, thread_index) on each,
+       running on the calling thread only when there aren't at least 2 chunks of min_chunk_size items */
+    void ParallelFor(const size_t num_items, const size_t min_chunk_size,
+                     const std::function<void(size_t begin, size_t end, size_t thread_index)>& func);
+
+    /* Number of chunks (and threads) ParallelFor will use for num_items */
+    size_t GetNumChunks(const size_t num_items, const size_t min_chunk_size);
+}
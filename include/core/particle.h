@@ -1,19 +1,25 @@
 #pragma once
 
 #include "cinder/gl/gl.h"
+#include "core/precision.h"
+#include <cstdint>
 #include <string>
 
 using std::string;
 
 namespace idealgas {
     struct Particle {
-        Particle(const size_t type, glm::vec2 pos, glm::vec2 vel, const float mass, const float radius, const cinder::Colorf color);
-        const size_t type; //1, 2, or 3
-        glm::vec2 pos;
-        glm::vec2 vel;
-        const float mass;
-        const float radius;
-        const cinder::Colorf color;
+        Particle(const size_t type, Vec2 pos, Vec2 vel, const float mass, const float radius, const cinder::Colorf color);
+        //not const so particles can be moved around in storage (sorted, compacted) by the controller
+        size_t type; //1, 2, or 3
+        //storage precision is chosen at compile time, see precision.h
+        Position pos;
+        Vec2 vel;
+        float mass;
+        float radius;
+        cinder::Colorf color;
         float speed;
+        //stable identifier assigned by ParticleController, doesn't change when the particle moves in storage
+        uint32_t id;
     };
-}
\ No newline at end of file
+}
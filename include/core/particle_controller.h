@@ -1,7 +1,16 @@
 #pragma once
 
 #include "cinder/gl/gl.h"
+#include "command_queue.h"
+#include "hierarchical_grid.h"
+#include "invariant_monitor.h"
+#include "neighbour_list.h"
 #include "particle.h"
+#include "particle_observer.h"
+#include "particle_placer.h"
+#include "thermostat.h"
+#include <functional>
+#include <memory>
 #include <vector>
 #include <map>
 
@@ -11,17 +20,133 @@ using std::multimap;
 namespace idealgas {
     class ParticleController {
         public:
-            /* Parameterized constructor: initializes particles_ with locations within box bounds */
-            ParticleController(const size_t box_width, const glm::vec2& top_left, const float border_width);
+            /* Parameterized constructor: initializes particles_ with locations within box bounds, generated by the
+               given placement strategy (kUniformRandom lets particles start overlapping) */
+            ParticleController(const size_t box_width, const glm::vec2& top_left, const float border_width,
+                               const PlacementStrategy placement = PlacementStrategy::kUniformRandom);
 
             /* Initializes particles_ with the passed in particles and bounds, mainly for testing */
-            ParticleController(vector<Particle>& particles, const float x_min, const float x_max, const float y_min, const float y_max);
+            ParticleController(const vector<Particle>& particles, const float x_min, const float x_max, const float y_min, const float y_max);
             
-            /* Updates positions and velocities of particles */
+            /* Applies queued commands, then updates positions and velocities of particles (unless paused) */
             void UpdateParticles();
             
-            /* Returns list of particles */
+            /* UpdateParticles in pieces, for spreading a step over several calls (e.g. by a SteppingTask):
+               BeginStep applies queued commands and returns false if this step is skipped (paused), otherwise
+               UpdateParticleRange must then cover every index in order, followed by EndStep. Particles mustn't be
+               added, removed or reordered between BeginStep and EndStep. UpdateParticleRange returns the index it
+               stopped at, which is before end when the particle before it made a rebuild due. The work that takes
+               time in proportion to every particle rather than a range can be run as pieces of its own: a due
+               RebuildCandidateSearch before a range (UpdateParticleRange runs it first otherwise), and a due
+               ReorderParticles after EndStep (UpdateParticles runs it there) */
+            bool BeginStep();
+            size_t UpdateParticleRange(const size_t begin, const size_t end);
+            void EndStep();
+
+            /* Whether the neighbour list has to be built, or the hierarchical grid rebuilt after the piston moved
+               past it, before more particles are updated */
+            bool IsRebuildDue() const;
+            void RebuildCandidateSearch();
+
+            /* Whether the last step's locality or the reorder interval calls for ReorderParticles */
+            bool IsReorderDue() const;
+            
+            /* Queues a command (temperature ramp, wall move, pause...) to be applied at the start of the next step,
+               safe to call from any thread */
+            void EnqueueCommand(const SimulationCommand& command);
+            
+            /* Returns true if steps are paused, UpdateParticles only advances on single step commands */
+            bool IsPaused() const;
+            
+            /* Current position of the right wall (piston), which can be moved with a kMoveWall command */
+            float GetXMax() const;
+            
+            /* Sets the thermostat applied inside the update loop (nullptr for none, the default) */
+            void SetThermostat(std::unique_ptr<Thermostat> thermostat);
+            
+            /* Lets particles pass through the left / right wall instead of bouncing, e.g. where the box borders
+               another process's part of the domain */
+            void SetOpenWalls(const bool is_left_open, const bool is_right_open);
+            
+            /* Sets particles owned by someone else (e.g. a neighbouring slab's halo) that this box's particles collide
+               with until the next call, replacing any set before. Ghosts are read only: they aren't stepped, given
+               ids or told to observers, and a collision only changes the velocity of the particle in the box */
+            void SetGhosts(const vector<Particle>& ghosts);
+
+            /* Sets a monitor that checks collisions conserve energy and momentum every step (nullptr for none,
+               the default), not owned */
+            void SetInvariantMonitor(InvariantMonitor* monitor);
+            
+            /* Temperature (mean kinetic energy per particle) measured during the last step */
+            float GetTemperature() const;
+            
+            /* Returns list of particles, their order in storage may change (use ids to refer to a particle) */
             vector<Particle>& GetParticles();
+            const vector<Particle>& GetParticles() const;
+            
+            /* Returns the particle with the given stable id, wherever it currently is in storage */
+            Particle& GetParticle(const uint32_t id);
+            
+            /* Returns how the box's default particles of the given type (1 to 3) are made, whether or not any are in
+               the box; throws std::out_of_range for other types */
+            ParticleSpecies GetSpecies(const size_t type) const;
+            
+            /* Returns the current index in GetParticles() of the particle with the given id */
+            size_t GetIndex(const uint32_t id) const;
+            
+            /* Adds a particle during a run (e.g. from a source or pump) and returns its id, reusing ids of removed particles */
+            uint32_t AddParticle(Particle p);
+            
+            /* Removes the particle with the given id in O(1) by moving the last particle into its slot */
+            void RemoveParticle(const uint32_t id);
+            
+            /* Removes every particle matching should_remove (e.g. particles that left through an open boundary)
+               and returns their ids */
+            vector<uint32_t> RemoveParticlesIf(const std::function<bool(const Particle&)>& should_remove);
+            
+            /* Returns true if a particle with the given id is currently in the box */
+            bool HasParticle(const uint32_t id) const;
+            
+            /* Registers / unregisters an observer that is told about added and removed particles, not owned */
+            void AddObserver(ParticleObserver* observer);
+            void RemoveObserver(ParticleObserver* observer);
+            
+            /* Reorders particle storage so new index i holds the particle previously at index order[i]; ids stay valid */
+            void PermuteParticles(const vector<uint32_t>& order);
+            
+            /* Sorts particle storage along a Morton (Z-order) curve of grid cells, so particles near each other
+               in space are near each other in memory */
+            void ReorderParticles();
+            
+            /* Re-sorts particles every num_steps steps (0 never re-sorts on a schedule) */
+            void SetReorderInterval(const size_t num_steps);
+            
+            /* Re-sorts particles after any step where more than this fraction of neighbours in storage
+               were in non-adjacent cells (1 or more disables the check) */
+            void SetReorderThreshold(const float scattered_fraction);
+            
+            /* Fraction of particles in the last step whose previous particle in storage was in a non-adjacent cell,
+               only measured while the reorder threshold is below 1 (0 otherwise) */
+            float GetScatteredFraction() const;
+            
+            /* Finds collision candidates with a Verlet neighbour list with the given skin (px) instead of position
+               range queries, rebuilding it only when a particle has moved more than half the skin since the last
+               build (0 goes back to range queries, the default). Suits dense, slow gases; the skin trades list
+               length against how often it's rebuilt, and is widened while the fastest particle would cross it in
+               under 4 steps */
+            void SetNeighbourListSkin(const float skin);
+            
+            /* Number of times the neighbour list has been built (0 if it isn't used) */
+            size_t GetNumNeighbourListBuilds() const;
+            
+            /* Finds collision candidates with a grid per radius class instead of position range queries (false goes
+               back to range queries, the default), so mixes of very different radii cost about the same per
+               particle as one radius. The neighbour list and the grid replace each other. The grid covers the box,
+               and is rebuilt to cover the piston's destination when the piston moves past it */
+            void SetHierarchicalGrid(const bool is_enabled);
+
+            /* Number of times the hierarchical grid has been built (0 if it isn't used) */
+            size_t GetNumGridBuilds() const;
             
             /* Speeds up or slows down particles; speed up if speed_up is true, else slow down */
             void ChangeSpeeds(const bool should_speed_up);
@@ -30,19 +155,103 @@ namespace idealgas {
             /* List of particles */
             vector<Particle> particles_;
 
-            /* Maps particle position magnitudes to particles, allows for O(nlog(n)) collision checking */
-            multimap<float, Particle*> pos_particle_map_;
+            /* Maps particle position magnitudes to particle ids, allows for O(nlog(n)) collision checking */
+            multimap<float, uint32_t> pos_particle_map_;
+            
+            /* Replace pos_particle_map_ when set (at most one at a time), which is then left empty */
+            std::unique_ptr<NeighbourList> neighbour_list_;
+            std::unique_ptr<HierarchicalGrid> hierarchical_grid_;
+            
+            /* Candidate ids gathered from hierarchical_grid_, kept between calls so it isn't reallocated */
+            vector<uint32_t> candidate_ids_;
+            size_t num_grid_builds_ = 0;
+            
+            /* Indirection table: id_to_index_[id] is the index in particles_ of the particle with that id */
+            vector<uint32_t> id_to_index_;
+            
+            /* Ids of removed particles, handed out again before new ids are created */
+            vector<uint32_t> free_ids_;
+            
+            /* Value in id_to_index_ for ids that aren't currently in use */
+            static const uint32_t kInvalidIndex = 0xffffffff;
+            
+            /* Observers told about added and removed particles */
+            vector<ParticleObserver*> observers_;
+            
+            /* Spatial re-sorting schedule and locality of the last step */
+            size_t reorder_interval_ = 0;
+            size_t steps_since_reorder_ = 0;
+            float reorder_threshold_ = 1;
+            float scattered_fraction_ = 0;
+            
+            /* Largest radius of any particle, sets the cell size used for spatial sorting */
+            float max_radius_ = 0;
+            
+            /* Particles set by SetGhosts, sorted by y so those within reach of a particle are one range */
+            vector<Particle> ghosts_;
+            float max_ghost_radius_ = 0;
             
             /* Helper method for adding particles of a specific type to particles_ */
             void SetParticles(const size_t type, const size_t num, const float mass, const float radius, const cinder::Colorf color);
+
+            /* Helper method for adding all 3 types of particles at positions from a ParticlePlacer, spaced for the
+               largest radius so no two particles start overlapping */
+            void PlaceParticles(const PlacementStrategy placement);
+            
+            /* Helper methods for giving a particle an id and adding it to particles_ and pos_particle_map_, and
+               for removing a single particle's entry from pos_particle_map_ */
+            void InsertParticle(Particle& p);
+            void ErasePosEntry(const Particle& p);
+            
+            /* Helper method for refilling pos_particle_map_ when going back to range queries */
+            void RebuildPosMap();
+
+            /* Helper method for (re)making hierarchical_grid_ with every particle, over the box up to x_max */
+            void BuildHierarchicalGrid(const float x_max);
+            
+            /* Commands waiting for the next step boundary */
+            CommandQueue command_queue_;
+            
+            /* State of commands that are spread over several steps or persist between steps */
+            bool is_paused_ = false;
+            size_t num_pending_single_steps_ = 0;
+            float vel_scale_per_step_ = 1; //velocity factor of the current temperature ramp
+            size_t ramp_steps_remaining_ = 0;
+            float wall_vel_ = 0; //x velocity of the right wall while it's moving
+            size_t wall_steps_remaining_ = 0;
+            bool is_left_wall_open_ = false;
+            bool is_right_wall_open_ = false;
+            
+            /* Controls temperature from inside the update loop, if set */
+            std::unique_ptr<Thermostat> thermostat_;
+            
+            /* Checks conservation in the collision resolve step, if set */
+            InvariantMonitor* invariant_monitor_ = nullptr;
+            
+            /* Mean kinetic energy per particle, accumulated during each step */
+            float temperature_ = 0;
+            
+            /* State of the step in progress, set by BeginStep and used until EndStep */
+            float step_vel_scale_ = 1; //velocity factor from ramps and the thermostat
+            bool is_thermostat_acting_on_particles_ = false;
+            float kinetic_energy_ = 0;
+            size_t num_scattered_ = 0; //particles whose previous particle in storage ended the step in a non-adjacent cell
+            
+            /* Helper method for applying queued commands, returns false if this step should be skipped (paused) */
+            bool ApplyCommands();
             
             /* Helper methods for updating particle positions / velocities */
             void CheckWallCollision(Particle& p);
             void CheckParticleCollision(Particle& p);
-            float DistBtwnPoints(const Particle& p1, const Particle& p2);
+            void CheckNeighbourCollision(Particle& p);
+            void CheckGridCollision(Particle& p);
+            void CheckGhostCollision(Particle& p);
             void UpdateVelocities(Particle& p1, Particle& p2);
-            //p1: particle whose velocity is being updated, p2 collided with p1
-            void UpdateVelocity(Particle& p1, Particle& p2);
+            void UpdateVelocities(Particle& p, const uint32_t* ids, const size_t num_ids);
+            void ReflectOffWall(Particle& p, const glm::vec2& normal);
+            float MeasureTemperature() const;
+            bool AreCellsAdjacent(const Vec2& pos1, const Vec2& pos2) const;
+            float GetCellSize() const;
             
             /* Initial velocity for all particles */
             const glm::vec2 kMinInitialVel = glm::vec2(-2.5, -2.5);
@@ -51,9 +260,9 @@ namespace idealgas {
             /* Percent amount to increase or decrease velocity by */
             const float kVelChange = 1.10f;
             
-            /* Bounds for possible particle positions */
+            /* Bounds for possible particle positions, the right wall can move (piston) */
             const float kXMin;
-            const float kXMax;
+            float x_max_;
             const float kYMin;
             const float kYMax;
             
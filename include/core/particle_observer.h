@@ -0,0 +1,18 @@
+#pragma once
+
+#include "particle.h"
+
+namespace idealgas {
+    /* Interface for anything that keeps its own view of the particles (e.g. histograms), so it can be updated
+       incrementally when particles are added or removed instead of being rebuilt */
+    class ParticleObserver {
+        public:
+            virtual ~ParticleObserver() {}
+
+            /* Called after p has been added, p.id is already assigned */
+            virtual void OnParticleAdded(const Particle& p) = 0;
+
+            /* Called just before p is removed, while p.id is still valid */
+            virtual void OnParticleRemoved(const Particle& p) = 0;
+    };
+}
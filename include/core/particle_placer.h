@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "particle.h"
+
+using std::vector;
+
+namespace idealgas {
+    /* How initial particle positions are generated */
+    enum class PlacementStrategy {
+        kUniformRandom, //anywhere in the box, particles may start overlapping
+        kLatticeJitter, //one particle per cell of a grid covering the box, jittered inside its cell
+        kPoissonDisk //random positions at least 2 * max_radius apart, placed in parallel on a grid
+    };
+
+    /* One species of particles for MakeParticles, each velocity component starts uniform in [-max_speed, max_speed] */
+    struct ParticleSpecies {
+        size_t type;
+        size_t count;
+        float mass;
+        float radius;
+        float max_speed;
+        cinder::Colorf color;
+    };
+
+    /* Generates initial positions that keep particles (of radius up to max_radius) inside the bounds and, except for
+       kUniformRandom, apart from each other. Positions depend only on the seed, not on how many threads are used,
+       and consecutive positions are spread over the whole box so species placed one after another are mixed */
+    class ParticlePlacer {
+        public:
+            ParticlePlacer(const float x_min, const float x_max, const float y_min, const float y_max, const uint32_t seed = 0);
+
+            /* Returns num positions using the given strategy, throws std::runtime_error if they don't fit */
+            vector<glm::vec2> Place(const PlacementStrategy strategy, const size_t num, const float max_radius) const;
+
+            /* Positions anywhere inside the bounds */
+            vector<glm::vec2> PlaceUniformRandom(const size_t num, const float max_radius) const;
+
+            /* One position per cell of a grid with at least num cells, each moved randomly within its cell as far as
+               it can go without reaching into a neighbouring cell */
+            vector<glm::vec2> PlaceOnLattice(const size_t num, const float max_radius) const;
+
+            /* Dart throwing on a grid of cells small enough to hold one point each. Cells 3 apart can't conflict,
+               so each round fills the 9 interleaved sets of cells one set at a time, every cell of a set in parallel */
+            vector<glm::vec2> PlacePoissonDisk(const size_t num, const float max_radius) const;
+
+            /* Creates every species' particles, in order, at positions placed with strategy for the largest radius
+               and handed out in order (so the species are mixed), with velocities from a generator seeded with the
+               placer's seed. Throws std::runtime_error if they don't fit */
+            vector<Particle> MakeParticles(const vector<ParticleSpecies>& species,
+                                           const PlacementStrategy strategy = PlacementStrategy::kLatticeJitter) const;
+
+            /* Writes particles to a binary snapshot file, throws std::runtime_error if it can't be written */
+            static void SaveSnapshot(const std::string& path, const vector<Particle>& particles);
+
+            /* Reads particles from a snapshot written by SaveSnapshot, throws std::runtime_error if it can't */
+            static vector<Particle> LoadSnapshot(const std::string& path);
+
+        private:
+            const float kXMin;
+            const float kXMax;
+            const float kYMin;
+            const float kYMax;
+            const uint32_t kSeed;
+
+            /* Dart throwing rounds tried before giving up on finding num positions */
+            const size_t kMaxPoissonRounds = 40;
+
+            /* Particles per thread below which placement isn't split across threads */
+            const size_t kMinPerThread = 16384;
+
+            /* Helper method for a random number in [0, 1) that depends only on the seed and its arguments */
+            float Random(const uint64_t index, const uint64_t stream) const;
+    };
+}
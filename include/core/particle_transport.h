@@ -0,0 +1,85 @@
+#pragma once
+
+#include <climits>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <vector>
+#include "particle.h"
+
+using std::vector;
+
+namespace idealgas {
+    /* Neighbours of a slab of the domain, which is split along x */
+    enum class Neighbour {
+        kLeft,
+        kRight
+    };
+
+    /* Moves particles between the processes (ranks) of a domain decomposition. Particles are sent as fixed size
+       records in the machine's byte order, so every rank must run on the same kind of machine */
+    class ParticleTransport {
+        public:
+            virtual ~ParticleTransport() {}
+
+            /* Sends outgoing to the neighbour and returns what the neighbour sent back; both sides have to call it.
+               With no neighbour on that side (first / last rank), nothing is sent and nothing comes back */
+            virtual vector<Particle> Exchange(const Neighbour neighbour, const vector<Particle>& outgoing) = 0;
+
+            /* Index of this process's slab from the left, and the number of slabs */
+            virtual int GetRank() const = 0;
+            virtual int GetNumRanks() const = 0;
+    };
+
+#ifndef _WIN32
+    /* Transport over connected UNIX domain sockets, for running every rank on one machine (as threads or forked
+       processes) */
+    class SocketTransport : public ParticleTransport {
+        public:
+            /* Takes ownership of the sockets connected to the left and right neighbours (-1 for none) */
+            SocketTransport(const int rank, const int num_ranks, const int left_socket, const int right_socket);
+            ~SocketTransport() override;
+
+            SocketTransport(const SocketTransport&) = delete;
+            SocketTransport& operator=(const SocketTransport&) = delete;
+
+            /* Creates transports for num_ranks ranks, each connected to its neighbours */
+            static vector<std::unique_ptr<SocketTransport>> CreateConnected(const int num_ranks);
+
+            vector<Particle> Exchange(const Neighbour neighbour, const vector<Particle>& outgoing) override;
+            int GetRank() const override;
+            int GetNumRanks() const override;
+
+        private:
+            const int kRank;
+            const int kNumRanks;
+            int left_socket_;
+            int right_socket_;
+    };
+
+    /* Runs rank_main once per rank, each in its own forked process with a transport connected to its neighbours,
+       and returns the particles each rank's rank_main returned (sent back over a pipe). Blocks until every rank has
+       exited; throws runtime_error if any rank threw or died */
+    vector<vector<Particle>> RunForkedRanks(const int num_ranks,
+                                            const std::function<vector<Particle>(ParticleTransport&)>& rank_main);
+#endif
+
+#ifdef IDEALGAS_WITH_MPI
+    /* Transport over MPI, for ranks spread over a cluster. MPI_Init must be called before creating it */
+    class MpiTransport : public ParticleTransport {
+        public:
+            /* MPI counts are ints, so messages are sent in chunks of at most max_chunk_bytes (rounded down to whole
+               records, and never more than INT_MAX) */
+            explicit MpiTransport(const size_t max_chunk_bytes = INT_MAX);
+
+            vector<Particle> Exchange(const Neighbour neighbour, const vector<Particle>& outgoing) override;
+            int GetRank() const override;
+            int GetNumRanks() const override;
+
+        private:
+            int rank_;
+            int num_ranks_;
+            const size_t kMaxChunkBytes;
+    };
+#endif
+}
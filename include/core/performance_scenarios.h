@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "particle_controller.h"
+
+using std::string;
+using std::vector;
+
+namespace idealgas {
+    /* A fixed headless workload for measuring the physics core: one species on a lattice, stepped num_steps times */
+    struct PerformanceScenario {
+        string name;
+        size_t num_particles;
+        float box_width;
+        float radius;
+        size_t num_speed_ups; //calls to ChangeSpeeds(true) before stepping
+        size_t num_steps;
+        float neighbour_skin; //0 finds collisions with range queries
+        bool is_hierarchical_grid; //replaces range queries too
+    };
+
+    /* Measured throughput of a scenario, and the collisions it had (which show whether the work done changed) */
+    struct PerformanceResult {
+        double steps_per_second;
+        size_t num_collisions;
+    };
+
+    /* The scenarios checked by the performance suite, run by ideal-gas-benchmark and used for PGO training */
+    extern const vector<PerformanceScenario> kPerformanceScenarios;
+
+    /* Same particles every time: lattice positions and velocities from a fixed seed */
+    std::unique_ptr<ParticleController> MakeScenarioController(const PerformanceScenario& scenario);
+
+    /* Collisions in an untimed run with an InvariantMonitor */
+    size_t CountScenarioCollisions(const PerformanceScenario& scenario);
+
+    /* Steps per second of the best of num_runs timed runs */
+    double MeasureStepsPerSecond(const PerformanceScenario& scenario, const size_t num_runs = 3);
+
+    /* Results files have lines of "name steps_per_second num_collisions", lines starting with # are comments.
+       A missing file reads as no results */
+    std::map<string, PerformanceResult> ReadPerformanceResults(const string& path);
+    void WritePerformanceResult(std::ostream& out, const string& name, const PerformanceResult& result);
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using std::vector;
+
+namespace idealgas {
+    /* Encodes 8 bit RGB pixels (rows from the top, 3 bytes per pixel) as a PNG. The image data is deflated with
+       stored (uncompressed) blocks: files are bigger, but encoding is just copying and checksums, and needs no zlib */
+    vector<uint8_t> EncodePng(const vector<uint8_t>& rgb, const size_t width, const size_t height);
+
+    /* Encodes and writes a PNG file, throws std::runtime_error if it can't be written */
+    void WritePng(const std::string& path, const vector<uint8_t>& rgb, const size_t width, const size_t height);
+
+    /* CRC-32 used by PNG chunks, continued from crc (0 to start) */
+    uint32_t Crc32(const uint8_t* data, const size_t size, const uint32_t crc = 0);
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+using std::vector;
+
+namespace idealgas {
+    /* KLL-style quantile sketch: answers approximate quantile queries over a stream of values using
+       O(k log(n / k)) memory, and sketches built separately (e.g. one per thread) can be merged */
+    class QuantileSketch {
+        public:
+            /* Initializes an empty sketch; larger k means more memory and more accurate quantiles */
+            explicit QuantileSketch(const size_t k = 200);
+
+            /* Adds a value to the sketch */
+            void Insert(const float value);
+
+            /* Adds every value summarized by other to this sketch, other must have been created with the same k */
+            void Merge(const QuantileSketch& other);
+
+            /* Returns the approximate value below which the given fraction (0 to 1) of inserted values fall */
+            float Quantile(const float fraction) const;
+
+            /* Removes all values from the sketch, keeping its memory for reuse (e.g. refilled every frame) */
+            void Clear();
+
+            /* Getters */
+            size_t GetCount() const;
+            float GetMin() const;
+            float GetMax() const;
+            size_t GetNumRetained() const;
+
+        private:
+            /* Compactor levels: an item stored in level h stands for 2^h inserted values */
+            vector<vector<float>> levels_;
+
+            /* Number of values inserted (or merged in), and exact min / max of those values */
+            size_t count_ = 0;
+            float min_;
+            float max_;
+
+            /* Alternates which half of a compacted level is kept, so compaction error doesn't build up in one direction */
+            bool keep_odd_ = false;
+
+            /* Accuracy parameter: capacity of the top level */
+            size_t k_;
+
+            /* Capacity of each level and their sum, which only change when a level is added, and the number of
+               items in all levels, so inserting doesn't have to recount either */
+            vector<size_t> capacities_;
+            size_t total_capacity_ = 0;
+            size_t num_retained_ = 0;
+
+            /* Helper methods for keeping memory bounded */
+            void AddLevel();
+            void Compress();
+            void CompactLevel(const size_t level);
+    };
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "particle.h"
+
+using std::vector;
+
+namespace idealgas {
+    /* Interleaves the bits of a cell's x and y coordinates, so cells close in space get close keys (Z-order curve) */
+    uint32_t MortonKey(const uint32_t cell_x, const uint32_t cell_y);
+
+    /* Returns the Morton key of the grid cell containing pos, for a grid of square cells starting at origin */
+    uint32_t CellMortonKey(const glm::vec2& pos, const glm::vec2& origin, const float cell_size);
+
+    /* Sorts keys in ascending order with a parallel LSD radix sort, applying the same moves to values (stable) */
+    void RadixSortByKey(vector<uint32_t>& keys, vector<uint32_t>& values);
+
+    /* Returns the order of particles along the Morton curve: order[i] is the index of the i-th particle on the curve */
+    vector<uint32_t> GetMortonOrder(const vector<Particle>& particles, const glm::vec2& origin, const float cell_size);
+}
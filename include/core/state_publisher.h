@@ -0,0 +1,117 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "histogram.h"
+#include "particle.h"
+
+using std::vector;
+
+namespace idealgas {
+    /* Start of the shared memory segment. It is followed by max_particles SharedParticle records, then for each
+       histogram num_bins + 1 bin edges and num_bins frequencies (floats). Sizes are fixed when the segment is
+       created, so readers can map it once */
+    struct SharedStateHeader {
+        /* Seqlock: odd while the publisher is writing a frame, bumped to the next even number once it's done */
+        std::atomic<uint64_t> sequence;
+        uint32_t magic;
+        uint32_t version;
+        uint32_t max_particles;
+        uint32_t num_histograms;
+        uint32_t num_bins;
+        uint32_t num_particles; //in the current frame, at most max_particles
+        uint64_t frame; //number of frames published so far
+        float temperature;
+        uint32_t padding;
+    };
+
+    /* Particle as published, with a fixed layout whatever precision the simulation is built with */
+    struct SharedParticle {
+        uint32_t id;
+        uint32_t type;
+        float x;
+        float y;
+        float vel_x;
+        float vel_y;
+        float speed;
+        float radius;
+    };
+
+    /* A consistent copy of one published frame */
+    struct StateFrame {
+        uint64_t frame;
+        float temperature;
+        vector<SharedParticle> particles;
+        vector<vector<float>> x_values; //per histogram
+        vector<vector<float>> bin_frequencies; //per histogram
+    };
+
+#ifndef _WIN32
+    /* Writes the latest particle state and histogram bins into a POSIX shared memory segment, so other processes
+       (dashboards, analysis tools) can watch the simulation. Publishing is a copy into the segment done between
+       steps, so UpdateParticles itself isn't slowed down, and the publisher never waits for readers */
+    class StatePublisher {
+        public:
+            /* Creates (or replaces) the segment with the given name, e.g. "/idealgas" */
+            StatePublisher(const std::string& name, const size_t max_particles, const size_t num_histograms, const size_t num_bins);
+
+            /* Unmaps and removes the segment */
+            ~StatePublisher();
+
+            StatePublisher(const StatePublisher&) = delete;
+            StatePublisher& operator=(const StatePublisher&) = delete;
+
+            /* Publishes a frame; only the first max_particles particles and num_histograms histograms are written */
+            void Publish(const vector<Particle>& particles, vector<Histogram>& histograms, const float temperature);
+
+            /* Number of frames published so far */
+            uint64_t GetNumFrames() const;
+
+        private:
+            const std::string kName;
+            size_t size_;
+            void* memory_;
+            SharedStateHeader* header_;
+            SharedParticle* particles_;
+            float* bins_;
+    };
+
+    /* Maps a segment created by a StatePublisher (possibly in another process) read only */
+    class StateReader {
+        public:
+            /* Opens the segment with the given name, throws std::runtime_error if there isn't a valid one */
+            explicit StateReader(const std::string& name);
+            ~StateReader();
+
+            StateReader(const StateReader&) = delete;
+            StateReader& operator=(const StateReader&) = delete;
+
+            /* Copies the latest complete frame into frame, retrying while the publisher is writing; returns false
+               if no consistent frame could be read in max_attempts tries (finding a frame still being written is
+               a try) */
+            bool ReadFrame(StateFrame& frame, const size_t max_attempts = 1000) const;
+
+            /* Zero-copy reading: BeginRead waits for a complete frame and sets sequence to its sequence number,
+               returning false if the publisher was still writing after max_attempts looks. The data can then be
+               read in place, and EndRead returns true if the frame wasn't overwritten in the meantime */
+            bool BeginRead(uint64_t& sequence, const size_t max_attempts = 1000) const;
+            bool EndRead(const uint64_t sequence) const;
+
+            /* In-place data of the current frame (valid between BeginRead and a successful EndRead) */
+            const SharedStateHeader& GetHeader() const;
+            const SharedParticle* GetParticles() const;
+            const float* GetXValues(const size_t histogram) const;
+            const float* GetBinFrequencies(const size_t histogram) const;
+
+        private:
+            size_t size_;
+            void* memory_;
+            const SharedStateHeader* header_;
+            const SharedParticle* particles_;
+            const float* bins_;
+    };
+#endif
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <vector>
+#include "histogram.h"
+#include "histogram_reducer.h"
+#include "particle_controller.h"
+
+using std::vector;
+
+namespace idealgas {
+    /* Where a SteppingTask is in its step */
+    enum class StepPhase {
+        kStart, //nothing done yet, queued commands are applied first
+        kRebuild, //building the neighbour list or hierarchical grid, before the next slice of particles
+        kUpdateParticles, //collisions and movement, a slice of particles at a time
+        kReorder, //sorting particles in space after the update, when the controller's reorder is due
+        kHistogramRanges, //finding each species' speed range
+        kHistogramCounts, //binning speeds
+        kDone
+    };
+
+    /* One step of a controller (and the histograms of its particles, if given) as a resumable task, for hosts that
+       run the simulation inside an event loop: each Resume works through pieces of the step until its time budget
+       is used up, then returns. A piece is a slice of particles, or one of the controller's rebuilds and reorders,
+       which can't be split and take time in proportion to every particle; these run as pieces of their own, so a
+       Resume blocks the loop for at most the budget plus one slice or one rebuild or reorder. Nothing runs between
+       calls, so no extra threads are needed. The controller mustn't be stepped any other way, and particles mustn't
+       be added or removed, while a step is in progress */
+    class SteppingTask {
+        public:
+            /* histograms must outlive the task, nullptr steps without binning; slice_size particles are handled
+               between checks of the clock */
+            SteppingTask(ParticleController& particle_controller, vector<Histogram>* histograms = nullptr,
+                         const size_t slice_size = 1024);
+
+            /* Works on the step until it's finished or budget has passed (always doing at least one piece), and
+               returns true if the step is finished. Resuming a finished task starts the next step */
+            bool Resume(const std::chrono::microseconds budget);
+
+            /* Finishes the step in progress (or runs a whole new one) without returning in between */
+            void RunToCompletion();
+
+            StepPhase GetPhase() const;
+            bool IsDone() const;
+
+            /* Number of Resume calls the last finished step took */
+            size_t GetNumResumesPerStep() const;
+
+        private:
+            ParticleController& particle_controller_;
+            vector<Histogram>* histograms_;
+            HistogramReducer reducer_;
+            const size_t kSliceSize;
+
+            StepPhase phase_ = StepPhase::kDone;
+
+            /* First particle of the next slice in the current phase */
+            size_t next_index_ = 0;
+
+            size_t num_resumes_ = 0;
+            size_t num_resumes_per_step_ = 0;
+
+            /* Helper method for starting the next step if the last one is done, and counting calls */
+            void StartResume();
+
+            /* Helper method for doing one piece of the current phase and moving on to the next phase at its end */
+            void RunSlice();
+
+            /* Helper method for moving to the histogram phases, or straight to done if there aren't any */
+            void StartHistograms();
+    };
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstdint>
+#include <random>
+#include "particle.h"
+
+namespace idealgas {
+    /* Interface for controlling the temperature of the gas from inside ParticleController's update loop, so no
+       separate pass over the particles is needed. Temperatures are 2D kinetic temperatures: kT = mean kinetic energy */
+    class Thermostat {
+        public:
+            virtual ~Thermostat() {}
+
+            /* Called once before each step with the temperature measured during the previous step,
+               returns the factor every velocity is scaled by during the step */
+            virtual float BeginStep(const float temperature);
+
+            /* Returns true if Apply should be called for every particle */
+            virtual bool ActsOnParticles() const;
+
+            /* Called for each particle during the step, after its velocity has been scaled */
+            virtual void Apply(Particle& p);
+
+            /* Called when p hits a wall with the given inward normal, returns true if the thermostat set
+               the outgoing velocity (otherwise the particle bounces elastically) */
+            virtual bool ReflectOffWall(Particle& p, const glm::vec2& normal);
+    };
+
+    /* Rescales velocities so the temperature is exactly the target every step */
+    class VelocityRescaleThermostat : public Thermostat {
+        public:
+            explicit VelocityRescaleThermostat(const float target_temperature);
+            float BeginStep(const float temperature) override;
+
+        private:
+            const float kTargetTemperature;
+    };
+
+    /* Berendsen weak coupling: temperature relaxes exponentially towards the target with the given time
+       constant (in steps), which disturbs the dynamics less than rescaling exactly */
+    class BerendsenThermostat : public Thermostat {
+        public:
+            BerendsenThermostat(const float target_temperature, const float time_constant);
+            float BeginStep(const float temperature) override;
+
+        private:
+            const float kTargetTemperature;
+            const float kTimeConstant;
+    };
+
+    /* Andersen thermostat: each step, each particle collides with a heat bath with the given probability and
+       gets a velocity drawn from the Maxwell-Boltzmann distribution at the target temperature */
+    class AndersenThermostat : public Thermostat {
+        public:
+            AndersenThermostat(const float target_temperature, const float collision_probability, const uint32_t seed = 0);
+            bool ActsOnParticles() const override;
+            void Apply(Particle& p) override;
+
+        private:
+            const float kTargetTemperature;
+            const float kCollisionProbability;
+            std::mt19937 random_engine_;
+            std::uniform_real_distribution<float> uniform_;
+            std::normal_distribution<float> normal_;
+    };
+
+    /* Thermal walls: particles hitting a wall leave with a velocity drawn from the distribution of particles
+       leaving a gas at the wall temperature, so the walls act as a heat bath */
+    class ThermalWallThermostat : public Thermostat {
+        public:
+            ThermalWallThermostat(const float wall_temperature, const uint32_t seed = 0);
+            bool ReflectOffWall(Particle& p, const glm::vec2& normal) override;
+
+        private:
+            const float kWallTemperature;
+            std::mt19937 random_engine_;
+            std::uniform_real_distribution<float> uniform_;
+            std::normal_distribution<float> normal_;
+    };
+}
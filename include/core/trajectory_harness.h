@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "invariant_monitor.h"
+#include "particle_controller.h"
+
+using std::vector;
+
+namespace idealgas {
+    /* Anything that steps a set of particles: the reference ParticleController or a faster alternative. Particles
+       may be stored in any order, the harness matches them up by id */
+    class TrajectoryEngine {
+        public:
+            virtual ~TrajectoryEngine() {}
+
+            /* Advances every particle by one step */
+            virtual void Step() = 0;
+
+            virtual const vector<Particle>& GetParticles() const = 0;
+
+            /* Number of collisions resolved over all steps so far */
+            virtual size_t GetNumCollisions() const = 0;
+    };
+
+    /* The reference engine: ParticleController::UpdateParticles, with collisions counted by an InvariantMonitor */
+    class ControllerEngine : public TrajectoryEngine {
+        public:
+            ControllerEngine(const vector<Particle>& particles, const float x_min, const float x_max, const float y_min, const float y_max);
+
+            void Step() override;
+            const vector<Particle>& GetParticles() const override;
+            size_t GetNumCollisions() const override;
+
+            /* The wrapped controller, e.g. to change speeds or walls mid-run */
+            ParticleController& GetController();
+
+        private:
+            ParticleController particle_controller_;
+            InvariantMonitor invariant_monitor_;
+    };
+
+    /* State after one step (frame 0 is the initial state), with particles sorted by id */
+    struct TrajectoryFrame {
+        uint64_t num_collisions; //in the step that led to this frame
+        vector<uint32_t> ids;
+        vector<glm::vec2> positions;
+        vector<glm::vec2> velocities;
+    };
+
+    /* Recorded frames of a run, stored as: magic, version, number of frames and particles, then per frame the
+       collision count followed by the particles' ids, float positions and velocities */
+    struct GoldenTrajectory {
+        vector<TrajectoryFrame> frames;
+
+        /* Throw std::runtime_error if the file can't be written / read */
+        void Save(const std::string& path) const;
+        static GoldenTrajectory Load(const std::string& path);
+    };
+
+    /* How far a candidate is from the reference at one step */
+    struct StepDivergence {
+        size_t step;
+        float max_position_error;
+        float max_velocity_error;
+        int64_t collision_difference; //candidate minus reference
+        float max_histogram_delta; //largest difference in the fraction of particles in any speed bin
+    };
+
+    struct TrajectoryReport {
+        vector<StepDivergence> steps;
+        float max_position_error = 0;
+        float max_velocity_error = 0;
+        int64_t total_collision_difference = 0;
+        float max_histogram_delta = 0;
+
+        /* Whether both runs had the same particle ids at every step; if not, nothing from the first step where
+           they differ on is compared */
+        bool are_particles_matched = true;
+
+        /* First step with a position error above the tolerance, or steps.size() if there is none */
+        size_t FirstDivergentStep(const float position_tolerance) const;
+    };
+
+    /* Runs engines from the same initial state and reports how far apart their trajectories are */
+    class TrajectoryHarness {
+        public:
+            /* Speed histograms compared at each step use num_bins equal width bins from 0 to the largest speed */
+            explicit TrajectoryHarness(const size_t num_bins = 10);
+
+            /* Steps both engines num_steps times side by side and compares them after every step */
+            TrajectoryReport Compare(TrajectoryEngine& reference, TrajectoryEngine& candidate, const size_t num_steps) const;
+
+            /* Steps the candidate as many times as the golden trajectory has steps and compares it against it */
+            TrajectoryReport Compare(const GoldenTrajectory& golden, TrajectoryEngine& candidate) const;
+
+            /* Records the engine's current state and the state after each of num_steps steps */
+            static GoldenTrajectory Record(TrajectoryEngine& engine, const size_t num_steps);
+
+        private:
+            const size_t kNumBins;
+
+            /* Helper method for comparing two runs frame by frame */
+            TrajectoryReport CompareFrames(const vector<TrajectoryFrame>& reference, const vector<TrajectoryFrame>& candidate) const;
+
+            /* Helper method for the speed histogram difference of two frames */
+            float HistogramDelta(const TrajectoryFrame& reference, const TrajectoryFrame& candidate) const;
+    };
+}
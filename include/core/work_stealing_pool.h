@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+using std::vector;
+
+namespace idealgas {
+    /* Runs a fixed set of independent tasks on a group of threads. Each thread starts with a contiguous block of the
+       tasks and works through it from one end, so neighbouring tasks (e.g. small boxes) share a thread and its
+       caches; a thread that runs out steals from the other end of another thread's block */
+    class WorkStealingPool {
+        public:
+            /* Uses the given number of threads (0 for one per hardware thread) */
+            explicit WorkStealingPool(const size_t num_threads = 0);
+
+            /* Runs every task exactly once and returns when all are done, calling task(thread_index). If tasks throw,
+               the remaining tasks still run and the first exception is rethrown afterwards */
+            void Run(const vector<std::function<void(size_t thread_index)>>& tasks);
+
+            size_t GetNumThreads() const;
+
+            /* Number of tasks taken from another thread's block during the last Run */
+            size_t GetNumSteals() const;
+
+        private:
+            /* Task indices waiting on one thread; the owner takes from the front, thieves from the back */
+            struct WorkQueue {
+                std::mutex mutex;
+                std::deque<size_t> tasks;
+            };
+
+            const size_t kNumThreads;
+            size_t num_steals_ = 0;
+
+            /* Helper method for getting the next task for a thread, returns false once every queue is empty */
+            bool NextTask(vector<WorkQueue>& queues, const size_t thread_index, size_t& task, size_t& num_steals);
+    };
+}
@@ -1,17 +1,23 @@
 #pragma once
 
 #include "cinder/gl/gl.h"
+#include "core/density_field.h"
 #include "core/particle_controller.h"
 
 namespace idealgas {
     class Box {
         public:
-            /* Constructs box with given width, top left corner, and border and initializes member variables */
-            Box(size_t width, const glm::vec2& top_left, const float border_width, ParticleController& particle_controller);
+            /* Constructs box with given width, top left corner, and border and initializes member variables. Above
+               density_threshold particles in view, particles are drawn as a density field */
+            Box(size_t width, const glm::vec2& top_left, const float border_width, ParticleController& particle_controller,
+                const size_t density_threshold = 20000);
             /* Updates particles every frame */
             void UpdateBox();
             /* Draws particles every frame */
             void DrawBox();
+            /* Magnifies the box around its center (1 shows the whole box), clamped to [1, kMaxZoom] */
+            void SetZoom(const float zoom);
+            float GetZoom() const;
     
         private:
             /* Default values for box, set in parent class ideal_gas_app */
@@ -22,8 +28,24 @@ namespace idealgas {
             /* Stores and updates all particles in the box */
             ParticleController& particle_controller_;
             
+            /* Level of detail: above kDensityThreshold particles in view, particles are drawn as one density field
+               texture (one texel per pixel of the box) instead of a circle each */
+            const size_t kDensityThreshold;
+            const float kMaxZoom = 64;
+            float zoom_ = 1;
+            DensityField density_field_;
+            cinder::gl::Texture2dRef density_texture_;
+            
             /* Helper methods for drawing */
             void DrawBorder();
             void DrawParticles();
+            void DrawDensityField();
+            void DrawPiston();
+            
+            /* Helper method for the part of the box in view at the current zoom */
+            cinder::Rectf GetView() const;
+
+            /* Helper method for where a point of the box is drawn at the current zoom */
+            glm::vec2 ToScreen(const glm::vec2& point) const;
     };
 }
\ No newline at end of file
@@ -0,0 +1,62 @@
+#pragma once
+
+#include "cinder/gl/gl.h"
+#include "cinder/Text.h"
+#include "core/histogram.h"
+#include "core/maxwell_boltzmann_fit.h"
+#include <map>
+#include <string>
+
+namespace idealgas {
+    /* Retained mode drawing of one histogram: the parts that never change (border, axis titles, y labels) are baked
+       into a texture once, bars and fit are meshes whose vertices are only re-uploaded when the bins or the fit
+       change, and text that does change (title, x labels) is rendered once per distinct string and reused.
+       GL objects are made on the first Draw, once there's a context */
+    class HistogramRenderer {
+        public:
+            HistogramRenderer(const size_t width, const size_t height, const cinder::Colorf& color, const size_t num_bins);
+
+            /* Draws hist and its fit with the histogram's top left corner at top_left */
+            void Draw(Histogram& hist, MaxwellBoltzmannFit& fit, const glm::vec2& top_left);
+
+        private:
+            const float kWidth;
+            const float kHeight;
+            const cinder::Colorf kColor;
+            const size_t kNumBins;
+
+            /* Room around the histogram in the baked texture for labels and the title's circles */
+            const float kPadLeft = 80;
+            const float kPadTop = 30;
+            const float kPadRight = 10;
+            const float kPadBottom = 40;
+
+            /* Distinct x labels kept before the cache is cleared (bin edges drift as speeds change) */
+            const size_t kMaxCachedLabels = 256;
+
+            cinder::Font title_font_;
+            cinder::Font label_font_;
+
+            cinder::gl::FboRef static_layer_;
+            std::map<std::string, cinder::gl::Texture2dRef> text_textures_;
+
+            /* Bars: 4 vertices and 2 triangles each, in coordinates relative to the histogram's top left */
+            cinder::gl::VboMeshRef bars_mesh_;
+            cinder::gl::BatchRef bars_batch_;
+            vector<float> drawn_frequencies_;
+
+            /* Fit: a line strip through the center of the top of each bar */
+            cinder::gl::VboMeshRef fit_mesh_;
+            cinder::gl::BatchRef fit_batch_;
+            vector<float> drawn_fit_;
+
+            /* Helper methods for making GL objects on the first Draw and updating them when they're out of date */
+            void BakeStaticLayer();
+            void MakeMeshes();
+            void UpdateBars(const vector<float>& frequencies);
+            void UpdateFit(const vector<float>& expected_frequencies);
+
+            /* Helper method for drawing text centered on x with its top at y, rendering it only the first time */
+            void DrawText(const std::string& text, const cinder::Font& font, const glm::vec2& center_top);
+    };
+}
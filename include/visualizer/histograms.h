@@ -3,22 +3,37 @@
 #include "cinder/gl/gl.h"
 #include "core/particle_controller.h"
 #include "core/histogram.h"
+#include "core/histogram_reducer.h"
+#include "core/maxwell_boltzmann_fit.h"
+#include "core/particle_observer.h"
+#include "histogram_renderer.h"
 
 namespace idealgas {
-    class Histograms {
+    class Histograms : public ParticleObserver {
     public:
-        /* Initializes member variables and histograms_ using particles from particle_controller_ */
-        Histograms(const size_t num, const size_t width, const size_t height, glm::vec2 top_left, ParticleController& particle_controller);
+        /* Initializes member variables and histograms_ using particles from particle_controller_, binned with the given strategy */
+        Histograms(const size_t num, const size_t width, const size_t height, glm::vec2 top_left, ParticleController& particle_controller,
+                   BinningStrategy strategy = BinningStrategy::kFixedWidth, const size_t num_bins = 9);
+        /* Stops observing particle_controller_ */
+        ~Histograms();
         /* Updates histograms every frame */
         void UpdateHistograms();
         /* Draws histograms every frame */
         void DrawHistograms();
+        /* Returns true once every species' speeds match a Maxwell-Boltzmann distribution */
+        bool IsEquilibrated() const;
+        /* Histogram of each species, in particle type order */
+        vector<Histogram>& GetHistograms();
+        
+        /* Keeps each histogram's particles in sync as particles are added to or removed from the box */
+        void OnParticleAdded(const Particle& p) override;
+        void OnParticleRemoved(const Particle& p) override;
 
     private:
         const size_t kNumHists;
         const size_t kHistWidth;
         const size_t kHistHeight;
-        glm::vec2 hist_top_left_; //for first histogram, changes for other histograms
+        glm::vec2 hist_top_left_; //for first histogram, the others are below it
         
         /* Has info of particles needed for histograms */
         ParticleController& particle_controller_;
@@ -26,12 +41,14 @@ namespace idealgas {
         /* Vector of Histograms that will be drawn */
         vector<Histogram> histograms_;
         
-        /* Helper method for drawing a histogram */
-        void DrawHistogram(Histogram& hist);
-        void DrawHistBorder();
-        void DrawHistTitle();
-        void DrawXLabels(Histogram& hist);
-        void DrawYLabels(Histogram& hist);
-        void DrawBars(Histogram& hist);
+        /* Bins every species in one parallel pass over the particles */
+        HistogramReducer reducer_;
+        
+        /* Maxwell-Boltzmann fit for each histogram in histograms_, updated from the bins every frame */
+        vector<MaxwellBoltzmannFit> fits_;
+        
+        /* Retained GL state for drawing each histogram, so only what changed is re-uploaded each frame; each holds
+           its species' color, so a histogram can still be drawn once all its particles are removed */
+        vector<HistogramRenderer> renderers_;
     };
 }
\ No newline at end of file
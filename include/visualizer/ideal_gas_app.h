@@ -5,6 +5,8 @@
 #include "cinder/gl/gl.h"
 #include "box.h"
 #include "histograms.h"
+#include "core/state_publisher.h"
+#include <memory>
 
 using namespace ci;
 using namespace ci::app;
@@ -18,7 +20,8 @@ namespace idealgas {
             void update() override;
             /* Draws box and histograms every frame */
             void draw() override;
-            /* Listens for keyDown to update particle speeds: 1 = speed up, 0 = slow down */
+            /* Listens for keyDown to queue commands: 1 = heat up, 0 = cool down, left / right = move piston,
+               p = pause / resume, s = single step while paused, + / - = zoom in / out */
             void keyDown(KeyEvent event) override;
     
         private:
@@ -27,12 +30,22 @@ namespace idealgas {
             const size_t kBoxWidth = getWindowHeight() - (2 * kMargin);
             const glm::vec2 kBoxTopLeft = glm::vec2(kMargin - 30, kMargin);
             const float kBoxBorderWidth = 25;
+            const PlacementStrategy kPlacementStrategy = PlacementStrategy::kLatticeJitter; //no overlaps at startup
             
             /* Default values for histograms that display particle info */
             const size_t kNumHists = 3;
             const size_t kHistWidth = 405;
             const size_t kHistHeight = 210;
             const glm::vec2 kHistTopLeft = glm::vec2(kMargin + kBoxWidth + 50, kMargin); //for 1st histogram
+            const BinningStrategy kBinningStrategy = BinningStrategy::kFixedWidth;
+            const size_t kNumBins = 9;
+            
+            /* Runtime controls: temperature change per key press (speeds change by 10%), piston move per key press,
+               and how many frames each change is spread over */
+            const float kTemperatureChange = 1.21f;
+            const float kPistonMove = 40;
+            const size_t kRampSteps = 30;
+            const float kZoomChange = 1.25f; //box magnification per +/- key press
             
             /* Controls/stores particles; passed by reference to box_ and histograms_ */
             ParticleController particle_controller_;
@@ -40,6 +53,13 @@ namespace idealgas {
             Box box_;
             Histograms histograms_;
             
+#ifndef _WIN32
+            /* Exports each frame to shared memory for other processes, only when the IDEALGAS_SHM_NAME
+               environment variable names a segment (e.g. /idealgas) */
+            std::unique_ptr<StatePublisher> state_publisher_;
+            const size_t kMaxPublishedParticles = 100000;
+#endif
+            
             /* Drawing helper methods */
             void DrawTitle();
             void DrawSpeedInfo();
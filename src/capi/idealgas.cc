@@ -0,0 +1,255 @@
+#include "capi/idealgas.h"
+#include "core/histogram.h"
+#include "core/histogram_reducer.h"
+#include "core/maxwell_boltzmann_fit.h"
+#include "core/particle_controller.h"
+#include "core/particle_placer.h"
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+using idealgas::Histogram;
+using idealgas::HistogramReducer;
+using idealgas::MaxwellBoltzmannFit;
+using idealgas::Particle;
+using idealgas::ParticleController;
+using idealgas::ParticleSpecies;
+using idealgas::ParticlePlacer;
+
+/* Everything a handle owns, the C side only ever sees a pointer to it */
+struct idealgas_box {
+    float width;
+    float height;
+    size_t num_bins;
+    uint32_t seed;
+    vector<ParticleSpecies> species; //added through the C interface, placed together on the first step
+
+    /* Made on the first step; histograms refer to the controller, which stays put behind its pointer */
+    std::unique_ptr<ParticleController> particle_controller;
+    vector<Histogram> histograms;
+    HistogramReducer reducer;
+    
+    /* One per species, only updated by idealgas_box_step_until_equilibrated */
+    vector<MaxwellBoltzmannFit> fits;
+    bool is_equilibrated = false;
+};
+
+namespace {
+    /* Each thread's last failure, so callers on different threads don't see each other's messages */
+    thread_local std::string last_error;
+
+    /* Thrown for calls made at the wrong time, reported as IDEALGAS_INVALID_STATE */
+    struct InvalidStateError : std::logic_error {
+        explicit InvalidStateError(const std::string& message) : std::logic_error(message) {}
+    };
+
+    /* Runs func and turns anything it throws into a status, since exceptions can't cross into C */
+    template <typename Func>
+    idealgas_status Guard(const Func& func) {
+        try {
+            func();
+            last_error.clear();
+            return IDEALGAS_OK;
+        } catch (const std::invalid_argument& e) {
+            last_error = e.what();
+            return IDEALGAS_INVALID_ARGUMENT;
+        } catch (const InvalidStateError& e) {
+            last_error = e.what();
+            return IDEALGAS_INVALID_STATE;
+        } catch (const std::bad_alloc&) {
+            last_error = "out of memory";
+            return IDEALGAS_OUT_OF_MEMORY;
+        } catch (const std::exception& e) {
+            last_error = e.what();
+            return IDEALGAS_INTERNAL_ERROR;
+        } catch (...) {
+            last_error = "unknown error";
+            return IDEALGAS_INTERNAL_ERROR;
+        }
+    }
+
+    void RequireNotNull(const void* pointer, const char* name) {
+        if (pointer == nullptr) throw std::invalid_argument(std::string(name) + " is null");
+    }
+
+    /* Places every species without overlaps (spaced for the largest radius) and makes the controller and histograms */
+    void PlaceParticles(idealgas_box& box) {
+        ParticlePlacer placer(0, box.width, 0, box.height, box.seed);
+        std::unique_ptr<ParticleController> particle_controller(
+                new ParticleController(placer.MakeParticles(box.species), 0, box.width, 0, box.height));
+        //species can differ a lot in size, which the grid handles at no extra cost per particle
+        particle_controller->SetHierarchicalGrid(true);
+
+        vector<size_t> types;
+        vector<MaxwellBoltzmannFit> fits;
+        for (const ParticleSpecies& species : box.species) {
+            types.push_back(species.type);
+            fits.push_back(MaxwellBoltzmannFit(species.mass));
+        }
+        vector<Histogram> histograms = idealgas::MakeSpeciesHistograms(*particle_controller, types,
+                                                                       idealgas::BinningStrategy::kFixedWidth, box.num_bins);
+
+        //only kept once everything is made, so a failure leaves the box as it was
+        box.particle_controller = std::move(particle_controller);
+        box.histograms = std::move(histograms);
+        box.fits = std::move(fits);
+    }
+
+    /* Places the particles on the first step */
+    void RequirePlaced(idealgas_box& box) {
+        if (box.particle_controller) return;
+        if (box.species.empty()) throw InvalidStateError("add a species before stepping");
+        PlaceParticles(box);
+    }
+
+    /* View of one field of every particle, starting at that field of the first particle */
+    idealgas_status MakeView(const idealgas_box* box, idealgas_view* view, const size_t field_offset,
+                             const size_t num_components, const idealgas_scalar_type type, const int fraction_bits) {
+        return Guard([&] {
+            RequireNotNull(box, "box");
+            RequireNotNull(view, "view");
+            const vector<Particle>* particles = box->particle_controller ? &box->particle_controller->GetParticles() : nullptr;
+            bool is_empty = particles == nullptr || particles->empty();
+
+            view->data = is_empty ? nullptr : reinterpret_cast<const char*>(particles->data()) + field_offset;
+            view->count = is_empty ? 0 : particles->size();
+            view->stride = sizeof(Particle);
+            view->num_components = num_components;
+            view->type = type;
+            view->fraction_bits = fraction_bits;
+        });
+    }
+}
+
+extern "C" {
+    uint32_t idealgas_api_version(void) {
+        return IDEALGAS_API_VERSION;
+    }
+
+    const char* idealgas_last_error(void) {
+        return last_error.c_str();
+    }
+
+    idealgas_box* idealgas_box_create(float width, float height, size_t num_bins, uint32_t seed) {
+        idealgas_box* box = nullptr;
+        Guard([&] {
+            if (!(width > 0 && height > 0)) throw std::invalid_argument("box width and height must be positive");
+            if (num_bins == 0) throw std::invalid_argument("histograms need at least one bin");
+            box = new idealgas_box();
+            box->width = width;
+            box->height = height;
+            box->num_bins = num_bins;
+            box->seed = seed;
+        });
+        return box;
+    }
+
+    void idealgas_box_destroy(idealgas_box* box) {
+        delete box;
+    }
+
+    idealgas_status idealgas_box_add_species(idealgas_box* box, float mass, float radius, size_t count, float max_initial_speed) {
+        return Guard([&] {
+            RequireNotNull(box, "box");
+            if (box->particle_controller) throw InvalidStateError("species can't be added after the first step");
+            if (!(mass > 0 && radius > 0)) throw std::invalid_argument("mass and radius must be positive");
+            if (count == 0) throw std::invalid_argument("a species needs at least one particle");
+            if (!(max_initial_speed >= 0)) throw std::invalid_argument("max initial speed can't be negative");
+
+            //types are 1, 2, ... in the order species were added, so histogram i is species i
+            ParticleSpecies species = {box->species.size() + 1, count, mass, radius, max_initial_speed, cinder::Colorf(1, 1, 1)};
+            box->species.push_back(species);
+        });
+    }
+
+    idealgas_status idealgas_box_step(idealgas_box* box, size_t num_steps) {
+        return Guard([&] {
+            RequireNotNull(box, "box");
+            RequirePlaced(*box);
+
+            for (size_t step = 0; step < num_steps; ++step) {
+                box->particle_controller->UpdateParticles();
+            }
+            if (num_steps > 0) box->reducer.Reduce(box->histograms, box->particle_controller->GetParticles());
+        });
+    }
+
+    idealgas_status idealgas_box_step_until_equilibrated(idealgas_box* box, size_t max_steps, size_t check_interval,
+                                                         size_t* num_steps) {
+        if (num_steps != nullptr) *num_steps = 0;
+        return Guard([&] {
+            RequireNotNull(box, "box");
+            if (check_interval == 0) throw std::invalid_argument("check interval must be at least 1");
+            RequirePlaced(*box);
+
+            size_t step = 0;
+            while (step < max_steps && !box->is_equilibrated) {
+                box->particle_controller->UpdateParticles();
+                step++;
+                if (num_steps != nullptr) *num_steps = step;
+                if (step % check_interval == 0) {
+                    box->reducer.Reduce(box->histograms, box->particle_controller->GetParticles());
+                    box->is_equilibrated = MaxwellBoltzmannFit::UpdateAll(box->fits, box->histograms);
+                }
+            }
+            //histograms always describe the last step, as after idealgas_box_step
+            if (step % check_interval != 0) box->reducer.Reduce(box->histograms, box->particle_controller->GetParticles());
+        });
+    }
+
+    int idealgas_box_is_equilibrated(const idealgas_box* box) {
+        return box != nullptr && box->is_equilibrated ? 1 : 0;
+    }
+
+    size_t idealgas_box_num_particles(const idealgas_box* box) {
+        return box != nullptr && box->particle_controller ? box->particle_controller->GetParticles().size() : 0;
+    }
+
+    float idealgas_box_temperature(const idealgas_box* box) {
+        return box != nullptr && box->particle_controller ? box->particle_controller->GetTemperature() : 0;
+    }
+
+    idealgas_status idealgas_box_positions(const idealgas_box* box, idealgas_view* view) {
+#if defined(IDEALGAS_PRECISION_DOUBLE)
+        return MakeView(box, view, offsetof(Particle, pos), 2, IDEALGAS_FLOAT64, 0);
+#elif defined(IDEALGAS_PRECISION_FIXED)
+        return MakeView(box, view, offsetof(Particle, pos), 2, IDEALGAS_FIXED32, IDEALGAS_FIXED_FRACTION_BITS);
+#else
+        return MakeView(box, view, offsetof(Particle, pos), 2, IDEALGAS_FLOAT32, 0);
+#endif
+    }
+
+    idealgas_status idealgas_box_velocities(const idealgas_box* box, idealgas_view* view) {
+        return MakeView(box, view, offsetof(Particle, vel), 2, sizeof(idealgas::Real) == sizeof(double) ? IDEALGAS_FLOAT64 : IDEALGAS_FLOAT32, 0);
+    }
+
+    idealgas_status idealgas_box_ids(const idealgas_box* box, idealgas_view* view) {
+        return MakeView(box, view, offsetof(Particle, id), 1, IDEALGAS_UINT32, 0);
+    }
+
+    idealgas_status idealgas_box_types(const idealgas_box* box, idealgas_view* view) {
+        return MakeView(box, view, offsetof(Particle, type), 1, IDEALGAS_SIZE_T, 0);
+    }
+
+    idealgas_status idealgas_box_histogram(const idealgas_box* box, size_t species_index, const float** speeds,
+                                           const float** frequencies, size_t* num_bins) {
+        return Guard([&] {
+            RequireNotNull(box, "box");
+            RequireNotNull(speeds, "speeds");
+            RequireNotNull(frequencies, "frequencies");
+            RequireNotNull(num_bins, "num_bins");
+            if (!box->particle_controller) throw InvalidStateError("there are no histograms before the first step");
+            if (species_index >= box->histograms.size()) throw std::invalid_argument("no species with that index");
+
+            //const only on the C side, the histogram getters aren't const
+            Histogram& hist = const_cast<Histogram&>(box->histograms[species_index]);
+            *speeds = hist.GetXValues().data();
+            *frequencies = hist.GetBinFrequencies().data();
+            *num_bins = hist.GetNumBins();
+        });
+    }
+}
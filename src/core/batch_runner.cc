@@ -0,0 +1,111 @@
+#include "core/batch_runner.h"
+#include "core/maxwell_boltzmann_fit.h"
+#include <sstream>
+
+namespace idealgas {
+    BatchRunner::BatchRunner(std::ostream& out, const size_t num_threads)
+    : out_(out),
+      pool_(num_threads) {}
+
+    void BatchRunner::Run(const vector<RunConfig>& configs) {
+        out_ << "run_id,seed,temperature,num_steps,is_equilibrated,type,num_particles,mean_speed,x_values,bin_frequencies\n";
+
+        vector<std::function<void(size_t)>> tasks;
+        for (const RunConfig& config : configs) {
+            tasks.push_back([this, &config](size_t) {
+                WriteResult(RunOne(config));
+            });
+        }
+        pool_.Run(tasks);
+        out_.flush();
+    }
+
+    vector<Particle> BatchRunner::PlaceParticles(const RunConfig& config) {
+        vector<ParticleSpecies> species;
+        for (const SpeciesConfig& s : config.species) {
+            species.push_back({s.type, s.count, s.mass, s.radius, config.max_initial_speed, cinder::Colorf(1, 1, 1)});
+        }
+        ParticlePlacer placer(0, config.box_width, 0, config.box_width, config.seed);
+        return placer.MakeParticles(species, config.placement);
+    }
+
+    RunResult BatchRunner::RunOne(const RunConfig& config) {
+        ParticleController particle_controller(PlaceParticles(config), 0, config.box_width, 0, config.box_width);
+
+        //one histogram and fit per species, in config order (types needn't be 1, 2, 3...)
+        vector<size_t> types;
+        vector<MaxwellBoltzmannFit> fits;
+        for (const SpeciesConfig& species : config.species) {
+            types.push_back(species.type);
+            fits.push_back(MaxwellBoltzmannFit(species.mass));
+        }
+        vector<Histogram> histograms = MakeSpeciesHistograms(particle_controller, types, BinningStrategy::kFixedWidth,
+                                                             config.num_bins);
+
+        RunResult result;
+        result.num_steps = 0;
+        result.is_equilibrated = false;
+        while (result.num_steps < config.num_steps && !result.is_equilibrated) {
+            particle_controller.UpdateParticles();
+            result.num_steps++;
+            if (config.equilibrium_check_interval > 0 && result.num_steps % config.equilibrium_check_interval == 0) {
+                for (Histogram& hist : histograms) {
+                    hist.UpdateHistogram();
+                }
+                result.is_equilibrated = MaxwellBoltzmannFit::UpdateAll(fits, histograms);
+            }
+        }
+
+        result.run_id = config.run_id;
+        result.seed = config.seed;
+        result.temperature = particle_controller.GetTemperature();
+
+        for (size_t s = 0; s < config.species.size(); ++s) {
+            Histogram& hist = histograms[s];
+            hist.UpdateHistogram();
+            float total_speed = 0;
+            for (uint32_t id : hist.GetIds()) {
+                total_speed += particle_controller.GetParticle(id).speed;
+            }
+
+            SpeciesResult species_result;
+            species_result.type = config.species[s].type;
+            species_result.num_particles = hist.GetIds().size();
+            species_result.mean_speed = hist.GetIds().empty() ? 0 : total_speed / hist.GetIds().size();
+            species_result.x_values = hist.GetXValues();
+            species_result.bin_frequencies = hist.GetBinFrequencies();
+            result.species.push_back(species_result);
+        }
+
+        return result;
+    }
+
+    void BatchRunner::WriteResult(const RunResult& result) {
+        //formatted outside the lock, so threads only wait on each other for the write itself
+        std::ostringstream lines;
+        for (const SpeciesResult& species : result.species) {
+            lines << result.run_id << ',' << result.seed << ',' << result.temperature << ',' << result.num_steps << ','
+                  << result.is_equilibrated << ',' << species.type << ',' << species.num_particles << ','
+                  << species.mean_speed << ',';
+            //lists are space separated so each stays one CSV field
+            for (size_t i = 0; i < species.x_values.size(); ++i) {
+                lines << (i > 0 ? " " : "") << species.x_values[i];
+            }
+            lines << ',';
+            for (size_t i = 0; i < species.bin_frequencies.size(); ++i) {
+                lines << (i > 0 ? " " : "") << species.bin_frequencies[i];
+            }
+            lines << '\n';
+        }
+
+        std::lock_guard<std::mutex> lock(out_mutex_);
+        out_ << lines.str();
+        out_.flush(); //finished runs survive if the batch is stopped early
+        num_completed_++;
+    }
+
+    size_t BatchRunner::GetNumCompleted() const {
+        std::lock_guard<std::mutex> lock(out_mutex_);
+        return num_completed_;
+    }
+}
@@ -0,0 +1,69 @@
+#include "core/collision_kernel.h"
+#include <algorithm>
+
+namespace idealgas {
+    /* Number of neighbours tested together in ResolveNeighbours (8 floats fill a 256 bit register) */
+    static const size_t kBatchSize = 8;
+
+    bool ResolvePair(Particle& p1, Particle& p2) {
+        Vec2 pos_diff = ToVec2(p1.pos) - ToVec2(p2.pos);
+        Vec2 vel_diff = p1.vel - p2.vel;
+        Real dist_squared = glm::dot(pos_diff, pos_diff);
+        Real approach = glm::dot(vel_diff, pos_diff);
+        Real contact_dist = p1.radius + p2.radius;
+
+        //moving towards each other and touching (a 0 distance has no collision normal, so it doesn't count)
+        bool collided = approach < 0 && dist_squared <= contact_dist * contact_dist && dist_squared > 0;
+
+        //v1' = v1 - 2m2 / (m1 + m2) * (v1 - v2)dot(p1 - p2) / ||p1 - p2||^2 * (p1 - p2), and v2' the same with
+        //m1 and the sign flipped, so both share impulse = 2 * (v1 - v2)dot(p1 - p2) / ((m1 + m2)||p1 - p2||^2)
+        Real impulse = collided ? 2 * approach / ((p1.mass + p2.mass) * dist_squared) : 0;
+        p1.vel -= pos_diff * (p2.mass * impulse);
+        p2.vel += pos_diff * (p1.mass * impulse);
+        return collided;
+    }
+
+    size_t ResolveNeighbours(Particle& p, vector<Particle>& particles, const vector<uint32_t>& id_to_index,
+                             const uint32_t* neighbour_ids, const size_t num_neighbours) {
+        //structure of arrays for one batch, each lane is one neighbour
+        Real pos_diff_x[kBatchSize];
+        Real pos_diff_y[kBatchSize];
+        Real vel_diff_x[kBatchSize];
+        Real vel_diff_y[kBatchSize];
+        Real contact_dist[kBatchSize];
+        bool is_touching[kBatchSize];
+
+        size_t num_collisions = 0;
+        size_t begin = 0;
+        while (begin < num_neighbours) {
+            size_t num_lanes = std::min(kBatchSize, num_neighbours - begin);
+            Vec2 pos = ToVec2(p.pos);
+            for (size_t lane = 0; lane < num_lanes; ++lane) {
+                const Particle& neighbour = particles[id_to_index[neighbour_ids[begin + lane]]];
+                Vec2 pos_diff = pos - ToVec2(neighbour.pos);
+                pos_diff_x[lane] = pos_diff.x;
+                pos_diff_y[lane] = pos_diff.y;
+                vel_diff_x[lane] = p.vel.x - neighbour.vel.x;
+                vel_diff_y[lane] = p.vel.y - neighbour.vel.y;
+                contact_dist[lane] = p.radius + neighbour.radius;
+            }
+
+            //same test as ResolvePair, with no branches or calls so every lane runs in lockstep
+            for (size_t lane = 0; lane < num_lanes; ++lane) {
+                Real dist_squared = pos_diff_x[lane] * pos_diff_x[lane] + pos_diff_y[lane] * pos_diff_y[lane];
+                Real approach = vel_diff_x[lane] * pos_diff_x[lane] + vel_diff_y[lane] * pos_diff_y[lane];
+                is_touching[lane] = (approach < 0) & (dist_squared <= contact_dist[lane] * contact_dist[lane]) & (dist_squared > 0);
+            }
+
+            //pairs before the first collision wouldn't have changed any velocity, so they're skipped
+            size_t lane = 0;
+            while (lane < num_lanes && !is_touching[lane]) lane++;
+            if (lane < num_lanes && ResolvePair(p, particles[id_to_index[neighbour_ids[begin + lane]]])) {
+                num_collisions++;
+            }
+            begin += std::min(lane + 1, num_lanes);
+        }
+
+        return num_collisions;
+    }
+}
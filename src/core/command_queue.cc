@@ -0,0 +1,40 @@
+#include "core/command_queue.h"
+
+namespace idealgas {
+    SimulationCommand SimulationCommand::TemperatureRamp(const float temperature_factor, const size_t num_steps) {
+        SimulationCommand command = {CommandType::kTemperatureRamp, temperature_factor, num_steps};
+        return command;
+    }
+
+    SimulationCommand SimulationCommand::MoveWall(const float x_max, const size_t num_steps) {
+        SimulationCommand command = {CommandType::kMoveWall, x_max, num_steps};
+        return command;
+    }
+
+    SimulationCommand SimulationCommand::Pause() {
+        SimulationCommand command = {CommandType::kPause, 0, 0};
+        return command;
+    }
+
+    SimulationCommand SimulationCommand::Resume() {
+        SimulationCommand command = {CommandType::kResume, 0, 0};
+        return command;
+    }
+
+    SimulationCommand SimulationCommand::SingleStep() {
+        SimulationCommand command = {CommandType::kSingleStep, 0, 1};
+        return command;
+    }
+
+    void CommandQueue::Push(const SimulationCommand& command) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        commands_.push_back(command);
+    }
+
+    vector<SimulationCommand> CommandQueue::Drain() {
+        vector<SimulationCommand> drained;
+        std::lock_guard<std::mutex> lock(mutex_);
+        drained.swap(commands_);
+        return drained;
+    }
+}
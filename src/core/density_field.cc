@@ -0,0 +1,112 @@
+#include "core/density_field.h"
+#include "core/parallel_for.h"
+#include <algorithm>
+#include <cmath>
+
+namespace idealgas {
+    DensityField::DensityField(const size_t width, const size_t height)
+    : kWidth(width),
+      kHeight(height),
+      counts_(width * height, 0),
+      pixels_(4 * width * height, 0) {}
+
+    void DensityField::Splat(const vector<Particle>& particles, const float x_min, const float x_max, const float y_min, const float y_max) {
+        size_t num_pixels = kWidth * kHeight;
+        size_t num_chunks = GetNumChunks(particles.size(), kMinPerThread);
+        if (thread_counts_.size() < num_chunks) {
+            thread_colors_.resize(num_chunks);
+            thread_counts_.resize(num_chunks);
+        }
+
+        float x_scale = kWidth / (x_max - x_min);
+        float y_scale = kHeight / (y_max - y_min);
+        ParallelFor(particles.size(), kMinPerThread, [&](size_t begin, size_t end, size_t thread_index) {
+            vector<float>& colors = thread_colors_[thread_index];
+            vector<uint32_t>& counts = thread_counts_[thread_index];
+            colors.assign(3 * num_pixels, 0);
+            counts.assign(num_pixels, 0);
+
+            for (size_t i = begin; i < end; ++i) {
+                const Particle& p = particles[i];
+                glm::vec2 pos = ToVec2(p.pos);
+                if (pos.x < x_min || pos.x >= x_max || pos.y < y_min || pos.y >= y_max) continue;
+
+                //min keeps a center just below the max edge from rounding up past the last pixel
+                size_t x = std::min(static_cast<size_t>((pos.x - x_min) * x_scale), kWidth - 1);
+                size_t y = std::min(static_cast<size_t>((pos.y - y_min) * y_scale), kHeight - 1);
+                size_t pixel = y * kWidth + x;
+                counts[pixel]++;
+                colors[3 * pixel] += p.color.r;
+                colors[3 * pixel + 1] += p.color.g;
+                colors[3 * pixel + 2] += p.color.b;
+            }
+        });
+
+        //sum the threads' buffers, each thread taking its own rows of pixels
+        ParallelFor(num_pixels, kMinPerThread, [&](size_t begin, size_t end, size_t) {
+            for (size_t pixel = begin; pixel < end; ++pixel) {
+                uint32_t count = 0;
+                for (size_t t = 0; t < num_chunks; ++t) {
+                    count += thread_counts_[t][pixel];
+                }
+                counts_[pixel] = count;
+            }
+        });
+        uint32_t max_count = num_pixels == 0 ? 0 : *std::max_element(counts_.begin(), counts_.end());
+        float log_max_count = static_cast<float>(log1p(static_cast<double>(max_count)));
+
+        ParallelFor(num_pixels, kMinPerThread, [&](size_t begin, size_t end, size_t) {
+            for (size_t pixel = begin; pixel < end; ++pixel) {
+                uint32_t count = counts_[pixel];
+                if (count == 0) {
+                    std::fill(pixels_.begin() + 4 * pixel, pixels_.begin() + 4 * pixel + 4, 0);
+                    continue;
+                }
+
+                float r = 0;
+                float g = 0;
+                float b = 0;
+                for (size_t t = 0; t < num_chunks; ++t) {
+                    r += thread_colors_[t][3 * pixel];
+                    g += thread_colors_[t][3 * pixel + 1];
+                    b += thread_colors_[t][3 * pixel + 2];
+                }
+
+                //a single particle still shows at half brightness, the densest pixel at full
+                float brightness = 0.5f + 0.5f * static_cast<float>(log1p(static_cast<double>(count))) / log_max_count;
+                float scale = 255 * brightness / count;
+                pixels_[4 * pixel] = static_cast<uint8_t>(std::min(r * scale, 255.0f));
+                pixels_[4 * pixel + 1] = static_cast<uint8_t>(std::min(g * scale, 255.0f));
+                pixels_[4 * pixel + 2] = static_cast<uint8_t>(std::min(b * scale, 255.0f));
+                pixels_[4 * pixel + 3] = 255;
+            }
+        });
+    }
+
+    size_t DensityField::CountInView(const vector<Particle>& particles, const float x_min, const float x_max, const float y_min,
+                                     const float y_max, const size_t max_count) {
+        size_t count = 0;
+        for (const Particle& p : particles) {
+            glm::vec2 pos = ToVec2(p.pos);
+            if (pos.x < x_min || pos.x >= x_max || pos.y < y_min || pos.y >= y_max) continue;
+            if (++count > max_count) break;
+        }
+        return count;
+    }
+
+    const vector<uint8_t>& DensityField::GetPixels() const {
+        return pixels_;
+    }
+
+    uint32_t DensityField::GetCount(const size_t x, const size_t y) const {
+        return counts_[y * kWidth + x];
+    }
+
+    size_t DensityField::GetWidth() const {
+        return kWidth;
+    }
+
+    size_t DensityField::GetHeight() const {
+        return kHeight;
+    }
+}
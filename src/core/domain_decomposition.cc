@@ -0,0 +1,93 @@
+#include "core/domain_decomposition.h"
+
+namespace idealgas {
+    DomainDecomposition::DomainDecomposition(ParticleTransport& transport, const vector<Particle>& particles, const float x_min,
+                                             const float x_max, const float y_min, const float y_max, const float halo_width)
+    : transport_(transport),
+      kSlabXMin(SlabXMin(transport, x_min, x_max, transport.GetRank())),
+      kSlabXMax(SlabXMin(transport, x_min, x_max, transport.GetRank() + 1)),
+      kHaloWidth(halo_width),
+      controller_(SelectSlab(particles, kSlabXMin, kSlabXMax), kSlabXMin, kSlabXMax, y_min, y_max) {
+        //only the outer walls of the whole box bounce particles
+        controller_.SetOpenWalls(transport_.GetRank() > 0, transport_.GetRank() < transport_.GetNumRanks() - 1);
+    }
+
+    void DomainDecomposition::Step() {
+        ExchangeHalos();
+        controller_.UpdateParticles();
+        RemoveGhosts();
+        MigrateParticles();
+    }
+
+    void DomainDecomposition::ExchangeHalos() {
+        vector<Particle> left_halo;
+        vector<Particle> right_halo;
+        for (const Particle& p : controller_.GetParticles()) {
+            float x = ToVec2(p.pos).x;
+            if (x < kSlabXMin + kHaloWidth) left_halo.push_back(p);
+            if (x >= kSlabXMax - kHaloWidth) right_halo.push_back(p);
+        }
+
+        //every rank exchanges left then right, so rank i's right exchange always meets rank i + 1's left exchange
+        vector<Particle> ghosts = transport_.Exchange(Neighbour::kLeft, left_halo);
+        vector<Particle> right_ghosts = transport_.Exchange(Neighbour::kRight, right_halo);
+        ghosts.insert(ghosts.end(), right_ghosts.begin(), right_ghosts.end());
+
+        //the neighbour updates its own copy of each ghost, so they're only collided with here
+        controller_.SetGhosts(ghosts);
+        num_ghosts_ = ghosts.size();
+    }
+
+    void DomainDecomposition::RemoveGhosts() {
+        controller_.SetGhosts(vector<Particle>());
+    }
+
+    void DomainDecomposition::MigrateParticles() {
+        bool has_left = transport_.GetRank() > 0;
+        bool has_right = transport_.GetRank() < transport_.GetNumRanks() - 1;
+
+        vector<Particle> to_left;
+        vector<Particle> to_right;
+        controller_.RemoveParticlesIf([&](const Particle& p) {
+            float x = ToVec2(p.pos).x;
+            if (has_left && x < kSlabXMin) {
+                to_left.push_back(p);
+                return true;
+            }
+            if (has_right && x >= kSlabXMax) {
+                to_right.push_back(p);
+                return true;
+            }
+            return false;
+        });
+        num_migrated_ += to_left.size() + to_right.size();
+
+        for (const Particle& p : transport_.Exchange(Neighbour::kLeft, to_left)) {
+            controller_.AddParticle(p);
+        }
+        for (const Particle& p : transport_.Exchange(Neighbour::kRight, to_right)) {
+            controller_.AddParticle(p);
+        }
+    }
+
+    vector<Particle> DomainDecomposition::SelectSlab(const vector<Particle>& particles, const float slab_x_min, const float slab_x_max) {
+        vector<Particle> slab;
+        for (const Particle& p : particles) {
+            float x = ToVec2(p.pos).x;
+            if (x >= slab_x_min && x < slab_x_max) slab.push_back(p);
+        }
+        return slab;
+    }
+
+    float DomainDecomposition::SlabXMin(const ParticleTransport& transport, const float x_min, const float x_max, const int rank) {
+        //the last slab ends exactly at x_max, whatever rounding did to the width
+        if (rank >= transport.GetNumRanks()) return x_max;
+        return x_min + rank * (x_max - x_min) / transport.GetNumRanks();
+    }
+
+    ParticleController& DomainDecomposition::GetController() { return controller_; }
+    float DomainDecomposition::GetSlabXMin() const { return kSlabXMin; }
+    float DomainDecomposition::GetSlabXMax() const { return kSlabXMax; }
+    size_t DomainDecomposition::GetNumGhosts() const { return num_ghosts_; }
+    size_t DomainDecomposition::GetNumMigrated() const { return num_migrated_; }
+}
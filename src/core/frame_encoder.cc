@@ -0,0 +1,197 @@
+#include "core/frame_encoder.h"
+#include "core/png_encoder.h"
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define popen _popen
+#define pclose _pclose
+#else
+#include <csignal>
+#include <pthread.h>
+#endif
+
+namespace idealgas {
+    /* Helper function for taking the SIGPIPE a failed pipe write left pending on the encoder thread */
+    static void DiscardPendingSigpipe() {
+#ifndef _WIN32
+        sigset_t pending;
+        sigpending(&pending);
+        if (sigismember(&pending, SIGPIPE)) {
+            sigset_t sigpipe;
+            sigemptyset(&sigpipe);
+            sigaddset(&sigpipe, SIGPIPE);
+            int signal;
+            sigwait(&sigpipe, &signal);
+        }
+#endif
+    }
+
+    FrameEncoder::FrameEncoder(const std::string& target, const CaptureSink sink, const size_t width, const size_t height,
+                               const size_t max_queued_frames, const FullQueuePolicy policy)
+    : kTarget(target),
+      kSink(sink),
+      kWidth(width),
+      kHeight(height),
+      kMaxQueuedFrames(std::max<size_t>(max_queued_frames, 1)),
+      kPolicy(policy) {
+        if (kSink == CaptureSink::kPipe) {
+#ifdef _WIN32
+            pipe_ = popen(kTarget.c_str(), "wb");
+#else
+            pipe_ = popen(kTarget.c_str(), "w");
+#endif
+            if (pipe_ == nullptr) {
+                throw std::runtime_error("couldn't start " + kTarget);
+            }
+            //frames are written whole by the encoder thread, so pclose has nothing left to write on the caller's
+            //thread, where SIGPIPE isn't blocked
+            setvbuf(pipe_, nullptr, _IONBF, 0);
+        }
+        encoder_thread_ = std::thread(&FrameEncoder::EncodeFrames, this);
+    }
+
+    FrameEncoder::~FrameEncoder() {
+        try {
+            Finish();
+        } catch (...) {
+            //nothing to report to from a destructor, callers who care call Finish themselves
+        }
+    }
+
+    bool FrameEncoder::Submit(const vector<uint8_t>& rgb) {
+        if (rgb.size() != 3 * kWidth * kHeight) {
+            throw std::invalid_argument("frame doesn't match the capture size");
+        }
+        QueuedFrame frame;
+        frame.rgb = rgb;
+        return Enqueue(frame);
+    }
+
+    bool FrameEncoder::Submit(std::function<void(vector<uint8_t>& rgb)> draw) {
+        QueuedFrame frame;
+        frame.draw = std::move(draw);
+        return Enqueue(frame);
+    }
+
+    bool FrameEncoder::Enqueue(QueuedFrame& frame) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (is_finishing_) {
+            throw std::logic_error("frame submitted after Finish");
+        }
+        if (kPolicy == FullQueuePolicy::kWait) {
+            frame_taken_.wait(lock, [this] { return queue_.size() < kMaxQueuedFrames; });
+        }
+        if (queue_.size() >= kMaxQueuedFrames) {
+            num_dropped_++;
+            return false;
+        }
+        queue_.push_back(std::move(frame));
+        frame_ready_.notify_one();
+        return true;
+    }
+
+    bool FrameEncoder::IsFull() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return kPolicy == FullQueuePolicy::kDrop && queue_.size() >= kMaxQueuedFrames;
+    }
+
+    void FrameEncoder::Finish() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (is_finished_) {
+                return;
+            }
+            is_finishing_ = true;
+            frame_ready_.notify_one();
+        }
+        encoder_thread_.join();
+
+        std::exception_ptr error;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            is_finished_ = true;
+            error = error_;
+        }
+        if (pipe_ != nullptr && pclose(pipe_) != 0 && !error) {
+            pipe_ = nullptr;
+            throw std::runtime_error(kTarget + " failed");
+        }
+        pipe_ = nullptr;
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+
+    void FrameEncoder::EncodeFrames() {
+#ifndef _WIN32
+        //a write to a pipe whose command has exited then fails with EPIPE, leaving the signal pending
+        sigset_t sigpipe;
+        sigemptyset(&sigpipe);
+        sigaddset(&sigpipe, SIGPIPE);
+        pthread_sigmask(SIG_BLOCK, &sigpipe, nullptr);
+#endif
+
+        size_t index = 0;
+        while (true) {
+            QueuedFrame frame;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                frame_ready_.wait(lock, [this] { return !queue_.empty() || is_finishing_; });
+                if (queue_.empty()) return;
+                frame = std::move(queue_.front());
+                queue_.pop_front();
+                frame_taken_.notify_one();
+            }
+
+            //frames after an error are dropped, so the simulation isn't stopped by a full disk
+            bool has_failed;
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                has_failed = static_cast<bool>(error_);
+            }
+            if (has_failed) continue;
+
+            try {
+                if (frame.draw) {
+                    frame.draw(frame.rgb);
+                    if (frame.rgb.size() != 3 * kWidth * kHeight) {
+                        throw std::invalid_argument("drawn frame doesn't match the capture size");
+                    }
+                }
+                EncodeFrame(frame.rgb, index++);
+                std::lock_guard<std::mutex> lock(mutex_);
+                num_encoded_++;
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                error_ = std::current_exception();
+            }
+        }
+    }
+
+    void FrameEncoder::EncodeFrame(const vector<uint8_t>& rgb, const size_t index) {
+        if (kSink == CaptureSink::kPipe) {
+            if (fwrite(rgb.data(), 1, rgb.size(), pipe_) != rgb.size()) {
+                DiscardPendingSigpipe();
+                throw std::runtime_error("couldn't write a frame to " + kTarget);
+            }
+            return;
+        }
+
+        char number[32];
+        snprintf(number, sizeof(number), "%06lu", static_cast<unsigned long>(index));
+        WritePng(kTarget + number + ".png", rgb, kWidth, kHeight);
+    }
+
+    size_t FrameEncoder::GetNumEncoded() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return num_encoded_;
+    }
+
+    size_t FrameEncoder::GetNumDropped() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return num_dropped_;
+    }
+}
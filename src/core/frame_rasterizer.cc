@@ -0,0 +1,163 @@
+#include "core/frame_rasterizer.h"
+#include <algorithm>
+#include <cmath>
+
+namespace idealgas {
+    static uint8_t ToByte(const float channel) {
+        return static_cast<uint8_t>(std::max(0.0f, std::min(channel, 1.0f)) * 255 + 0.5f);
+    }
+
+    FrameRasterizer::FrameRasterizer(const size_t width, const size_t height)
+    : kWidth(width),
+      kHeight(height),
+      pixels_(3 * width * height, 0) {}
+
+    void FrameRasterizer::SetPixel(const long x, const long y, const uint8_t r, const uint8_t g, const uint8_t b) {
+        if (x < 0 || y < 0 || x >= static_cast<long>(kWidth) || y >= static_cast<long>(kHeight)) return;
+        size_t index = 3 * (y * kWidth + x);
+        pixels_[index] = r;
+        pixels_[index + 1] = g;
+        pixels_[index + 2] = b;
+    }
+
+    void FrameRasterizer::Clear(const cinder::Colorf& color) {
+        FillRect(0, 0, static_cast<float>(kWidth), static_cast<float>(kHeight), color);
+    }
+
+    void FrameRasterizer::FillRect(const float x1, const float y1, const float x2, const float y2, const cinder::Colorf& color) {
+        //pixels whose centers are inside the rectangle
+        long left = std::max(0L, static_cast<long>(ceil(std::min(x1, x2) - 0.5f)));
+        long right = std::min(static_cast<long>(kWidth), static_cast<long>(ceil(std::max(x1, x2) - 0.5f)));
+        long top = std::max(0L, static_cast<long>(ceil(std::min(y1, y2) - 0.5f)));
+        long bottom = std::min(static_cast<long>(kHeight), static_cast<long>(ceil(std::max(y1, y2) - 0.5f)));
+        uint8_t r = ToByte(color.r);
+        uint8_t g = ToByte(color.g);
+        uint8_t b = ToByte(color.b);
+
+        for (long y = top; y < bottom; ++y) {
+            for (long x = left; x < right; ++x) {
+                size_t index = 3 * (y * kWidth + x);
+                pixels_[index] = r;
+                pixels_[index + 1] = g;
+                pixels_[index + 2] = b;
+            }
+        }
+    }
+
+    void FrameRasterizer::StrokeRect(const float x1, const float y1, const float x2, const float y2, const float line_width,
+                                     const cinder::Colorf& color) {
+        float half = line_width / 2;
+        FillRect(x1 - half, y1 - half, x2 + half, y1 + half, color);
+        FillRect(x1 - half, y2 - half, x2 + half, y2 + half, color);
+        FillRect(x1 - half, y1 + half, x1 + half, y2 - half, color);
+        FillRect(x2 - half, y1 + half, x2 + half, y2 - half, color);
+    }
+
+    void FrameRasterizer::FillCircle(const glm::vec2& center, const float radius, const cinder::Colorf& color) {
+        long top = static_cast<long>(floor(center.y - radius));
+        long bottom = static_cast<long>(ceil(center.y + radius));
+        float radius_squared = radius * radius;
+        uint8_t r = ToByte(color.r);
+        uint8_t g = ToByte(color.g);
+        uint8_t b = ToByte(color.b);
+
+        //one span per row, from where the row's pixel centers enter the circle to where they leave it
+        for (long y = std::max(top, 0L); y <= std::min(bottom, static_cast<long>(kHeight) - 1); ++y) {
+            float dy = y + 0.5f - center.y;
+            float span_squared = radius_squared - dy * dy;
+            if (span_squared < 0) continue;
+            float span = sqrt(span_squared);
+            long left = std::max(0L, static_cast<long>(ceil(center.x - span - 0.5f)));
+            long right = std::min(static_cast<long>(kWidth) - 1, static_cast<long>(floor(center.x + span - 0.5f)));
+            for (long x = left; x <= right; ++x) {
+                size_t index = 3 * (y * kWidth + x);
+                pixels_[index] = r;
+                pixels_[index + 1] = g;
+                pixels_[index + 2] = b;
+            }
+        }
+    }
+
+    void FrameRasterizer::DrawLine(const glm::vec2& start, const glm::vec2& end, const cinder::Colorf& color) {
+        //one pixel per step along the longer axis
+        glm::vec2 diff = end - start;
+        float length = std::max(std::abs(diff.x), std::abs(diff.y));
+        size_t num_steps = static_cast<size_t>(ceil(length));
+        uint8_t r = ToByte(color.r);
+        uint8_t g = ToByte(color.g);
+        uint8_t b = ToByte(color.b);
+
+        for (size_t i = 0; i <= num_steps; ++i) {
+            glm::vec2 point = num_steps == 0 ? start : start + diff * (static_cast<float>(i) / num_steps);
+            SetPixel(static_cast<long>(floor(point.x)), static_cast<long>(floor(point.y)), r, g, b);
+        }
+    }
+
+    void FrameRasterizer::DrawBox(const vector<Particle>& particles, const glm::vec2& top_left, const float width,
+                                  const float border_width, const float piston_x) {
+        if (particles.size() > kDensityThreshold) {
+            size_t field_width = static_cast<size_t>(width);
+            if (!density_field_ || density_field_->GetWidth() != field_width) {
+                density_field_.reset(new DensityField(field_width, field_width));
+            }
+            density_field_->Splat(particles, top_left.x, top_left.x + width, top_left.y, top_left.y + width);
+
+            //copy the field's non empty pixels over the box
+            const vector<uint8_t>& field = density_field_->GetPixels();
+            for (size_t y = 0; y < field_width; ++y) {
+                for (size_t x = 0; x < field_width; ++x) {
+                    const uint8_t* texel = &field[4 * (y * field_width + x)];
+                    if (texel[3] == 0) continue;
+                    SetPixel(static_cast<long>(top_left.x) + static_cast<long>(x), static_cast<long>(top_left.y) + static_cast<long>(y),
+                             texel[0], texel[1], texel[2]);
+                }
+            }
+        } else {
+            for (const Particle& p : particles) {
+                FillCircle(ToVec2(p.pos), p.radius, p.color);
+            }
+        }
+
+        StrokeRect(top_left.x, top_left.y, top_left.x + width, top_left.y + width, border_width, cinder::Colorf(1, 1, 1));
+
+        float inner_right = top_left.x + width - border_width / 2;
+        if (piston_x < inner_right) {
+            FillRect(piston_x, top_left.y, inner_right, top_left.y + width, cinder::Colorf(0.5f, 0.5f, 0.5f));
+        }
+    }
+
+    void FrameRasterizer::DrawHistogram(const vector<float>& bin_frequencies, const vector<float>& expected_frequencies, const glm::vec2& top_left,
+                                        const float width, const float height, const cinder::Colorf& color) {
+        StrokeRect(top_left.x, top_left.y, top_left.x + width, top_left.y + height, 1, color);
+
+        float bar_width = width / bin_frequencies.size();
+        float bar_left = top_left.x;
+        float bottom = top_left.y + height;
+        for (float freq : bin_frequencies) {
+            FillRect(bar_left, bottom - freq * height, bar_left + bar_width, bottom, color);
+            bar_left += bar_width;
+        }
+
+        //fitted frequencies at the center of each bar, connected
+        if (expected_frequencies.empty()) return;
+        float fit_width = width / expected_frequencies.size();
+        float center_x = top_left.x + fit_width / 2;
+        for (size_t i = 1; i < expected_frequencies.size(); ++i) {
+            DrawLine(glm::vec2(center_x, bottom - expected_frequencies[i - 1] * height),
+                     glm::vec2(center_x + fit_width, bottom - expected_frequencies[i] * height), cinder::Colorf(1, 1, 1));
+            center_x += fit_width;
+        }
+    }
+
+    const vector<uint8_t>& FrameRasterizer::GetPixels() const {
+        return pixels_;
+    }
+
+    size_t FrameRasterizer::GetWidth() const {
+        return kWidth;
+    }
+
+    size_t FrameRasterizer::GetHeight() const {
+        return kHeight;
+    }
+}
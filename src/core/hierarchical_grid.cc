@@ -0,0 +1,121 @@
+#include "core/hierarchical_grid.h"
+#include <algorithm>
+#include <cmath>
+
+namespace idealgas {
+    const uint32_t HierarchicalGrid::kNotInserted;
+
+    HierarchicalGrid::HierarchicalGrid(const float x_min, const float x_max, const float y_min, const float y_max)
+    : kXMin(x_min),
+      kXMax(x_max),
+      kYMin(y_min),
+      kYMax(y_max) {}
+
+    size_t HierarchicalGrid::GetLevel(const float radius) {
+        //smallest k with 2^k >= 2 * radius, anything under 1 px across shares level 0
+        size_t level = 0;
+        while (static_cast<float>(1u << level) < 2 * radius && level < 31) {
+            level++;
+        }
+        return level;
+    }
+
+    void HierarchicalGrid::MakeLevel(const size_t level) {
+        Level& new_level = levels_[level];
+        float width = std::max(kXMax - kXMin, 1.0f);
+        float height = std::max(kYMax - kYMin, 1.0f);
+
+        //wider cells only make the 3x3 search cover more, so they're always safe
+        new_level.cell_size = std::max(static_cast<float>(1u << level), std::sqrt(width * height / kMaxCellsPerLevel));
+        new_level.num_cols = static_cast<size_t>(width / new_level.cell_size) + 1;
+        new_level.num_rows = static_cast<size_t>(height / new_level.cell_size) + 1;
+        new_level.cells.resize(new_level.num_cols * new_level.num_rows);
+    }
+
+    size_t HierarchicalGrid::GetCol(const Level& level, const Real x) const {
+        //clamping keeps particles outside the bounds within one cell of everything they can touch
+        Real col = std::floor((x - kXMin) / level.cell_size);
+        return static_cast<size_t>(std::min(std::max<Real>(col, 0), static_cast<Real>(level.num_cols - 1)));
+    }
+
+    size_t HierarchicalGrid::GetRow(const Level& level, const Real y) const {
+        Real row = std::floor((y - kYMin) / level.cell_size);
+        return static_cast<size_t>(std::min(std::max<Real>(row, 0), static_cast<Real>(level.num_rows - 1)));
+    }
+
+    void HierarchicalGrid::Insert(const Particle& p) {
+        size_t level_index = GetLevel(p.radius);
+        if (levels_.size() <= level_index) levels_.resize(level_index + 1);
+        Level& level = levels_[level_index];
+        if (level.cells.empty()) MakeLevel(level_index);
+
+        if (level_of_id_.size() <= p.id) {
+            level_of_id_.resize(p.id + 1, 0);
+            cell_of_id_.resize(p.id + 1, kNotInserted);
+        }
+        Vec2 pos = ToVec2(p.pos);
+        size_t cell = GetRow(level, pos.y) * level.num_cols + GetCol(level, pos.x);
+        level.cells[cell].push_back(p.id);
+        level.num_particles++;
+        level.max_radius = std::max(level.max_radius, p.radius);
+        level_of_id_[p.id] = static_cast<uint32_t>(level_index);
+        cell_of_id_[p.id] = static_cast<uint32_t>(cell);
+    }
+
+    void HierarchicalGrid::Remove(const Particle& p) {
+        if (p.id >= cell_of_id_.size() || cell_of_id_[p.id] == kNotInserted) return;
+        Level& level = levels_[level_of_id_[p.id]];
+        vector<uint32_t>& cell = level.cells[cell_of_id_[p.id]];
+        //order within a cell doesn't matter, so the last id fills the hole
+        *std::find(cell.begin(), cell.end(), p.id) = cell.back();
+        cell.pop_back();
+        level.num_particles--;
+        cell_of_id_[p.id] = kNotInserted;
+    }
+
+    void HierarchicalGrid::Move(const Particle& p) {
+        Level& level = levels_[level_of_id_[p.id]];
+        Vec2 pos = ToVec2(p.pos);
+        size_t cell = GetRow(level, pos.y) * level.num_cols + GetCol(level, pos.x);
+        if (cell == cell_of_id_[p.id]) return;
+
+        vector<uint32_t>& old_cell = level.cells[cell_of_id_[p.id]];
+        *std::find(old_cell.begin(), old_cell.end(), p.id) = old_cell.back();
+        old_cell.pop_back();
+        level.cells[cell].push_back(p.id);
+        cell_of_id_[p.id] = static_cast<uint32_t>(cell);
+    }
+
+    void HierarchicalGrid::GatherCandidates(const Particle& p, vector<uint32_t>& candidate_ids) const {
+        candidate_ids.clear();
+        Vec2 pos = ToVec2(p.pos);
+
+        //cells on p's level and coarser ones are at least as wide as p's radius plus any radius on that level, so
+        //the cells overlapping that distance around p are at most its neighbouring cells
+        for (size_t level_index = GetLevel(p.radius); level_index < levels_.size(); ++level_index) {
+            const Level& level = levels_[level_index];
+            if (level.num_particles == 0) continue;
+
+            Real range = p.radius + level.max_radius;
+            size_t max_col = GetCol(level, pos.x + range);
+            size_t max_row = GetRow(level, pos.y + range);
+            for (size_t y = GetRow(level, pos.y - range); y <= max_row; ++y) {
+                for (size_t x = GetCol(level, pos.x - range); x <= max_col; ++x) {
+                    for (uint32_t id : level.cells[y * level.num_cols + x]) {
+                        if (id != p.id) candidate_ids.push_back(id);
+                    }
+                }
+            }
+        }
+    }
+
+    size_t HierarchicalGrid::GetNumLevels() const {
+        return static_cast<size_t>(std::count_if(levels_.begin(), levels_.end(), [](const Level& level) {
+            return level.num_particles > 0;
+        }));
+    }
+
+    float HierarchicalGrid::GetXMax() const {
+        return kXMax;
+    }
+}
@@ -1,8 +1,17 @@
 #include "core/histogram.h"
+#include <algorithm>
+#include <cmath>
 
 namespace idealgas {
-    Histogram::Histogram(vector<Particle*> particles)
-    : particles_(particles) {
+    Histogram::Histogram(ParticleController& particle_controller, vector<uint32_t> ids, BinningStrategy strategy, size_t num_bins)
+    : particle_controller_(particle_controller),
+      ids_(ids),
+      kBinningStrategy(strategy),
+      kNumBins(std::max<size_t>(num_bins, 1)) {
+        for (size_t i = 0; i < ids_.size(); ++i) {
+            if (ids_[i] >= id_slots_.size()) id_slots_.resize(ids_[i] + 1);
+            id_slots_[ids_[i]] = i;
+        }
         UpdateHistogram();
     }
 
@@ -11,18 +20,59 @@ namespace idealgas {
         SetBinFrequencies();
     }
     
+    void Histogram::AddId(const uint32_t id) {
+        if (id >= id_slots_.size()) id_slots_.resize(id + 1);
+        id_slots_[id] = ids_.size();
+        ids_.push_back(id);
+    }
+    
+    void Histogram::RemoveId(const uint32_t id) {
+        //the last id fills the removed id's slot
+        size_t slot = id_slots_[id];
+        ids_[slot] = ids_.back();
+        id_slots_[ids_[slot]] = slot;
+        ids_.pop_back();
+    }
+    
     void Histogram::SetXValues() {
-        x_values_.clear(); //x values will change for each frame
-        
         //get the current min and max speed
         float min_speed = std::numeric_limits<float>::max();
         float max_speed = 0;
         
-        for (Particle* p : particles_) {
-            if (p->speed < min_speed) min_speed = p->speed;
-            if (p->speed > max_speed) max_speed = p->speed;
+        for (uint32_t id : ids_) {
+            float speed = particle_controller_.GetParticle(id).speed;
+            if (speed < min_speed) min_speed = speed;
+            if (speed > max_speed) max_speed = speed;
+        }
+        
+        if (kBinningStrategy == BinningStrategy::kQuantileSketch) {
+            sketch_.Clear();
+            for (uint32_t id : ids_) {
+                sketch_.Insert(particle_controller_.GetParticle(id).speed);
+            }
         }
         
+        SetXValues(min_speed, max_speed);
+    }
+    
+    void Histogram::SetXValues(const float min_speed, const float max_speed) {
+        x_values_.clear(); //x values will change for each frame
+        
+        switch (kBinningStrategy) {
+            case BinningStrategy::kFixedWidth:
+                SetLinearXValues(min_speed, max_speed);
+                break;
+            case BinningStrategy::kLogScale:
+                SetLogXValues(min_speed, max_speed);
+                break;
+            case BinningStrategy::kQuantileSketch:
+                //bins span the bulk of the distribution, a few outliers can't stretch them
+                SetLinearXValues(sketch_.Quantile(kLowQuantile), sketch_.Quantile(kHighQuantile));
+                break;
+        }
+    }
+    
+    void Histogram::SetLinearXValues(const float min_speed, const float max_speed) {
         //min will be displayed first, so push it in first  
         x_values_.push_back(min_speed);
         
@@ -36,29 +86,70 @@ namespace idealgas {
         x_values_.push_back(max_speed);
     }
     
-    void Histogram::SetBinFrequencies() {
-        bin_frequencies_.clear(); //frequencies will change for each frame
+    void Histogram::SetLogXValues(const float min_speed, const float max_speed) {
+        if (max_speed <= 0) {
+            //every particle is at rest, so there is no scale to take the log of
+            SetLinearXValues(0, 0);
+            return;
+        }
         
+        //each edge is the previous one times a constant ratio, from first_edge up to max speed
+        float first_edge = std::max(min_speed, max_speed * kMinLogFraction);
+        float ratio = pow(max_speed / first_edge, 1.0f / kNumBins);
+        x_values_.push_back(first_edge);
+        for (size_t i = 1; i < kNumBins; ++i) {
+            x_values_.push_back(x_values_[i - 1] * ratio);
+        }
+        x_values_.push_back(max_speed);
+    }
+    
+    void Histogram::SetBinFrequencies() {
         //will store number of particles in each bin, initialized to all 0s
-        vector<float> frequencies(kNumBins,0);
+        vector<size_t> counts(kNumBins, 0);
         
-        for (Particle* p : particles_) {
-            for (size_t i = 0; i < x_values_.size() - 1; ++i) {
-                //x_values_ is ordered, so if current speed is <= the next, it's in the current bin
-                if (p->speed <= x_values_[i + 1]) {
-                    frequencies[i]++;
-                    break; //each particle should only be in 1 bin, so break once it's found
-                }
-            }
+        for (uint32_t id : ids_) {
+            counts[GetBinIndex(particle_controller_.GetParticle(id).speed)]++;
         }
         
-        //# of particles in bin / total # of particles = frequency as %
-        for (float& freq : frequencies) {
-            bin_frequencies_.push_back(freq / particles_.size());
+        SetBinCounts(counts, ids_.size());
+    }
+    
+    void Histogram::SetBinCounts(const vector<size_t>& counts, const size_t num_particles) {
+        bin_frequencies_.clear(); //frequencies will change for each frame
+        
+        //# of particles in bin / total # of particles = frequency as %, every bin is empty if there are no particles
+        for (size_t count : counts) {
+            bin_frequencies_.push_back(num_particles == 0 ? 0 : static_cast<float>(count) / num_particles);
         }
     }
+    
+    size_t Histogram::GetBinIndex(const float speed) const {
+        //x_values_ is ordered, so the bin is the first one whose upper edge is >= speed
+        size_t index = std::lower_bound(x_values_.begin() + 1, x_values_.end(), speed) - (x_values_.begin() + 1);
+        
+        //speeds past the last edge (only possible with quantile or log bins) go in the last bin
+        return std::min(index, kNumBins - 1);
+    }
 
     vector<float>& Histogram::GetXValues() { return x_values_; }
     vector<float>& Histogram::GetBinFrequencies() { return bin_frequencies_; }
-    vector<Particle*>& Histogram::GetParticles() { return particles_; }
-}
\ No newline at end of file
+    vector<uint32_t>& Histogram::GetIds() { return ids_; }
+    BinningStrategy Histogram::GetBinningStrategy() const { return kBinningStrategy; }
+    size_t Histogram::GetNumBins() const { return kNumBins; }
+    QuantileSketch& Histogram::GetSketch() { return sketch_; }
+
+    vector<Histogram> MakeSpeciesHistograms(ParticleController& particle_controller, const vector<size_t>& types,
+                                            BinningStrategy strategy, size_t num_bins) {
+        vector<vector<uint32_t>> ids(types.size());
+        for (const Particle& p : particle_controller.GetParticles()) {
+            size_t species = std::find(types.begin(), types.end(), p.type) - types.begin();
+            if (species < types.size()) ids[species].push_back(p.id);
+        }
+
+        vector<Histogram> histograms;
+        for (const vector<uint32_t>& species_ids : ids) {
+            histograms.push_back(Histogram(particle_controller, species_ids, strategy, num_bins));
+        }
+        return histograms;
+    }
+}
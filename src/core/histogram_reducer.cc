@@ -0,0 +1,159 @@
+#include "core/histogram_reducer.h"
+#include "core/parallel_for.h"
+#include <algorithm>
+#include <limits>
+#include <utility>
+
+namespace idealgas {
+    void HistogramReducer::Reduce(vector<Histogram>& histograms, const vector<Particle>& particles) {
+        SetIdHistograms(histograms);
+        ReduceRanges(histograms, particles);
+        ReduceCounts(histograms, particles);
+    }
+
+    void HistogramReducer::StartSlices(vector<Histogram>& histograms) {
+        SetIdHistograms(histograms);
+        thread_ranges_.assign(1, MakeEmptyRange(histograms.size()));
+        SetBinOffsets(histograms);
+        thread_counts_.assign(1, vector<size_t>(bin_offsets_.back() + histograms.size(), 0));
+    }
+
+    void HistogramReducer::AddRangeSlice(vector<Histogram>& histograms, const vector<Particle>& particles, const size_t begin, const size_t end) {
+        AddToRange(thread_ranges_[0], histograms, particles, begin, std::min(end, particles.size()));
+    }
+
+    void HistogramReducer::FinishRanges(vector<Histogram>& histograms) {
+        CombineRanges(histograms);
+    }
+
+    void HistogramReducer::AddCountSlice(vector<Histogram>& histograms, const vector<Particle>& particles, const size_t begin, const size_t end) {
+        AddToCounts(thread_counts_[0], histograms, particles, begin, std::min(end, particles.size()));
+    }
+
+    void HistogramReducer::FinishCounts(vector<Histogram>& histograms) {
+        CombineCounts(histograms);
+    }
+
+    void HistogramReducer::ReduceRanges(vector<Histogram>& histograms, const vector<Particle>& particles) {
+        size_t num_hists = histograms.size();
+        thread_ranges_.resize(GetNumChunks(particles.size(), kMinParticlesPerThread));
+
+        ParallelFor(particles.size(), kMinParticlesPerThread, [&](size_t begin, size_t end, size_t thread_index) {
+            //each thread fills its own range, so nothing shared is written in the loop
+            SpeedRange range = MakeEmptyRange(num_hists);
+            AddToRange(range, histograms, particles, begin, end);
+            thread_ranges_[thread_index] = std::move(range);
+        });
+
+        CombineRanges(histograms);
+    }
+
+    void HistogramReducer::SetIdHistograms(vector<Histogram>& histograms) {
+        size_t num_hists = histograms.size();
+        id_histograms_.clear();
+        for (size_t h = 0; h < num_hists; ++h) {
+            for (uint32_t id : histograms[h].GetIds()) {
+                if (id >= id_histograms_.size()) id_histograms_.resize(id + 1, num_hists);
+                id_histograms_[id] = h;
+            }
+        }
+    }
+
+    size_t HistogramReducer::GetHistogramIndex(const uint32_t id, const size_t num_hists) const {
+        return id < id_histograms_.size() ? id_histograms_[id] : num_hists;
+    }
+
+    HistogramReducer::SpeedRange HistogramReducer::MakeEmptyRange(const size_t num_hists) const {
+        SpeedRange range;
+        range.min_speeds.assign(num_hists, std::numeric_limits<float>::max());
+        range.max_speeds.assign(num_hists, 0);
+        for (size_t h = 0; h < num_hists; ++h) {
+            range.sketches.push_back(QuantileSketch());
+        }
+        return range;
+    }
+
+    void HistogramReducer::AddToRange(SpeedRange& range, vector<Histogram>& histograms, const vector<Particle>& particles,
+                                      const size_t begin, const size_t end) const {
+        size_t num_hists = histograms.size();
+        for (size_t i = begin; i < end; ++i) {
+            const Particle& p = particles[i];
+            size_t h = GetHistogramIndex(p.id, num_hists);
+            if (h >= num_hists) continue; //particle isn't in any histogram
+
+            range.min_speeds[h] = std::min(range.min_speeds[h], p.speed);
+            range.max_speeds[h] = std::max(range.max_speeds[h], p.speed);
+            if (histograms[h].GetBinningStrategy() == BinningStrategy::kQuantileSketch) {
+                range.sketches[h].Insert(p.speed);
+            }
+        }
+    }
+
+    void HistogramReducer::CombineRanges(vector<Histogram>& histograms) {
+        //combines the threads' ranges and sketches, then places each histogram's edges
+        for (size_t h = 0; h < histograms.size(); ++h) {
+            float min_speed = std::numeric_limits<float>::max();
+            float max_speed = 0;
+            QuantileSketch& sketch = histograms[h].GetSketch();
+            sketch.Clear();
+
+            for (SpeedRange& range : thread_ranges_) {
+                min_speed = std::min(min_speed, range.min_speeds[h]);
+                max_speed = std::max(max_speed, range.max_speeds[h]);
+                sketch.Merge(range.sketches[h]);
+            }
+
+            histograms[h].SetXValues(min_speed, max_speed);
+        }
+    }
+
+    void HistogramReducer::ReduceCounts(vector<Histogram>& histograms, const vector<Particle>& particles) {
+        SetBinOffsets(histograms);
+        thread_counts_.resize(GetNumChunks(particles.size(), kMinParticlesPerThread));
+
+        ParallelFor(particles.size(), kMinParticlesPerThread, [&](size_t begin, size_t end, size_t thread_index) {
+            vector<size_t> counts(bin_offsets_.back() + histograms.size(), 0);
+            AddToCounts(counts, histograms, particles, begin, end);
+            thread_counts_[thread_index] = std::move(counts);
+        });
+
+        CombineCounts(histograms);
+    }
+
+    void HistogramReducer::SetBinOffsets(const vector<Histogram>& histograms) {
+        bin_offsets_.assign(histograms.size() + 1, 0);
+        for (size_t h = 0; h < histograms.size(); ++h) {
+            bin_offsets_[h + 1] = bin_offsets_[h] + histograms[h].GetNumBins();
+        }
+    }
+
+    void HistogramReducer::AddToCounts(vector<size_t>& counts, vector<Histogram>& histograms, const vector<Particle>& particles,
+                                       const size_t begin, const size_t end) const {
+        size_t num_hists = histograms.size();
+        for (size_t i = begin; i < end; ++i) {
+            const Particle& p = particles[i];
+            size_t h = GetHistogramIndex(p.id, num_hists);
+            if (h >= num_hists) continue; //particle isn't in any histogram
+
+            counts[bin_offsets_[h] + histograms[h].GetBinIndex(p.speed)]++;
+            counts[bin_offsets_[num_hists] + h]++;
+        }
+    }
+
+    void HistogramReducer::CombineCounts(vector<Histogram>& histograms) {
+        size_t num_hists = histograms.size();
+        for (size_t h = 0; h < num_hists; ++h) {
+            vector<size_t> counts(histograms[h].GetNumBins(), 0);
+            size_t num_particles = 0;
+
+            for (vector<size_t>& thread_counts : thread_counts_) {
+                for (size_t bin = 0; bin < counts.size(); ++bin) {
+                    counts[bin] += thread_counts[bin_offsets_[h] + bin];
+                }
+                num_particles += thread_counts[bin_offsets_[num_hists] + h];
+            }
+
+            histograms[h].SetBinCounts(counts, num_particles);
+        }
+    }
+}
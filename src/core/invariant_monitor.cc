@@ -0,0 +1,66 @@
+#include "core/invariant_monitor.h"
+#include <algorithm>
+#include <cmath>
+
+namespace idealgas {
+    InvariantViolation::InvariantViolation(const std::string& message) : std::runtime_error(message) {}
+
+    InvariantMonitor::InvariantMonitor(const float energy_tolerance, const float momentum_tolerance, const InvariantPolicy policy)
+    : kEnergyTolerance(energy_tolerance),
+      kMomentumTolerance(momentum_tolerance),
+      kPolicy(policy) {}
+
+    void InvariantMonitor::BeginStep() {
+        energy_change_ = 0;
+        momentum_change_ = 0;
+        energy_before_ = 0;
+        momentum_before_ = 0;
+    }
+
+    void InvariantMonitor::RecordCollision(const Particle& p1_before, const Particle& p2_before,
+                                           const Particle& p1_after, const Particle& p2_after) {
+        double e_before = 0.5 * p1_before.mass * glm::dot(p1_before.vel, p1_before.vel) +
+                          0.5 * p2_before.mass * glm::dot(p2_before.vel, p2_before.vel);
+        double e_after = 0.5 * p1_after.mass * glm::dot(p1_after.vel, p1_after.vel) +
+                         0.5 * p2_after.mass * glm::dot(p2_after.vel, p2_after.vel);
+
+        //momentum is a vector, so its change is measured as the length of the difference
+        double dp_x = p1_after.mass * p1_after.vel.x + p2_after.mass * p2_after.vel.x -
+                      (p1_before.mass * p1_before.vel.x + p2_before.mass * p2_before.vel.x);
+        double dp_y = p1_after.mass * p1_after.vel.y + p2_after.mass * p2_after.vel.y -
+                      (p1_before.mass * p1_before.vel.y + p2_before.mass * p2_before.vel.y);
+
+        //scale for momentum: sum of the magnitudes involved, so head-on collisions with zero total aren't divided by 0
+        double p_before = p1_before.mass * glm::length(p1_before.vel) + p2_before.mass * glm::length(p2_before.vel);
+
+        energy_change_ += e_after - e_before;
+        energy_before_ += e_before;
+        momentum_change_ += sqrt(dp_x * dp_x + dp_y * dp_y);
+        momentum_before_ += p_before;
+        num_collisions_++;
+    }
+
+    void InvariantMonitor::EndStep() {
+        num_steps_++;
+        energy_drift_ = energy_before_ > 0 ? static_cast<float>(std::abs(energy_change_) / energy_before_) : 0;
+        momentum_drift_ = momentum_before_ > 0 ? static_cast<float>(momentum_change_ / momentum_before_) : 0;
+        max_energy_drift_ = std::max(max_energy_drift_, energy_drift_);
+        max_momentum_drift_ = std::max(max_momentum_drift_, momentum_drift_);
+
+        if (energy_drift_ <= kEnergyTolerance && momentum_drift_ <= kMomentumTolerance) return;
+
+        num_violations_++;
+        if (kPolicy == InvariantPolicy::kThrow) {
+            throw InvariantViolation("collisions in step " + std::to_string(num_steps_) +
+                                     " changed energy by " + std::to_string(energy_drift_) +
+                                     " and momentum by " + std::to_string(momentum_drift_) + " (relative)");
+        }
+    }
+
+    float InvariantMonitor::GetEnergyDrift() const { return energy_drift_; }
+    float InvariantMonitor::GetMomentumDrift() const { return momentum_drift_; }
+    float InvariantMonitor::GetMaxEnergyDrift() const { return max_energy_drift_; }
+    float InvariantMonitor::GetMaxMomentumDrift() const { return max_momentum_drift_; }
+    size_t InvariantMonitor::GetNumViolations() const { return num_violations_; }
+    size_t InvariantMonitor::GetNumCollisions() const { return num_collisions_; }
+}
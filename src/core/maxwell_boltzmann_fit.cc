@@ -0,0 +1,101 @@
+#include "core/maxwell_boltzmann_fit.h"
+#include <algorithm>
+#include <cmath>
+
+namespace idealgas {
+    MaxwellBoltzmannFit::MaxwellBoltzmannFit(const float mass, const float ks_critical_value, const size_t num_stable_updates)
+    : kMass(mass),
+      kKsCriticalValue(ks_critical_value),
+      kNumStableUpdates(num_stable_updates) {
+        last_fit_.temperature = 0;
+        last_fit_.chi_square = 0;
+        last_fit_.ks_statistic = 1;
+    }
+
+    FitResult MaxwellBoltzmannFit::Update(Histogram& hist) {
+        size_t num_particles = hist.GetIds().size();
+        last_fit_ = Fit(hist.GetXValues(), hist.GetBinFrequencies(), num_particles);
+
+        //KS test: the fit is accepted when sqrt(n) * D is below the critical value
+        if (num_particles > 0 && sqrt(static_cast<float>(num_particles)) * last_fit_.ks_statistic < kKsCriticalValue) {
+            num_passing_updates_++;
+        } else {
+            num_passing_updates_ = 0;
+        }
+
+        return last_fit_;
+    }
+
+    FitResult MaxwellBoltzmannFit::Fit(const vector<float>& x_values, const vector<float>& bin_frequencies, const size_t num_particles) const {
+        FitResult result;
+        result.temperature = 0;
+        result.chi_square = 0;
+        result.ks_statistic = 1; //worst possible value, used when there is nothing to fit
+        result.expected_frequencies.assign(bin_frequencies.size(), 0);
+
+        if (num_particles == 0 || bin_frequencies.empty() || x_values.size() != bin_frequencies.size() + 1) {
+            return result;
+        }
+
+        //mean squared speed from the bins: a particle uniform in [a, b] has E[v^2] = mid^2 + (b - a)^2 / 12
+        float mean_squared_speed = 0;
+        for (size_t i = 0; i < bin_frequencies.size(); ++i) {
+            float width = x_values[i + 1] - x_values[i];
+            float mid = (x_values[i] + x_values[i + 1]) / 2;
+            mean_squared_speed += bin_frequencies[i] * (mid * mid + width * width / 12);
+        }
+
+        //maximum likelihood estimate for a 2D Maxwell-Boltzmann distribution: kT = m<v^2> / 2
+        result.temperature = kMass * mean_squared_speed / 2;
+        if (result.temperature <= 0) {
+            return result;
+        }
+
+        float observed_cumulative = 0;
+        float expected_cumulative = 0;
+        //nothing is observed below the slowest particle, so the first gap is the expected mass below it
+        result.ks_statistic = CumulativeProbability(x_values[0], kMass, result.temperature);
+
+        for (size_t i = 0; i < bin_frequencies.size(); ++i) {
+            //tails below the first edge and above the last edge are folded into the outer bins
+            bool is_last_bin = i == bin_frequencies.size() - 1;
+            float upper_cumulative = is_last_bin ? 1 : CumulativeProbability(x_values[i + 1], kMass, result.temperature);
+            float expected = upper_cumulative - expected_cumulative;
+            result.expected_frequencies[i] = expected;
+
+            if (expected > 0) {
+                float diff = (bin_frequencies[i] - expected) * num_particles;
+                result.chi_square += diff * diff / (expected * num_particles);
+            }
+
+            observed_cumulative += bin_frequencies[i];
+            expected_cumulative = upper_cumulative;
+
+            //compare the cumulative distributions at the top edge of each bin
+            float edge_cumulative = CumulativeProbability(x_values[i + 1], kMass, result.temperature);
+            result.ks_statistic = std::max(result.ks_statistic, std::abs(observed_cumulative - edge_cumulative));
+        }
+
+        return result;
+    }
+
+    bool MaxwellBoltzmannFit::IsEquilibrated() const {
+        return num_passing_updates_ >= kNumStableUpdates;
+    }
+
+    bool MaxwellBoltzmannFit::UpdateAll(vector<MaxwellBoltzmannFit>& fits, vector<Histogram>& histograms) {
+        bool is_equilibrated = true;
+        for (size_t i = 0; i < fits.size() && i < histograms.size(); ++i) {
+            fits[i].Update(histograms[i]);
+            is_equilibrated = is_equilibrated && fits[i].IsEquilibrated();
+        }
+        return is_equilibrated;
+    }
+
+    float MaxwellBoltzmannFit::CumulativeProbability(const float speed, const float mass, const float temperature) {
+        return 1 - exp(-mass * speed * speed / (2 * temperature));
+    }
+
+    float MaxwellBoltzmannFit::GetMass() const { return kMass; }
+    FitResult& MaxwellBoltzmannFit::GetLastFit() { return last_fit_; }
+}
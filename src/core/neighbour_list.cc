@@ -0,0 +1,106 @@
+#include "core/neighbour_list.h"
+#include "core/parallel_for.h"
+#include <algorithm>
+
+namespace idealgas {
+    NeighbourList::NeighbourList(const float skin) : kSkin(skin) {}
+
+    void NeighbourList::Build(const vector<Particle>& particles, const size_t num_ids, const float max_radius) {
+        size_t num = particles.size();
+
+        vector<Vec2> positions(num);
+        build_positions_.assign(num_ids, Vec2(0, 0));
+        Vec2 min_pos(0, 0);
+        Vec2 max_pos(0, 0);
+        Real max_speed = 0;
+        for (size_t i = 0; i < num; ++i) {
+            max_speed = std::max<Real>(max_speed, glm::length(particles[i].vel));
+            positions[i] = ToVec2(particles[i].pos);
+            build_positions_[particles[i].id] = positions[i];
+            min_pos = i == 0 ? positions[i] : Vec2(std::min(min_pos.x, positions[i].x), std::min(min_pos.y, positions[i].y));
+            max_pos = i == 0 ? positions[i] : Vec2(std::max(max_pos.x, positions[i].x), std::max(max_pos.y, positions[i].y));
+        }
+
+        //a skin under 2 steps' travel would have particles moving too far within a step or two of every build
+        build_skin_ = std::max(kSkin, static_cast<float>(4 * max_speed));
+        Real range = 2 * max_radius + build_skin_;
+
+        //cells at least range wide put every neighbour in the 3x3 cells around a particle's cell, and cells get wider
+        //while there'd be more than a few per particle (e.g. a particle far away after leaving through an open wall)
+        Real width = max_pos.x - min_pos.x;
+        Real height = max_pos.y - min_pos.y;
+        Real cell_size = std::max<Real>(range, 1);
+        while ((width / cell_size + 1) * (height / cell_size + 1) > 4 * static_cast<Real>(num) + 16) {
+            cell_size *= 2;
+        }
+        size_t num_cols = static_cast<size_t>(width / cell_size) + 1;
+        size_t num_rows = static_cast<size_t>(height / cell_size) + 1;
+
+        //counting sort of particle indices by cell, so each cell's particles are contiguous
+        vector<uint32_t> cells(num);
+        vector<uint32_t> cell_starts(num_cols * num_rows + 1, 0);
+        for (size_t i = 0; i < num; ++i) {
+            size_t col = std::min(static_cast<size_t>((positions[i].x - min_pos.x) / cell_size), num_cols - 1);
+            size_t row = std::min(static_cast<size_t>((positions[i].y - min_pos.y) / cell_size), num_rows - 1);
+            cells[i] = static_cast<uint32_t>(row * num_cols + col);
+            cell_starts[cells[i] + 1]++;
+        }
+        for (size_t cell = 0; cell < num_cols * num_rows; ++cell) {
+            cell_starts[cell + 1] += cell_starts[cell];
+        }
+        vector<uint32_t> by_cell(num);
+        vector<uint32_t> next_in_cell(cell_starts.begin(), cell_starts.end() - 1);
+        for (size_t i = 0; i < num; ++i) {
+            by_cell[next_in_cell[cells[i]]++] = static_cast<uint32_t>(i);
+        }
+
+        //two passes over the same search: the first counts each row's length, the second fills the rows, which
+        //don't overlap, so both passes split particles between threads without locking
+        Real range_squared = range * range;
+        auto search = [&](const size_t begin, const size_t end, const bool is_counting) {
+            for (size_t i = begin; i < end; ++i) {
+                uint32_t id = particles[i].id;
+                uint32_t next = is_counting ? 0 : offsets_[id];
+                size_t col = cells[i] % num_cols;
+                size_t row = cells[i] / num_cols;
+                for (size_t y = row > 0 ? row - 1 : 0; y <= std::min(row + 1, num_rows - 1); ++y) {
+                    for (size_t x = col > 0 ? col - 1 : 0; x <= std::min(col + 1, num_cols - 1); ++x) {
+                        size_t cell = y * num_cols + x;
+                        for (uint32_t k = cell_starts[cell]; k < cell_starts[cell + 1]; ++k) {
+                            uint32_t j = by_cell[k];
+                            Vec2 offset = positions[j] - positions[i];
+                            if (j == i || glm::dot(offset, offset) > range_squared) continue;
+                            if (!is_counting) neighbour_ids_[next] = particles[j].id;
+                            next++;
+                        }
+                    }
+                }
+                if (is_counting) offsets_[id + 1] = next;
+            }
+        };
+
+        offsets_.assign(num_ids + 1, 0);
+        ParallelFor(num, kMinPerThread, [&](size_t begin, size_t end, size_t) { search(begin, end, true); });
+        for (size_t id = 0; id < num_ids; ++id) {
+            offsets_[id + 1] += offsets_[id];
+        }
+        neighbour_ids_.resize(offsets_[num_ids]);
+        ParallelFor(num, kMinPerThread, [&](size_t begin, size_t end, size_t) { search(begin, end, false); });
+
+        is_valid_ = true;
+        num_builds_++;
+    }
+
+    bool NeighbourList::HasMovedTooFar(const Particle& p) const {
+        if (!is_valid_ || p.id >= build_positions_.size()) return true;
+        Vec2 displacement = ToVec2(p.pos) - build_positions_[p.id];
+        return 4 * glm::dot(displacement, displacement) > static_cast<Real>(build_skin_) * build_skin_;
+    }
+
+    void NeighbourList::Invalidate() { is_valid_ = false; }
+    bool NeighbourList::IsValid() const { return is_valid_; }
+    const vector<uint32_t>& NeighbourList::GetOffsets() const { return offsets_; }
+    const vector<uint32_t>& NeighbourList::GetNeighbourIds() const { return neighbour_ids_; }
+    float NeighbourList::GetSkin() const { return build_skin_; }
+    size_t NeighbourList::GetNumBuilds() const { return num_builds_; }
+}
@@ -0,0 +1,36 @@
+#include "core/parallel_for.h"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+namespace idealgas {
+    void ParallelFor(const size_t num_items, const size_t min_chunk_size,
+                     const std::function<void(size_t begin, size_t end, size_t thread_index)>& func) {
+        size_t num_chunks = GetNumChunks(num_items, min_chunk_size);
+        if (num_chunks <= 1) {
+            func(0, num_items, 0);
+            return;
+        }
+
+        //the calling thread takes the first chunk, every other chunk gets its own thread
+        size_t chunk_size = (num_items + num_chunks - 1) / num_chunks;
+        std::vector<std::thread> threads;
+        for (size_t i = 1; i < num_chunks; ++i) {
+            size_t begin = std::min(i * chunk_size, num_items);
+            size_t end = std::min(begin + chunk_size, num_items);
+            threads.push_back(std::thread(func, begin, end, i));
+        }
+
+        func(0, std::min(chunk_size, num_items), 0);
+
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+    }
+
+    size_t GetNumChunks(const size_t num_items, const size_t min_chunk_size) {
+        size_t max_threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+        size_t max_chunks = num_items / std::max<size_t>(min_chunk_size, 1);
+        return std::max<size_t>(std::min(max_threads, max_chunks), 1);
+    }
+}
@@ -1,114 +1,411 @@
 #include "core/particle_controller.h"
+#include "core/collision_kernel.h"
+#include "core/spatial_sort.h"
+#include <algorithm>
 #include <random>
+#include <stdexcept>
+#include <string>
 
 namespace idealgas {
-    ParticleController::ParticleController(const size_t box_width, const glm::vec2& top_left, const float border_width)
+    ParticleController::ParticleController(const size_t box_width, const glm::vec2& top_left, const float border_width,
+                                           const PlacementStrategy placement)
             : kXMin(top_left.x + border_width),
-              kXMax(top_left.x + box_width - border_width),
+              x_max_(top_left.x + box_width - border_width),
               kYMin(top_left.y + border_width),
               kYMax(top_left.y + box_width - border_width) {
         srand(static_cast<unsigned>(time(nullptr)));
-        SetParticles(kType1, kNumP1, kP1Mass, kP1Radius, kP1Color);
-        SetParticles(kType2, kNumP2, kP2Mass, kP2Radius, kP2Color);
-        SetParticles(kType3, kNumP3, kP3Mass, kP3Radius, kP3Color);
+        if (placement == PlacementStrategy::kUniformRandom) {
+            SetParticles(kType1, kNumP1, kP1Mass, kP1Radius, kP1Color);
+            SetParticles(kType2, kNumP2, kP2Mass, kP2Radius, kP2Color);
+            SetParticles(kType3, kNumP3, kP3Mass, kP3Radius, kP3Color);
+        } else {
+            PlaceParticles(placement);
+        }
     }
 
-    ParticleController::ParticleController(vector<Particle>& particles, const float x_min, const float x_max, const float y_min, const float y_max)
-            : particles_(particles),
-              kXMin(x_min),
-              kXMax(x_max),
+    ParticleController::ParticleController(const vector<Particle>& particles, const float x_min, const float x_max, const float y_min, const float y_max)
+            : kXMin(x_min),
+              x_max_(x_max),
               kYMin(y_min),
               kYMax(y_max) {
-        for (Particle& p : particles_) {
-            pos_particle_map_.insert(std::make_pair(glm::length(p.pos), &p));
+        for (Particle p : particles) {
+            InsertParticle(p);
         }
     }
 
     void ParticleController::SetParticles(const size_t type, const size_t num, const float mass, const float radius, const cinder::Colorf color) {
         for (size_t i = 0; i < num; ++i) {
             /* Generate random initial pos. based on box width and vel. and add each type of particle to particles_ */
-            float rand_x_pos = (((kXMax - radius) - (kXMin + radius)) * (static_cast<float>(rand()) / RAND_MAX)) + kXMin + radius;
+            float rand_x_pos = (((x_max_ - radius) - (kXMin + radius)) * (static_cast<float>(rand()) / RAND_MAX)) + kXMin + radius;
             float rand_y_pos = (((kYMax - radius) - (kYMin + radius)) * (static_cast<float>(rand()) / RAND_MAX)) + kYMin + radius;
             float rand_x_vel = ((static_cast<float>(rand()) / RAND_MAX) * (kMaxInitialVel.x - kMinInitialVel.x)) + kMinInitialVel.x;
             float rand_y_vel = ((static_cast<float>(rand()) / RAND_MAX) * (kMaxInitialVel.y - kMinInitialVel.y)) + kMinInitialVel.y;
             glm::vec2 initial_pos = glm::vec2(rand_x_pos, rand_y_pos);
             glm::vec2 initial_vel = glm::vec2(rand_x_vel, rand_y_vel);
             Particle p(type, initial_pos, initial_vel, mass, radius, color);
-            particles_.push_back(p);
-            pos_particle_map_.insert(std::make_pair(glm::length(p.pos), &p));
+            InsertParticle(p);
+        }
+    }
+
+    void ParticleController::PlaceParticles(const PlacementStrategy placement) {
+        ParticlePlacer placer(kXMin, x_max_, kYMin, kYMax, static_cast<uint32_t>(rand()));
+        vector<glm::vec2> positions = placer.Place(placement, kNumP1 + kNumP2 + kNumP3, std::max(kP1Radius, std::max(kP2Radius, kP3Radius)));
+
+        //positions come spread over the box, so handing them out in order still mixes the types
+        size_t next = 0;
+        const size_t kTypes[] = {kType1, kType2, kType3};
+        const size_t kNums[] = {kNumP1, kNumP2, kNumP3};
+        const float kMasses[] = {kP1Mass, kP2Mass, kP3Mass};
+        const float kRadii[] = {kP1Radius, kP2Radius, kP3Radius};
+        const cinder::Colorf kColors[] = {kP1Color, kP2Color, kP3Color};
+        for (size_t t = 0; t < 3; ++t) {
+            for (size_t i = 0; i < kNums[t]; ++i) {
+                float rand_x_vel = ((static_cast<float>(rand()) / RAND_MAX) * (kMaxInitialVel.x - kMinInitialVel.x)) + kMinInitialVel.x;
+                float rand_y_vel = ((static_cast<float>(rand()) / RAND_MAX) * (kMaxInitialVel.y - kMinInitialVel.y)) + kMinInitialVel.y;
+                Particle p(kTypes[t], positions[next++], glm::vec2(rand_x_vel, rand_y_vel), kMasses[t], kRadii[t], kColors[t]);
+                InsertParticle(p);
+            }
+        }
+    }
+
+    void ParticleController::InsertParticle(Particle& p) {
+        if (free_ids_.empty()) {
+            //no ids to reuse, so the new particle's id is the next slot of the indirection table
+            p.id = static_cast<uint32_t>(id_to_index_.size());
+            id_to_index_.push_back(static_cast<uint32_t>(particles_.size()));
+        } else {
+            p.id = free_ids_.back();
+            free_ids_.pop_back();
+            id_to_index_[p.id] = static_cast<uint32_t>(particles_.size());
+        }
+        particles_.push_back(p);
+        if (neighbour_list_) {
+            neighbour_list_->Invalidate();
+        } else if (hierarchical_grid_) {
+            hierarchical_grid_->Insert(p);
+        } else {
+            pos_particle_map_.insert(std::make_pair(glm::length(ToVec2(p.pos)), p.id));
+        }
+        max_radius_ = std::max(max_radius_, p.radius);
+    }
+
+    uint32_t ParticleController::AddParticle(Particle p) {
+        InsertParticle(p);
+        for (ParticleObserver* observer : observers_) {
+            observer->OnParticleAdded(p);
         }
+        return p.id;
+    }
+
+    void ParticleController::RemoveParticle(const uint32_t id) {
+        size_t index = id_to_index_[id];
+        for (ParticleObserver* observer : observers_) {
+            observer->OnParticleRemoved(particles_[index]);
+        }
+        if (neighbour_list_) {
+            neighbour_list_->Invalidate();
+        } else if (hierarchical_grid_) {
+            hierarchical_grid_->Remove(particles_[index]);
+        } else {
+            ErasePosEntry(particles_[index]);
+        }
+        
+        //swap-remove: the last particle fills the hole, so only its indirection entry changes
+        particles_[index] = particles_.back();
+        id_to_index_[particles_[index].id] = static_cast<uint32_t>(index);
+        particles_.pop_back();
+        
+        id_to_index_[id] = kInvalidIndex;
+        free_ids_.push_back(id);
+    }
+
+    vector<uint32_t> ParticleController::RemoveParticlesIf(const std::function<bool(const Particle&)>& should_remove) {
+        vector<uint32_t> removed_ids;
+        
+        //walks backwards so the particle swapped into a removed slot has already been checked
+        for (size_t i = particles_.size(); i > 0; --i) {
+            if (should_remove(particles_[i - 1])) {
+                removed_ids.push_back(particles_[i - 1].id);
+                RemoveParticle(particles_[i - 1].id);
+            }
+        }
+        return removed_ids;
+    }
+
+    void ParticleController::ErasePosEntry(const Particle& p) {
+        auto range = pos_particle_map_.equal_range(glm::length(ToVec2(p.pos)));
+        for (auto it = range.first; it != range.second; ++it) {
+            if (it->second == p.id) {
+                pos_particle_map_.erase(it);
+                return;
+            }
+        }
+    }
+
+    bool ParticleController::HasParticle(const uint32_t id) const {
+        return id < id_to_index_.size() && id_to_index_[id] != kInvalidIndex;
+    }
+
+    void ParticleController::AddObserver(ParticleObserver* observer) {
+        observers_.push_back(observer);
+    }
+
+    void ParticleController::RemoveObserver(ParticleObserver* observer) {
+        observers_.erase(std::remove(observers_.begin(), observers_.end(), observer), observers_.end());
     }
 
     void ParticleController::UpdateParticles() {
-        for (Particle& p : particles_) {
+        if (!BeginStep()) return; //paused
+        for (size_t i = 0; i < particles_.size(); ) {
+            i = UpdateParticleRange(i, particles_.size());
+        }
+        EndStep();
+        if (IsReorderDue()) ReorderParticles();
+    }
+    
+    bool ParticleController::BeginStep() {
+        if (!ApplyCommands()) return false;
+        
+        num_scattered_ = 0;
+        kinetic_energy_ = 0;
+        
+        //temperature ramps and thermostats are applied in the same pass as the update, rather than in a separate pass
+        step_vel_scale_ = ramp_steps_remaining_ > 0 ? vel_scale_per_step_ : 1;
+        if (ramp_steps_remaining_ > 0) ramp_steps_remaining_--;
+        
+        is_thermostat_acting_on_particles_ = false;
+        if (thermostat_) {
+            step_vel_scale_ *= thermostat_->BeginStep(temperature_);
+            is_thermostat_acting_on_particles_ = thermostat_->ActsOnParticles();
+        }
+        if (invariant_monitor_) invariant_monitor_->BeginStep();
+        
+        if (wall_steps_remaining_ > 0) {
+            x_max_ += wall_vel_;
+            wall_steps_remaining_--;
+        } else {
+            wall_vel_ = 0;
+        }
+
+        return true;
+    }
+
+    bool ParticleController::IsRebuildDue() const {
+        //particles past the grid's bounds would all be crowded into its last column of cells
+        return (neighbour_list_ && !neighbour_list_->IsValid()) ||
+               (hierarchical_grid_ && x_max_ > hierarchical_grid_->GetXMax());
+    }
+
+    void ParticleController::RebuildCandidateSearch() {
+        if (neighbour_list_) {
+            neighbour_list_->Build(particles_, id_to_index_.size(), max_radius_);
+        } else if (hierarchical_grid_) {
+            //rebuilt once to cover where the piston is going, plus a cell for rounding in the steps it takes to get there
+            BuildHierarchicalGrid(std::max(x_max_ + wall_vel_ * wall_steps_remaining_, x_max_) + GetCellSize());
+        }
+    }
+    
+    size_t ParticleController::UpdateParticleRange(const size_t begin, const size_t end) {
+        if (IsRebuildDue()) RebuildCandidateSearch();
+        for (size_t i = begin; i < std::min(end, particles_.size()); ++i) {
+            Particle& p = particles_[i];
+            p.vel *= step_vel_scale_;
+            if (is_thermostat_acting_on_particles_) thermostat_->Apply(p);
             CheckWallCollision(p);
-            CheckParticleCollision(p);
-            pos_particle_map_.erase(glm::length(p.pos));
-            p.pos += p.vel;
-            pos_particle_map_.insert(std::make_pair(glm::length(p.pos), &p));
+            if (!ghosts_.empty()) CheckGhostCollision(p);
+            bool has_moved_too_far = false;
+            if (neighbour_list_) {
+                CheckNeighbourCollision(p);
+                Advance(p.pos, p.vel);
+                has_moved_too_far = neighbour_list_->HasMovedTooFar(p);
+            } else if (hierarchical_grid_) {
+                CheckGridCollision(p);
+                Advance(p.pos, p.vel);
+                hierarchical_grid_->Move(p);
+            } else {
+                CheckParticleCollision(p);
+                ErasePosEntry(p);
+                Advance(p.pos, p.vel);
+                pos_particle_map_.insert(std::make_pair(glm::length(ToVec2(p.pos)), p.id));
+            }
             p.speed = glm::length(p.vel);
+            kinetic_energy_ += 0.5f * p.mass * p.speed * p.speed;
+            
+            //locality only matters to the reorder check, so it isn't measured while that's disabled
+            if (reorder_threshold_ < 1 && i > 0 && !AreCellsAdjacent(ToVec2(particles_[i - 1].pos), ToVec2(p.pos))) {
+                num_scattered_++;
+            }
+
+            //rebuilding as soon as one particle has moved too far, rather than at the end of the step, means the
+            //particles still to be updated this step never check against a position the list doesn't cover; the
+            //range stops here so the caller can choose when the rebuild runs
+            if (has_moved_too_far) {
+                neighbour_list_->Invalidate();
+                return i + 1;
+            }
         }
+        return std::min(end, particles_.size());
+    }
+    
+    void ParticleController::EndStep() {
+        scattered_fraction_ = particles_.empty() ? 0 : static_cast<float>(num_scattered_) / particles_.size();
+        temperature_ = particles_.empty() ? 0 : kinetic_energy_ / particles_.size();
+        steps_since_reorder_++;
+        if (invariant_monitor_) invariant_monitor_->EndStep();
+    }
+
+    bool ParticleController::IsReorderDue() const {
+        return (reorder_interval_ > 0 && steps_since_reorder_ >= reorder_interval_) || scattered_fraction_ > reorder_threshold_;
+    }
+    
+    void ParticleController::EnqueueCommand(const SimulationCommand& command) {
+        command_queue_.Push(command);
+    }
+    
+    bool ParticleController::ApplyCommands() {
+        for (const SimulationCommand& command : command_queue_.Drain()) {
+            size_t num_steps = std::max<size_t>(command.num_steps, 1);
+            switch (command.type) {
+                case CommandType::kTemperatureRamp:
+                    //temperature is proportional to speed squared, so speeds change by sqrt(factor) overall
+                    vel_scale_per_step_ = pow(command.value, 1.0f / (2 * num_steps));
+                    ramp_steps_remaining_ = num_steps;
+                    break;
+                case CommandType::kMoveWall:
+                    //walls can't move past each other
+                    wall_vel_ = (std::max(command.value, kXMin) - x_max_) / num_steps;
+                    wall_steps_remaining_ = num_steps;
+                    break;
+                case CommandType::kPause:
+                    is_paused_ = true;
+                    break;
+                case CommandType::kResume:
+                    is_paused_ = false;
+                    num_pending_single_steps_ = 0;
+                    break;
+                case CommandType::kSingleStep:
+                    num_pending_single_steps_++;
+                    break;
+            }
+        }
+        
+        if (!is_paused_) return true;
+        if (num_pending_single_steps_ == 0) return false;
+        num_pending_single_steps_--;
+        return true;
+    }
+    
+    void ParticleController::ReorderParticles() {
+        //cells are measured from the top left corner of the box so every cell coordinate is non-negative
+        PermuteParticles(GetMortonOrder(particles_, glm::vec2(kXMin, kYMin), GetCellSize()));
+        steps_since_reorder_ = 0;
+    }
+    
+    bool ParticleController::AreCellsAdjacent(const Vec2& pos1, const Vec2& pos2) const {
+        //same cells as ReorderParticles sorts by
+        float cell_size = GetCellSize();
+        return std::abs(floor((pos1.x - kXMin) / cell_size) - floor((pos2.x - kXMin) / cell_size)) <= 1 &&
+               std::abs(floor((pos1.y - kYMin) / cell_size) - floor((pos2.y - kYMin) / cell_size)) <= 1;
     }
 
     void ParticleController::CheckWallCollision(Particle& p) {
-        //particle is moving towards left or right wall and touching it
-        if (p.pos.x <= kXMin + p.radius && p.vel.x < 0 || p.pos.x >= kXMax - p.radius && p.vel.x > 0) {
-            p.vel.x *= -1;
+        Vec2 pos = ToVec2(p.pos);
+        //particle is moving towards left wall and touching it (open walls let particles through)
+        if (!is_left_wall_open_ && pos.x <= kXMin + p.radius && p.vel.x < 0) {
+            ReflectOffWall(p, glm::vec2(1, 0));
+            //particle is moving towards right wall (relative to the wall, which may be moving) and touching it
+        } else if (!is_right_wall_open_ && pos.x >= x_max_ - p.radius && p.vel.x > wall_vel_) {
+            //bounce off a moving wall happens in the wall's frame
+            p.vel.x -= wall_vel_;
+            ReflectOffWall(p, glm::vec2(-1, 0));
+            p.vel.x += wall_vel_;
             //particle is moving towards top or bottom wall and touching it
-        } else if (p.pos.y <= kYMin + p.radius && p.vel.y < 0 || p.pos.y >= kYMax - p.radius && p.vel.y > 0) {
+        } else if (pos.y <= kYMin + p.radius && p.vel.y < 0) {
+            ReflectOffWall(p, glm::vec2(0, 1));
+        } else if (pos.y >= kYMax - p.radius && p.vel.y > 0) {
+            ReflectOffWall(p, glm::vec2(0, -1));
+        }
+    }
+    
+    void ParticleController::ReflectOffWall(Particle& p, const glm::vec2& normal) {
+        //thermal walls pick the outgoing velocity, otherwise the bounce is elastic (normal component flips)
+        if (thermostat_ && thermostat_->ReflectOffWall(p, normal)) return;
+        
+        if (normal.x != 0) {
+            p.vel.x *= -1;
+        } else {
             p.vel.y *= -1;
         }
     }
 
     void ParticleController::CheckParticleCollision(Particle& p) {
-        //differences in velocity and position of each particle
-        glm::vec2 vel_diff;
-        glm::vec2 pos_diff;
+        Vec2 pos = ToVec2(p.pos);
 
         //iterates through range of keys in map with positions where a collision is possible
         //lower bound: top-left of particle, upper bound: bottom-right. (since 0,0 position is at the top left)
-        for (auto it = pos_particle_map_.lower_bound(sqrt(pow(p.pos.x - 2 * p.radius, 2) + pow(p.pos.y - 2 * p.radius, 2)));
-             it != pos_particle_map_.upper_bound(sqrt(pow(p.pos.x + 2 * p.radius, 2) + pow(p.pos.y + 2 * p.radius, 2)));
-             ++it) {
+        float lower_key = sqrt(pow(pos.x - 2 * p.radius, 2) + pow(pos.y - 2 * p.radius, 2));
+        float upper_key = sqrt(pow(pos.x + 2 * p.radius, 2) + pow(pos.y + 2 * p.radius, 2));
+        //a particle pushed past the top or left wall has its corners' magnitudes the other way around
+        if (lower_key > upper_key) std::swap(lower_key, upper_key);
+
+        //collisions only change velocities, so the end of the range stays put
+        auto range_end = pos_particle_map_.upper_bound(upper_key);
+        for (auto it = pos_particle_map_.lower_bound(lower_key); it != range_end; ++it) {
             //don't consider colliding with itself
-            if (&p != it->second) {
-                vel_diff = glm::vec2(p.vel.x - it->second->vel.x, p.vel.y - it->second->vel.y);
-                pos_diff = glm::vec2(p.pos.x - it->second->pos.x, p.pos.y - it->second->pos.y);
-                //only check for collision if 2 particles are moving towards each other
-                if (glm::dot(vel_diff, pos_diff) < 0) {
-                    //if particles are touching
-                    if (DistBtwnPoints(p, *it->second) <= p.radius + it->second->radius) {
-                        UpdateVelocities(p, *it->second);
-                    }
-                }
+            if (p.id != it->second) {
+                UpdateVelocities(p, particles_[id_to_index_[it->second]]);
             }
         }
     }
 
-    void ParticleController::UpdateVelocities(Particle& p1, Particle& p2) {
-        Particle original_p1 = p1;
-        UpdateVelocity(p1, p2); //updates p1's velocity
-        UpdateVelocity(p2, original_p1); //updates p2's velocity
+    void ParticleController::CheckNeighbourCollision(Particle& p) {
+        const vector<uint32_t>& offsets = neighbour_list_->GetOffsets();
+        const vector<uint32_t>& neighbour_ids = neighbour_list_->GetNeighbourIds();
+        UpdateVelocities(p, neighbour_ids.data() + offsets[p.id], offsets[p.id + 1] - offsets[p.id]);
     }
 
-    void ParticleController::UpdateVelocity(Particle& p1, Particle& p2) {
-        //v1 - v2
-        glm::vec2 vel_diff = glm::vec2(p1.vel.x - p2.vel.x, p1.vel.y - p2.vel.y);
-        //p1 - p2
-        glm::vec2 pos_diff = glm::vec2(p1.pos.x - p2.pos.x, p1.pos.y - p2.pos.y);
+    void ParticleController::CheckGridCollision(Particle& p) {
+        //pairs on different levels are only gathered by the smaller particle, so each of those is checked once a step
+        hierarchical_grid_->GatherCandidates(p, candidate_ids_);
+        UpdateVelocities(p, candidate_ids_.data(), candidate_ids_.size());
+    }
 
-        //2m2 / m1 + m2
-        float mass_fraction = ((2 * p2.mass) / (p1.mass + p2.mass));
+    void ParticleController::CheckGhostCollision(Particle& p) {
+        Vec2 pos = ToVec2(p.pos);
+        Real reach = p.radius + max_ghost_radius_;
+        auto it = std::lower_bound(ghosts_.begin(), ghosts_.end(), pos.y - reach,
+                                   [](const Particle& ghost, const Real y) { return ToVec2(ghost.pos).y < y; });
+        for (; it != ghosts_.end() && ToVec2(it->pos).y <= pos.y + reach; ++it) {
+            //resolved against a copy, the ghost's owner updates the ghost itself
+            Particle ghost = *it;
+            UpdateVelocities(p, ghost);
+        }
+    }
 
-        //(v1 - v2)dot(p1 - p2) / ||p1 - p2||^2
-        float scalar_fraction = glm::dot(vel_diff, pos_diff) / pow(glm::length(pos_diff), 2);
+    void ParticleController::UpdateVelocities(Particle& p, const uint32_t* ids, const size_t num_ids) {
+        //the batched kernel doesn't report which pairs collided, which the monitor needs
+        if (!invariant_monitor_) {
+            ResolveNeighbours(p, particles_, id_to_index_, ids, num_ids);
+            return;
+        }
 
-        //(mass_fraction)(scalar_fraction) * (p1 - p2)
-        glm::vec2 pos_times_scalar = glm::vec2(pos_diff.x * (mass_fraction) * (scalar_fraction),
-                                               pos_diff.y * (mass_fraction) * (scalar_fraction));
+        for (size_t k = 0; k < num_ids; ++k) {
+            UpdateVelocities(p, particles_[id_to_index_[ids[k]]]);
+        }
+    }
 
-        //v1 - pos_times_scalar
-        p1.vel = glm::vec2(p1.vel.x - pos_times_scalar.x, p1.vel.y - pos_times_scalar.y);
+    void ParticleController::UpdateVelocities(Particle& p1, Particle& p2) {
+        //the fused kernel only changes velocities if the particles are touching and moving towards each other
+        if (!invariant_monitor_) {
+            ResolvePair(p1, p2);
+            return;
+        }
+
+        Particle original_p1 = p1;
+        Particle original_p2 = p2;
+        if (ResolvePair(p1, p2)) {
+            invariant_monitor_->RecordCollision(original_p1, original_p2, p1, p2);
+        }
     }
 
     void ParticleController::ChangeSpeeds(const bool should_speed_up) {
@@ -118,9 +415,121 @@ namespace idealgas {
         }
     }
 
-    float ParticleController::DistBtwnPoints(const Particle& p1, const Particle& p2) {
-        return sqrt((pow(p1.pos.x - p2.pos.x, 2) + pow(p1.pos.y - p2.pos.y, 2)));
+    void ParticleController::PermuteParticles(const vector<uint32_t>& order) {
+        vector<Particle> permuted;
+        permuted.reserve(particles_.size());
+        for (uint32_t old_index : order) {
+            permuted.push_back(particles_[old_index]);
+        }
+        particles_.swap(permuted);
+        
+        //pos_particle_map_ and observers refer to particles by id, so only the indirection table changes
+        for (size_t i = 0; i < particles_.size(); ++i) {
+            id_to_index_[particles_[i].id] = static_cast<uint32_t>(i);
+        }
+    }
+
+    float ParticleController::GetCellSize() const {
+        //particles can't touch anything more than one cell away; at least 1 px so a box of points still has cells
+        return std::max(2 * max_radius_, 1.0f);
     }
 
+    void ParticleController::SetNeighbourListSkin(const float skin) {
+        hierarchical_grid_.reset();
+        if (skin > 0) {
+            //the list is built on the next step, and the position map isn't kept up to date while it's in use
+            neighbour_list_.reset(new NeighbourList(skin));
+            pos_particle_map_.clear();
+        } else {
+            neighbour_list_.reset();
+            RebuildPosMap();
+        }
+    }
+
+    void ParticleController::SetHierarchicalGrid(const bool is_enabled) {
+        neighbour_list_.reset();
+        if (is_enabled) {
+            num_grid_builds_ = 0;
+            BuildHierarchicalGrid(x_max_);
+            pos_particle_map_.clear();
+        } else {
+            hierarchical_grid_.reset();
+            RebuildPosMap();
+        }
+    }
+
+    void ParticleController::RebuildPosMap() {
+        pos_particle_map_.clear();
+        for (const Particle& p : particles_) {
+            pos_particle_map_.insert(std::make_pair(glm::length(ToVec2(p.pos)), p.id));
+        }
+    }
+
+    void ParticleController::BuildHierarchicalGrid(const float x_max) {
+        hierarchical_grid_.reset(new HierarchicalGrid(kXMin, x_max, kYMin, kYMax));
+        for (const Particle& p : particles_) {
+            hierarchical_grid_->Insert(p);
+        }
+        num_grid_builds_++;
+    }
+
+    size_t ParticleController::GetNumNeighbourListBuilds() const {
+        return neighbour_list_ ? neighbour_list_->GetNumBuilds() : 0;
+    }
+
+    size_t ParticleController::GetNumGridBuilds() const {
+        return hierarchical_grid_ ? num_grid_builds_ : 0;
+    }
+
+    void ParticleController::SetThermostat(std::unique_ptr<Thermostat> thermostat) {
+        thermostat_ = std::move(thermostat);
+        //the thermostat needs a temperature for its first step, later ones are measured during the update
+        temperature_ = MeasureTemperature();
+    }
+    
+    float ParticleController::MeasureTemperature() const {
+        if (particles_.empty()) return 0;
+        
+        float kinetic_energy = 0;
+        for (const Particle& p : particles_) {
+            kinetic_energy += 0.5f * p.mass * glm::dot(p.vel, p.vel);
+        }
+        return kinetic_energy / particles_.size();
+    }
+    
+    void ParticleController::SetOpenWalls(const bool is_left_open, const bool is_right_open) {
+        is_left_wall_open_ = is_left_open;
+        is_right_wall_open_ = is_right_open;
+    }
+
+    void ParticleController::SetGhosts(const vector<Particle>& ghosts) {
+        ghosts_ = ghosts;
+        std::sort(ghosts_.begin(), ghosts_.end(),
+                  [](const Particle& p1, const Particle& p2) { return ToVec2(p1.pos).y < ToVec2(p2.pos).y; });
+        max_ghost_radius_ = 0;
+        for (const Particle& ghost : ghosts_) {
+            max_ghost_radius_ = std::max(max_ghost_radius_, ghost.radius);
+        }
+    }
+
+    void ParticleController::SetInvariantMonitor(InvariantMonitor* monitor) { invariant_monitor_ = monitor; }
+    float ParticleController::GetTemperature() const { return temperature_; }
+    bool ParticleController::IsPaused() const { return is_paused_; }
+    float ParticleController::GetXMax() const { return x_max_; }
+
+    void ParticleController::SetReorderInterval(const size_t num_steps) { reorder_interval_ = num_steps; }
+    void ParticleController::SetReorderThreshold(const float scattered_fraction) { reorder_threshold_ = scattered_fraction; }
+    float ParticleController::GetScatteredFraction() const { return scattered_fraction_; }
+
     vector<Particle>& ParticleController::GetParticles() { return particles_; }
+    const vector<Particle>& ParticleController::GetParticles() const { return particles_; }
+    Particle& ParticleController::GetParticle(const uint32_t id) { return particles_[id_to_index_[id]]; }
+    size_t ParticleController::GetIndex(const uint32_t id) const { return id_to_index_[id]; }
+
+    ParticleSpecies ParticleController::GetSpecies(const size_t type) const {
+        if (type == kType1) return {kType1, kNumP1, kP1Mass, kP1Radius, kMaxInitialVel.x, kP1Color};
+        if (type == kType2) return {kType2, kNumP2, kP2Mass, kP2Radius, kMaxInitialVel.x, kP2Color};
+        if (type == kType3) return {kType3, kNumP3, kP3Mass, kP3Radius, kMaxInitialVel.x, kP3Color};
+        throw std::out_of_range("no particle species of type " + std::to_string(type));
+    }
 }
\ No newline at end of file
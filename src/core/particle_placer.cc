@@ -0,0 +1,305 @@
+#include "core/particle_placer.h"
+#include "core/parallel_for.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
+namespace idealgas {
+    /* SplitMix64 finalizer: scrambles a counter into 64 random looking bits */
+    static uint64_t Mix(uint64_t x) {
+        x += 0x9e3779b97f4a7c15ULL;
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    static uint64_t Gcd(uint64_t a, uint64_t b) {
+        while (b != 0) {
+            uint64_t r = a % b;
+            a = b;
+            b = r;
+        }
+        return a;
+    }
+
+    /* Stride coprime to n near n / golden ratio: i * stride mod n visits every index once, and consecutive i land
+       far apart, so the first k of n sites are spread evenly */
+    static uint64_t SpreadStride(const uint64_t n) {
+        if (n <= 2) return 1;
+        uint64_t stride = std::max<uint64_t>(static_cast<uint64_t>(n * 0.6180339887), 1);
+        while (Gcd(stride, n) != 1) {
+            stride++;
+        }
+        return stride;
+    }
+
+    ParticlePlacer::ParticlePlacer(const float x_min, const float x_max, const float y_min, const float y_max, const uint32_t seed)
+    : kXMin(x_min),
+      kXMax(x_max),
+      kYMin(y_min),
+      kYMax(y_max),
+      kSeed(seed) {}
+
+    float ParticlePlacer::Random(const uint64_t index, const uint64_t stream) const {
+        //top 24 bits, so every value is exactly representable as a float below 1
+        return static_cast<float>(Mix(Mix(kSeed) ^ Mix(index * 4 + stream)) >> 40) / (1 << 24);
+    }
+
+    vector<glm::vec2> ParticlePlacer::Place(const PlacementStrategy strategy, const size_t num, const float max_radius) const {
+        switch (strategy) {
+            case PlacementStrategy::kLatticeJitter:
+                return PlaceOnLattice(num, max_radius);
+            case PlacementStrategy::kPoissonDisk:
+                return PlacePoissonDisk(num, max_radius);
+            case PlacementStrategy::kUniformRandom:
+                break;
+        }
+        return PlaceUniformRandom(num, max_radius);
+    }
+
+    vector<Particle> ParticlePlacer::MakeParticles(const vector<ParticleSpecies>& species, const PlacementStrategy strategy) const {
+        size_t num_particles = 0;
+        float max_radius = 0;
+        for (const ParticleSpecies& s : species) {
+            num_particles += s.count;
+            max_radius = std::max(max_radius, s.radius);
+        }
+        vector<glm::vec2> positions = Place(strategy, num_particles, max_radius);
+
+        //a generator of its own (rand() is shared by every thread), drawn x then y for each particle in order
+        std::mt19937 random_engine(kSeed);
+        vector<Particle> particles;
+        particles.reserve(num_particles);
+        for (const ParticleSpecies& s : species) {
+            std::uniform_real_distribution<float> vel_component(-s.max_speed, s.max_speed);
+            for (size_t i = 0; i < s.count; ++i) {
+                glm::vec2 vel(vel_component(random_engine), vel_component(random_engine));
+                particles.push_back(Particle(s.type, positions[particles.size()], vel, s.mass, s.radius, s.color));
+            }
+        }
+        return particles;
+    }
+
+    vector<glm::vec2> ParticlePlacer::PlaceUniformRandom(const size_t num, const float max_radius) const {
+        float width = kXMax - kXMin - 2 * max_radius;
+        float height = kYMax - kYMin - 2 * max_radius;
+        vector<glm::vec2> positions(num);
+        ParallelFor(num, kMinPerThread, [&](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; ++i) {
+                positions[i] = glm::vec2(kXMin + max_radius + Random(i, 0) * width, kYMin + max_radius + Random(i, 1) * height);
+            }
+        });
+        return positions;
+    }
+
+    vector<glm::vec2> ParticlePlacer::PlaceOnLattice(const size_t num, const float max_radius) const {
+        float width = kXMax - kXMin;
+        float height = kYMax - kYMin;
+        if (num == 0) return vector<glm::vec2>();
+
+        //about square cells, with at least num of them
+        size_t num_cols = std::max<size_t>(static_cast<size_t>(ceil(sqrt(num * width / height))), 1);
+        size_t num_rows = (num + num_cols - 1) / num_cols;
+        float cell_width = width / num_cols;
+        float cell_height = height / num_rows;
+        if (cell_width < 2 * max_radius || cell_height < 2 * max_radius) {
+            throw std::runtime_error("too many particles to place on a lattice in this box");
+        }
+
+        //a particle can move this far from its cell's center and still be inside the cell
+        float jitter_x = cell_width / 2 - max_radius;
+        float jitter_y = cell_height / 2 - max_radius;
+        uint64_t num_sites = num_cols * num_rows;
+        uint64_t stride = SpreadStride(num_sites);
+
+        vector<glm::vec2> positions(num);
+        ParallelFor(num, kMinPerThread, [&](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; ++i) {
+                uint64_t site = (i * stride) % num_sites;
+                float center_x = kXMin + (site % num_cols + 0.5f) * cell_width;
+                float center_y = kYMin + (site / num_cols + 0.5f) * cell_height;
+                positions[i] = glm::vec2(center_x + (2 * Random(i, 0) - 1) * jitter_x,
+                                         center_y + (2 * Random(i, 1) - 1) * jitter_y);
+            }
+        });
+        return positions;
+    }
+
+    vector<glm::vec2> ParticlePlacer::PlacePoissonDisk(const size_t num, const float max_radius) const {
+        if (num == 0) return vector<glm::vec2>();
+
+        //centers stay max_radius away from the walls, and min_distance apart so particles don't touch
+        float min_distance = 2 * max_radius;
+        float inner_x_min = kXMin + max_radius;
+        float inner_y_min = kYMin + max_radius;
+        float inner_width = kXMax - kXMin - 2 * max_radius;
+        float inner_height = kYMax - kYMin - 2 * max_radius;
+        if (inner_width <= 0 || inner_height <= 0) {
+            throw std::runtime_error("particles are too big for the box");
+        }
+
+        //cell diagonal is min_distance, so a cell holds at most one point, and conflicts are at most 2 cells away
+        float cell_size = std::max(min_distance / static_cast<float>(sqrt(2.0)), 1e-6f);
+        size_t num_cols = static_cast<size_t>(ceil(inner_width / cell_size));
+        size_t num_rows = static_cast<size_t>(ceil(inner_height / cell_size));
+        vector<glm::vec2> cell_points(num_cols * num_rows);
+        vector<char> is_occupied(num_cols * num_rows, 0);
+        float min_distance_squared = min_distance * min_distance;
+
+        size_t num_points = 0;
+        for (size_t round = 0; round < kMaxPoissonRounds && num_points < num; ++round) {
+            for (size_t phase = 0; phase < 9; ++phase) {
+                size_t phase_x = phase % 3;
+                size_t phase_y = phase / 3;
+                size_t num_phase_cols = num_cols > phase_x ? (num_cols - phase_x + 2) / 3 : 0;
+                size_t num_phase_rows = num_rows > phase_y ? (num_rows - phase_y + 2) / 3 : 0;
+
+                //cells in one phase are 3 apart, so no cell reads a cell another thread is writing
+                ParallelFor(num_phase_cols * num_phase_rows, kMinPerThread, [&](size_t begin, size_t end, size_t) {
+                    for (size_t k = begin; k < end; ++k) {
+                        size_t col = phase_x + 3 * (k % num_phase_cols);
+                        size_t row = phase_y + 3 * (k / num_phase_cols);
+                        size_t cell = row * num_cols + col;
+                        if (is_occupied[cell]) continue;
+
+                        uint64_t dart = (round * num_rows + row) * num_cols + col;
+                        glm::vec2 candidate(inner_x_min + (col + Random(dart, 0)) * cell_size,
+                                            inner_y_min + (row + Random(dart, 1)) * cell_size);
+                        if (candidate.x > inner_x_min + inner_width || candidate.y > inner_y_min + inner_height) continue;
+
+                        bool is_far_enough = true;
+                        for (size_t r = row > 2 ? row - 2 : 0; r <= std::min(row + 2, num_rows - 1) && is_far_enough; ++r) {
+                            for (size_t c = col > 2 ? col - 2 : 0; c <= std::min(col + 2, num_cols - 1); ++c) {
+                                size_t other = r * num_cols + c;
+                                if (is_occupied[other]) {
+                                    glm::vec2 diff = cell_points[other] - candidate;
+                                    if (glm::dot(diff, diff) < min_distance_squared) {
+                                        is_far_enough = false;
+                                        break;
+                                    }
+                                }
+                            }
+                        }
+
+                        if (is_far_enough) {
+                            cell_points[cell] = candidate;
+                            is_occupied[cell] = 1;
+                        }
+                    }
+                });
+            }
+            num_points = static_cast<size_t>(std::count(is_occupied.begin(), is_occupied.end(), 1));
+        }
+
+        if (num_points < num) {
+            throw std::runtime_error("couldn't fit that many particles apart from each other in this box");
+        }
+
+        vector<glm::vec2> points;
+        points.reserve(num_points);
+        for (size_t cell = 0; cell < is_occupied.size(); ++cell) {
+            if (is_occupied[cell]) points.push_back(cell_points[cell]);
+        }
+
+        //taking every stride-th point spreads the num chosen ones over the box instead of filling it from the top
+        uint64_t stride = SpreadStride(num_points);
+        vector<glm::vec2> positions(num);
+        for (size_t i = 0; i < num; ++i) {
+            positions[i] = points[(i * stride) % num_points];
+        }
+        return positions;
+    }
+
+    /* Snapshot file: magic, version, particle count, then one fixed size record per particle */
+    static const char kSnapshotMagic[4] = {'I', 'G', 'S', 'N'};
+    static const uint32_t kSnapshotVersion = 2;
+
+    /* Positions and velocities are doubles, which hold every precision's values exactly, so a snapshot loads back
+       unchanged in the build that saved it and can be loaded by a build of any other precision */
+    struct SnapshotRecord {
+        double pos_x;
+        double pos_y;
+        double vel_x;
+        double vel_y;
+        float mass;
+        float radius;
+        float red;
+        float green;
+        float blue;
+        uint32_t type;
+    };
+
+    /* Reads count records, which the caller has checked the file holds */
+    static vector<Particle> ReadSnapshotRecords(std::istream& in, const uint64_t count, const std::string& path) {
+        //records are read in one block rather than one at a time
+        vector<SnapshotRecord> records(count);
+        in.read(reinterpret_cast<char*>(records.data()), count * sizeof(SnapshotRecord));
+        if (!in) {
+            throw std::runtime_error("snapshot " + path + " is truncated");
+        }
+
+        vector<Particle> particles;
+        particles.reserve(count);
+        for (const SnapshotRecord& record : records) {
+            particles.push_back(Particle(record.type, Vec2(0, 0), Vec2(record.vel_x, record.vel_y), record.mass,
+                                         record.radius, cinder::Colorf(record.red, record.green, record.blue)));
+            //set directly rather than through Vec2, which can be less precise than Position (fixed point)
+            particles.back().pos.x = record.pos_x;
+            particles.back().pos.y = record.pos_y;
+        }
+        return particles;
+    }
+
+    void ParticlePlacer::SaveSnapshot(const std::string& path, const vector<Particle>& particles) {
+        std::ofstream out(path, std::ios::binary);
+        if (!out) {
+            throw std::runtime_error("couldn't open snapshot " + path + " for writing");
+        }
+
+        uint64_t count = particles.size();
+        out.write(kSnapshotMagic, sizeof(kSnapshotMagic));
+        out.write(reinterpret_cast<const char*>(&kSnapshotVersion), sizeof(kSnapshotVersion));
+        out.write(reinterpret_cast<const char*>(&count), sizeof(count));
+
+        for (const Particle& p : particles) {
+            SnapshotRecord record = {static_cast<double>(p.pos.x), static_cast<double>(p.pos.y),
+                                     static_cast<double>(p.vel.x), static_cast<double>(p.vel.y), p.mass, p.radius,
+                                     p.color.r, p.color.g, p.color.b, static_cast<uint32_t>(p.type)};
+            out.write(reinterpret_cast<const char*>(&record), sizeof(record));
+        }
+
+        if (!out) {
+            throw std::runtime_error("couldn't write snapshot " + path);
+        }
+    }
+
+    vector<Particle> ParticlePlacer::LoadSnapshot(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("couldn't open snapshot " + path);
+        }
+
+        char magic[4];
+        uint32_t version = 0;
+        uint64_t count = 0;
+        in.read(magic, sizeof(magic));
+        in.read(reinterpret_cast<char*>(&version), sizeof(version));
+        in.read(reinterpret_cast<char*>(&count), sizeof(count));
+        if (!in || !std::equal(magic, magic + 4, kSnapshotMagic) || version != kSnapshotVersion) {
+            throw std::runtime_error(path + " isn't a particle snapshot");
+        }
+
+        //a corrupt count could ask for any amount of memory, so it's checked against what the file holds first
+        std::streampos records_start = in.tellg();
+        in.seekg(0, std::ios::end);
+        uint64_t num_record_bytes = static_cast<uint64_t>(in.tellg() - records_start);
+        in.seekg(records_start);
+        if (!in || count > num_record_bytes / sizeof(SnapshotRecord)) {
+            throw std::runtime_error("snapshot " + path + " is truncated");
+        }
+
+        return ReadSnapshotRecords(in, count, path);
+    }
+}
@@ -0,0 +1,348 @@
+#include "core/particle_transport.h"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#ifdef IDEALGAS_WITH_MPI
+#include <mpi.h>
+#endif
+
+namespace idealgas {
+#if !defined(_WIN32) || defined(IDEALGAS_WITH_MPI)
+    /* One particle as sent between ranks. Particle itself isn't sent, since its members (cinder's color) needn't be
+       trivially copyable. Positions and velocities are doubles, which hold every precision's values exactly */
+    struct ParticleRecord {
+        double pos_x;
+        double pos_y;
+        double vel_x;
+        double vel_y;
+        float mass;
+        float radius;
+        float red;
+        float green;
+        float blue;
+        uint32_t type;
+        uint32_t id;
+    };
+
+    /* Copies particles into the records sent for them */
+    static vector<ParticleRecord> ToRecords(const vector<Particle>& particles) {
+        //value-initialized, so padding bytes are sent as zeros rather than whatever was in memory
+        vector<ParticleRecord> records(particles.size());
+        for (size_t i = 0; i < particles.size(); ++i) {
+            const Particle& p = particles[i];
+            ParticleRecord& record = records[i];
+            record.pos_x = static_cast<double>(p.pos.x);
+            record.pos_y = static_cast<double>(p.pos.y);
+            record.vel_x = static_cast<double>(p.vel.x);
+            record.vel_y = static_cast<double>(p.vel.y);
+            record.mass = p.mass;
+            record.radius = p.radius;
+            record.red = p.color.r;
+            record.green = p.color.g;
+            record.blue = p.color.b;
+            record.type = static_cast<uint32_t>(p.type);
+            record.id = p.id;
+        }
+        return records;
+    }
+
+    /* Makes particles from count records in a received byte buffer */
+    static vector<Particle> ParticlesFromBytes(const char* bytes, const size_t count) {
+        vector<ParticleRecord> records(count);
+        if (count > 0) {
+            memcpy(records.data(), bytes, count * sizeof(ParticleRecord));
+        }
+
+        vector<Particle> particles;
+        particles.reserve(count);
+        for (const ParticleRecord& record : records) {
+            particles.push_back(Particle(record.type, Vec2(0, 0), Vec2(record.vel_x, record.vel_y), record.mass,
+                                         record.radius, cinder::Colorf(record.red, record.green, record.blue)));
+            //set directly rather than through Vec2, which can be less precise than Position (fixed point)
+            particles.back().pos.x = record.pos_x;
+            particles.back().pos.y = record.pos_y;
+            particles.back().id = record.id;
+        }
+        return particles;
+    }
+#endif
+
+#ifndef _WIN32
+#ifdef MSG_NOSIGNAL
+    //a neighbour that went away shows up as an error from send instead of killing the process with SIGPIPE
+    static const int kSendFlags = MSG_NOSIGNAL;
+#else
+    static const int kSendFlags = 0;
+#endif
+
+    SocketTransport::SocketTransport(const int rank, const int num_ranks, const int left_socket, const int right_socket)
+    : kRank(rank),
+      kNumRanks(num_ranks),
+      left_socket_(left_socket),
+      right_socket_(right_socket) {
+        //non-blocking, so Exchange can read whenever a write would block
+        for (int socket : {left_socket_, right_socket_}) {
+            if (socket >= 0) {
+                fcntl(socket, F_SETFL, fcntl(socket, F_GETFL) | O_NONBLOCK);
+            }
+        }
+    }
+
+    SocketTransport::~SocketTransport() {
+        if (left_socket_ >= 0) close(left_socket_);
+        if (right_socket_ >= 0) close(right_socket_);
+    }
+
+    vector<std::unique_ptr<SocketTransport>> SocketTransport::CreateConnected(const int num_ranks) {
+        //sockets[i] connects rank i (end 0) to rank i + 1 (end 1)
+        vector<int> left_ends(num_ranks, -1);
+        vector<int> right_ends(num_ranks, -1);
+        for (int i = 0; i + 1 < num_ranks; ++i) {
+            int sockets[2];
+            if (socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) != 0) {
+                throw std::runtime_error("socketpair failed: " + std::string(strerror(errno)));
+            }
+            right_ends[i] = sockets[0];
+            left_ends[i + 1] = sockets[1];
+        }
+
+        vector<std::unique_ptr<SocketTransport>> transports;
+        for (int i = 0; i < num_ranks; ++i) {
+            transports.push_back(std::unique_ptr<SocketTransport>(new SocketTransport(i, num_ranks, left_ends[i], right_ends[i])));
+        }
+        return transports;
+    }
+
+    vector<Particle> SocketTransport::Exchange(const Neighbour neighbour, const vector<Particle>& outgoing) {
+        int socket = neighbour == Neighbour::kLeft ? left_socket_ : right_socket_;
+        if (socket < 0) return vector<Particle>();
+
+        //message: number of particles, then the particles
+        vector<ParticleRecord> records = ToRecords(outgoing);
+        uint64_t num_outgoing = records.size();
+        vector<char> out_bytes(sizeof(num_outgoing) + num_outgoing * sizeof(ParticleRecord));
+        memcpy(out_bytes.data(), &num_outgoing, sizeof(num_outgoing));
+        if (num_outgoing > 0) {
+            memcpy(out_bytes.data() + sizeof(num_outgoing), records.data(), num_outgoing * sizeof(ParticleRecord));
+        }
+
+        uint64_t num_incoming = 0;
+        vector<char> in_bytes(sizeof(num_incoming));
+        bool has_count = false;
+        size_t num_sent = 0;
+        size_t num_received = 0;
+
+        //reads and writes are interleaved so neither side waits on a full socket buffer while the other is also writing
+        while (num_sent < out_bytes.size() || num_received < in_bytes.size()) {
+            pollfd poll_fd;
+            poll_fd.fd = socket;
+            poll_fd.events = 0;
+            poll_fd.revents = 0;
+            if (num_sent < out_bytes.size()) poll_fd.events |= POLLOUT;
+            if (num_received < in_bytes.size()) poll_fd.events |= POLLIN;
+
+            if (poll(&poll_fd, 1, -1) < 0) {
+                if (errno == EINTR) continue;
+                throw std::runtime_error("poll failed: " + std::string(strerror(errno)));
+            }
+
+            if (poll_fd.revents & POLLOUT) {
+                ssize_t num_bytes = send(socket, out_bytes.data() + num_sent, out_bytes.size() - num_sent, kSendFlags);
+                if (num_bytes < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    throw std::runtime_error("send to neighbour failed: " + std::string(strerror(errno)));
+                }
+                if (num_bytes > 0) num_sent += num_bytes;
+            }
+
+            if (poll_fd.revents & (POLLIN | POLLHUP | POLLERR)) {
+                ssize_t num_bytes = recv(socket, in_bytes.data() + num_received, in_bytes.size() - num_received, 0);
+                if (num_bytes == 0) {
+                    throw std::runtime_error("neighbour closed its connection");
+                }
+                if (num_bytes < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                    throw std::runtime_error("receive from neighbour failed: " + std::string(strerror(errno)));
+                }
+                if (num_bytes > 0) num_received += num_bytes;
+
+                //once the count is in, the rest of the message has a known size
+                if (!has_count && num_received == sizeof(num_incoming)) {
+                    memcpy(&num_incoming, in_bytes.data(), sizeof(num_incoming));
+                    in_bytes.resize(sizeof(num_incoming) + num_incoming * sizeof(ParticleRecord));
+                    has_count = true;
+                }
+            }
+        }
+
+        return ParticlesFromBytes(in_bytes.data() + sizeof(num_incoming), num_incoming);
+    }
+
+    int SocketTransport::GetRank() const { return kRank; }
+    int SocketTransport::GetNumRanks() const { return kNumRanks; }
+
+    /* Blocking write / read of exactly num_bytes on a pipe, false if the other end went away first */
+    static bool WriteAll(const int fd, const char* bytes, size_t num_bytes) {
+        while (num_bytes > 0) {
+            ssize_t num_written = write(fd, bytes, num_bytes);
+            if (num_written < 0 && errno == EINTR) continue;
+            if (num_written <= 0) return false;
+            bytes += num_written;
+            num_bytes -= num_written;
+        }
+        return true;
+    }
+
+    static bool ReadAll(const int fd, char* bytes, size_t num_bytes) {
+        while (num_bytes > 0) {
+            ssize_t num_read = read(fd, bytes, num_bytes);
+            if (num_read < 0 && errno == EINTR) continue;
+            if (num_read <= 0) return false;
+            bytes += num_read;
+            num_bytes -= num_read;
+        }
+        return true;
+    }
+
+    vector<vector<Particle>> RunForkedRanks(const int num_ranks,
+                                            const std::function<vector<Particle>(ParticleTransport&)>& rank_main) {
+        vector<std::unique_ptr<SocketTransport>> transports = SocketTransport::CreateConnected(num_ranks);
+        vector<pid_t> pids;
+        vector<int> result_fds;
+
+        //anything buffered would otherwise be written again by every child
+        std::cout.flush();
+        fflush(nullptr);
+
+        string error;
+        for (int rank = 0; rank < num_ranks && error.empty(); ++rank) {
+            int result_pipe[2];
+            if (pipe(result_pipe) != 0) {
+                error = "pipe failed: " + string(strerror(errno));
+                break;
+            }
+            pid_t pid = fork();
+            if (pid < 0) {
+                error = "fork failed: " + string(strerror(errno));
+                close(result_pipe[0]);
+                close(result_pipe[1]);
+                break;
+            }
+
+            if (pid == 0) {
+                //the child keeps only its own sockets and the write end of its own pipe
+                close(result_pipe[0]);
+                for (int fd : result_fds) close(fd);
+                for (int other = 0; other < num_ranks; ++other) {
+                    if (other != rank) transports[other].reset();
+                }
+
+                int status = 1;
+                try {
+                    vector<ParticleRecord> records = ToRecords(rank_main(*transports[rank]));
+                    uint64_t count = records.size();
+                    if (WriteAll(result_pipe[1], reinterpret_cast<const char*>(&count), sizeof(count)) &&
+                        WriteAll(result_pipe[1], reinterpret_cast<const char*>(records.data()), count * sizeof(ParticleRecord))) {
+                        status = 0;
+                    }
+                } catch (const std::exception& e) {
+                    std::cerr << "rank " << rank << ": " << e.what() << std::endl;
+                }
+                std::cout.flush();
+                fflush(nullptr);
+                //skips the parent's atexit handlers and destructors, which aren't the child's to run
+                _exit(status);
+            }
+
+            close(result_pipe[1]);
+            pids.push_back(pid);
+            result_fds.push_back(result_pipe[0]);
+        }
+
+        //only the children use the sockets; if a rank couldn't be started, closing its ends here makes its
+        //neighbours' exchanges fail, so every child that did start exits rather than waiting forever
+        transports.clear();
+
+        vector<vector<Particle>> results(pids.size());
+        vector<bool> is_complete(pids.size(), false);
+        for (size_t rank = 0; rank < pids.size(); ++rank) {
+            uint64_t count = 0;
+            if (ReadAll(result_fds[rank], reinterpret_cast<char*>(&count), sizeof(count))) {
+                vector<char> bytes(count * sizeof(ParticleRecord));
+                if (ReadAll(result_fds[rank], bytes.data(), bytes.size())) {
+                    results[rank] = ParticlesFromBytes(bytes.data(), count);
+                    is_complete[rank] = true;
+                }
+            }
+            close(result_fds[rank]);
+        }
+
+        for (size_t rank = 0; rank < pids.size(); ++rank) {
+            int status = 0;
+            while (waitpid(pids[rank], &status, 0) < 0 && errno == EINTR) {}
+            bool has_succeeded = WIFEXITED(status) && WEXITSTATUS(status) == 0;
+            if (error.empty() && (!has_succeeded || !is_complete[rank])) {
+                error = "rank " + std::to_string(rank) + " failed";
+            }
+        }
+
+        if (!error.empty()) throw std::runtime_error(error);
+        return results;
+    }
+#endif
+
+#ifdef IDEALGAS_WITH_MPI
+    MpiTransport::MpiTransport(const size_t max_chunk_bytes)
+    : kMaxChunkBytes(std::max<size_t>(std::min<size_t>(max_chunk_bytes, INT_MAX) / sizeof(ParticleRecord), 1) * sizeof(ParticleRecord)) {
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank_);
+        MPI_Comm_size(MPI_COMM_WORLD, &num_ranks_);
+    }
+
+    vector<Particle> MpiTransport::Exchange(const Neighbour neighbour, const vector<Particle>& outgoing) {
+        int other_rank = neighbour == Neighbour::kLeft ? rank_ - 1 : rank_ + 1;
+        if (other_rank < 0 || other_rank >= num_ranks_) return vector<Particle>();
+
+        //counts first so the receiving side can size its buffer
+        unsigned long long num_outgoing = outgoing.size();
+        unsigned long long num_incoming = 0;
+        MPI_Sendrecv(&num_outgoing, 1, MPI_UNSIGNED_LONG_LONG, other_rank, 0,
+                     &num_incoming, 1, MPI_UNSIGNED_LONG_LONG, other_rank, 0,
+                     MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+
+        //MPI counts are ints, so messages over 2 GB go in chunks. Both sides loop over the larger of the two
+        //messages in chunks of the same size, so every chunk sent has a matching receive (possibly of 0 bytes)
+        vector<ParticleRecord> records = ToRecords(outgoing);
+        const char* out_bytes = reinterpret_cast<const char*>(records.data());
+        size_t num_out_bytes = num_outgoing * sizeof(ParticleRecord);
+        vector<char> in_bytes(num_incoming * sizeof(ParticleRecord));
+        size_t num_bytes = std::max(num_out_bytes, in_bytes.size());
+        size_t offset = 0;
+        do {
+            size_t num_send = offset < num_out_bytes ? std::min(kMaxChunkBytes, num_out_bytes - offset) : 0;
+            size_t num_receive = offset < in_bytes.size() ? std::min(kMaxChunkBytes, in_bytes.size() - offset) : 0;
+            MPI_Sendrecv(out_bytes + std::min(offset, num_out_bytes), static_cast<int>(num_send), MPI_BYTE, other_rank, 1,
+                         in_bytes.data() + std::min(offset, in_bytes.size()), static_cast<int>(num_receive), MPI_BYTE,
+                         other_rank, 1, MPI_COMM_WORLD, MPI_STATUS_IGNORE);
+            offset += kMaxChunkBytes;
+        } while (offset < num_bytes);
+
+        return ParticlesFromBytes(in_bytes.data(), num_incoming);
+    }
+
+    int MpiTransport::GetRank() const { return rank_; }
+    int MpiTransport::GetNumRanks() const { return num_ranks_; }
+#endif
+}
@@ -0,0 +1,75 @@
+#include "core/performance_scenarios.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include "core/invariant_monitor.h"
+#include "core/particle_placer.h"
+
+namespace idealgas {
+    const vector<PerformanceScenario> kPerformanceScenarios = {
+            {"dilute", 500, 1000, 2, 0, 400, 0, false},
+            {"dense", 2000, 250, 2, 0, 100, 0, false},
+            {"high_speed", 500, 1000, 2, 10, 400, 0, false},
+            {"dense_neighbour_list", 2000, 250, 2, 0, 100, 2, false},
+            {"dense_hierarchical_grid", 2000, 250, 2, 0, 100, 0, true}
+    };
+
+    std::unique_ptr<ParticleController> MakeScenarioController(const PerformanceScenario& scenario) {
+        ParticlePlacer placer(0, scenario.box_width, 0, scenario.box_width, 1);
+        vector<Particle> particles = placer.MakeParticles({{1, scenario.num_particles, 1, scenario.radius, 2, cinder::Colorf(1, 1, 1)}});
+
+        std::unique_ptr<ParticleController> particle_controller(
+                new ParticleController(particles, 0, scenario.box_width, 0, scenario.box_width));
+        for (size_t i = 0; i < scenario.num_speed_ups; ++i) {
+            particle_controller->ChangeSpeeds(true);
+        }
+        particle_controller->SetNeighbourListSkin(scenario.neighbour_skin);
+        if (scenario.is_hierarchical_grid) particle_controller->SetHierarchicalGrid(true);
+        return particle_controller;
+    }
+
+    size_t CountScenarioCollisions(const PerformanceScenario& scenario) {
+        std::unique_ptr<ParticleController> particle_controller = MakeScenarioController(scenario);
+        InvariantMonitor monitor;
+        particle_controller->SetInvariantMonitor(&monitor);
+        for (size_t step = 0; step < scenario.num_steps; ++step) {
+            particle_controller->UpdateParticles();
+        }
+        return monitor.GetNumCollisions();
+    }
+
+    double MeasureStepsPerSecond(const PerformanceScenario& scenario, const size_t num_runs) {
+        double best_seconds = 0;
+        for (size_t run = 0; run < std::max<size_t>(num_runs, 1); ++run) {
+            std::unique_ptr<ParticleController> particle_controller = MakeScenarioController(scenario);
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            for (size_t step = 0; step < scenario.num_steps; ++step) {
+                particle_controller->UpdateParticles();
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            best_seconds = run == 0 ? seconds : std::min(best_seconds, seconds);
+        }
+        return scenario.num_steps / best_seconds;
+    }
+
+    std::map<string, PerformanceResult> ReadPerformanceResults(const string& path) {
+        std::map<string, PerformanceResult> results;
+        std::ifstream in(path);
+        string line;
+        while (std::getline(in, line)) {
+            if (line.empty() || line[0] == '#') continue;
+            std::istringstream fields(line);
+            string name;
+            PerformanceResult result;
+            if (fields >> name >> result.steps_per_second >> result.num_collisions) {
+                results[name] = result;
+            }
+        }
+        return results;
+    }
+
+    void WritePerformanceResult(std::ostream& out, const string& name, const PerformanceResult& result) {
+        out << name << ' ' << result.steps_per_second << ' ' << result.num_collisions << '\n';
+    }
+}
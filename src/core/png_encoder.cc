@@ -0,0 +1,115 @@
+#include "core/png_encoder.h"
+#include <algorithm>
+#include <fstream>
+#include <stdexcept>
+
+namespace idealgas {
+    /* Largest block deflate can store uncompressed */
+    static const size_t kMaxStoredBlock = 65535;
+
+    /* Most bytes Adler-32 can add up before its sums need reducing (same limit as zlib's) */
+    static const size_t kAdlerRun = 5552;
+
+    uint32_t Crc32(const uint8_t* data, const size_t size, const uint32_t crc) {
+        static const vector<uint32_t> kTable = [] {
+            vector<uint32_t> table(256);
+            for (uint32_t n = 0; n < 256; ++n) {
+                uint32_t c = n;
+                for (int k = 0; k < 8; ++k) {
+                    c = (c & 1) ? 0xedb88320u ^ (c >> 1) : c >> 1;
+                }
+                table[n] = c;
+            }
+            return table;
+        }();
+
+        uint32_t c = crc ^ 0xffffffffu;
+        for (size_t i = 0; i < size; ++i) {
+            c = kTable[(c ^ data[i]) & 0xff] ^ (c >> 8);
+        }
+        return c ^ 0xffffffffu;
+    }
+
+    static void AppendBigEndian(vector<uint8_t>& out, const uint32_t value) {
+        out.push_back(static_cast<uint8_t>(value >> 24));
+        out.push_back(static_cast<uint8_t>(value >> 16));
+        out.push_back(static_cast<uint8_t>(value >> 8));
+        out.push_back(static_cast<uint8_t>(value));
+    }
+
+    /* Chunk: length, type, data, then CRC of type and data */
+    static void AppendChunk(vector<uint8_t>& out, const char type[4], const vector<uint8_t>& data) {
+        AppendBigEndian(out, static_cast<uint32_t>(data.size()));
+        size_t type_start = out.size();
+        out.insert(out.end(), type, type + 4);
+        out.insert(out.end(), data.begin(), data.end());
+        AppendBigEndian(out, Crc32(out.data() + type_start, out.size() - type_start));
+    }
+
+    vector<uint8_t> EncodePng(const vector<uint8_t>& rgb, const size_t width, const size_t height) {
+        if (rgb.size() != 3 * width * height) {
+            throw std::invalid_argument("pixel data doesn't match the image size");
+        }
+
+        vector<uint8_t> png = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n'};
+
+        //8 bit RGB, no interlacing
+        vector<uint8_t> header;
+        AppendBigEndian(header, static_cast<uint32_t>(width));
+        AppendBigEndian(header, static_cast<uint32_t>(height));
+        header.insert(header.end(), {8, 2, 0, 0, 0});
+        AppendChunk(png, "IHDR", header);
+
+        //every row starts with filter type 0 (none)
+        size_t row_size = 3 * width;
+        vector<uint8_t> raw;
+        raw.reserve((row_size + 1) * height);
+        for (size_t y = 0; y < height; ++y) {
+            raw.push_back(0);
+            raw.insert(raw.end(), rgb.begin() + y * row_size, rgb.begin() + (y + 1) * row_size);
+        }
+
+        //zlib stream: header, stored blocks of at most kMaxStoredBlock bytes, then Adler-32 of the raw data
+        vector<uint8_t> zlib = {0x78, 0x01};
+        zlib.reserve(raw.size() + 5 * (raw.size() / kMaxStoredBlock + 1) + 6);
+        size_t offset = 0;
+        do {
+            size_t block_size = std::min(kMaxStoredBlock, raw.size() - offset);
+            bool is_final = offset + block_size == raw.size();
+            zlib.push_back(is_final ? 1 : 0);
+            zlib.push_back(static_cast<uint8_t>(block_size));
+            zlib.push_back(static_cast<uint8_t>(block_size >> 8));
+            zlib.push_back(static_cast<uint8_t>(~block_size));
+            zlib.push_back(static_cast<uint8_t>(~block_size >> 8));
+            zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + block_size);
+            offset += block_size;
+        } while (offset < raw.size());
+
+        //sums can't overflow 32 bits within kAdlerRun bytes, so the modulo is only taken once per run
+        uint32_t a = 1;
+        uint32_t b = 0;
+        for (size_t start = 0; start < raw.size(); start += kAdlerRun) {
+            size_t end = std::min(start + kAdlerRun, raw.size());
+            for (size_t i = start; i < end; ++i) {
+                a += raw[i];
+                b += a;
+            }
+            a %= 65521;
+            b %= 65521;
+        }
+        AppendBigEndian(zlib, (b << 16) | a);
+        AppendChunk(png, "IDAT", zlib);
+
+        AppendChunk(png, "IEND", vector<uint8_t>());
+        return png;
+    }
+
+    void WritePng(const std::string& path, const vector<uint8_t>& rgb, const size_t width, const size_t height) {
+        vector<uint8_t> png = EncodePng(rgb, width, height);
+        std::ofstream out(path, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(png.data()), png.size());
+        if (!out) {
+            throw std::runtime_error("couldn't write " + path);
+        }
+    }
+}
@@ -0,0 +1,138 @@
+#include "core/quantile_sketch.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+namespace idealgas {
+    QuantileSketch::QuantileSketch(const size_t k)
+    : min_(std::numeric_limits<float>::max()),
+      max_(std::numeric_limits<float>::lowest()),
+      k_(std::max<size_t>(k, 2)) {
+        AddLevel();
+    }
+
+    void QuantileSketch::Insert(const float value) {
+        count_++;
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+        levels_[0].push_back(value);
+        num_retained_++;
+
+        //nothing is compacted until the sketch as a whole is full, so most inserts are just a push
+        if (num_retained_ >= total_capacity_) {
+            Compress();
+        }
+    }
+
+    void QuantileSketch::Merge(const QuantileSketch& other) {
+        if (other.count_ == 0) return;
+
+        count_ += other.count_;
+        min_ = std::min(min_, other.min_);
+        max_ = std::max(max_, other.max_);
+
+        //items at the same level have the same weight, so levels are simply concatenated
+        while (levels_.size() < other.levels_.size()) {
+            AddLevel();
+        }
+        for (size_t h = 0; h < other.levels_.size(); ++h) {
+            levels_[h].insert(levels_[h].end(), other.levels_[h].begin(), other.levels_[h].end());
+        }
+        num_retained_ += other.num_retained_;
+
+        Compress();
+    }
+
+    float QuantileSketch::Quantile(const float fraction) const {
+        if (count_ == 0) return 0;
+        if (fraction <= 0) return min_;
+        if (fraction >= 1) return max_;
+
+        //(value, weight) pairs sorted by value form an approximate cumulative distribution
+        vector<std::pair<float, size_t>> weighted_items;
+        size_t total_weight = 0;
+        for (size_t h = 0; h < levels_.size(); ++h) {
+            for (float value : levels_[h]) {
+                weighted_items.push_back(std::make_pair(value, static_cast<size_t>(1) << h));
+                total_weight += static_cast<size_t>(1) << h;
+            }
+        }
+        std::sort(weighted_items.begin(), weighted_items.end());
+
+        float target_weight = fraction * total_weight;
+        size_t cumulative_weight = 0;
+        for (std::pair<float, size_t>& item : weighted_items) {
+            cumulative_weight += item.second;
+            if (cumulative_weight >= target_weight) {
+                return item.first;
+            }
+        }
+        return max_;
+    }
+
+    void QuantileSketch::Clear() {
+        //level 0 keeps its allocation, it's where refilled values go first
+        levels_.resize(1);
+        levels_[0].clear();
+        capacities_.assign(1, k_);
+        total_capacity_ = k_;
+
+        count_ = 0;
+        num_retained_ = 0;
+        keep_odd_ = false;
+        min_ = std::numeric_limits<float>::max();
+        max_ = std::numeric_limits<float>::lowest();
+    }
+
+    void QuantileSketch::AddLevel() {
+        levels_.push_back(vector<float>());
+
+        //top level holds k items, each level below holds 2/3 as many (at least 2), so every capacity changes
+        capacities_.resize(levels_.size());
+        total_capacity_ = 0;
+        for (size_t h = 0; h < levels_.size(); ++h) {
+            size_t depth = levels_.size() - 1 - h;
+            capacities_[h] = std::max<size_t>(2, static_cast<size_t>(k_ * pow(2.0 / 3.0, depth)));
+            total_capacity_ += capacities_[h];
+        }
+    }
+
+    void QuantileSketch::Compress() {
+        //compacts the lowest full level until everything fits, each compaction halves that level
+        while (num_retained_ >= total_capacity_) {
+            for (size_t h = 0; h < levels_.size(); ++h) {
+                if (levels_[h].size() >= capacities_[h]) {
+                    CompactLevel(h);
+                    break;
+                }
+            }
+        }
+    }
+
+    void QuantileSketch::CompactLevel(const size_t level) {
+        if (level + 1 == levels_.size()) {
+            AddLevel();
+        }
+
+        vector<float>& items = levels_[level];
+        std::sort(items.begin(), items.end());
+
+        //an odd item out stays behind so the total weight is preserved exactly
+        size_t num_paired = items.size() - items.size() % 2;
+        vector<float>& next_level = levels_[level + 1];
+        for (size_t i = keep_odd_ ? 1 : 0; i < num_paired; i += 2) {
+            next_level.push_back(items[i]);
+        }
+        keep_odd_ = !keep_odd_;
+
+        items.erase(items.begin(), items.begin() + num_paired);
+        num_retained_ -= num_paired / 2;
+    }
+
+    size_t QuantileSketch::GetNumRetained() const { return num_retained_; }
+
+    size_t QuantileSketch::GetCount() const { return count_; }
+    float QuantileSketch::GetMin() const { return min_; }
+    float QuantileSketch::GetMax() const { return max_; }
+}
@@ -0,0 +1,87 @@
+#include "core/spatial_sort.h"
+#include "core/parallel_for.h"
+#include <algorithm>
+
+namespace idealgas {
+    /* Number of bits sorted per radix pass, and keys per thread below which the sort runs on one thread */
+    const size_t kRadixBits = 8;
+    const size_t kNumBuckets = 1 << kRadixBits;
+    const size_t kMinKeysPerThread = 65536;
+
+    /* Spreads the low 16 bits of v out so there is a 0 bit between each of them */
+    uint32_t SpreadBits(uint32_t v) {
+        v &= 0x0000ffff;
+        v = (v | (v << 8)) & 0x00ff00ff;
+        v = (v | (v << 4)) & 0x0f0f0f0f;
+        v = (v | (v << 2)) & 0x33333333;
+        v = (v | (v << 1)) & 0x55555555;
+        return v;
+    }
+
+    uint32_t MortonKey(const uint32_t cell_x, const uint32_t cell_y) {
+        return SpreadBits(cell_x) | (SpreadBits(cell_y) << 1);
+    }
+
+    uint32_t CellMortonKey(const glm::vec2& pos, const glm::vec2& origin, const float cell_size) {
+        //particles can be slightly outside the box, so cells are clamped to the 16 bit grid
+        float cell_x = std::min(std::max((pos.x - origin.x) / cell_size, 0.0f), 65535.0f);
+        float cell_y = std::min(std::max((pos.y - origin.y) / cell_size, 0.0f), 65535.0f);
+        return MortonKey(static_cast<uint32_t>(cell_x), static_cast<uint32_t>(cell_y));
+    }
+
+    void RadixSortByKey(vector<uint32_t>& keys, vector<uint32_t>& values) {
+        size_t num_keys = keys.size();
+        size_t num_chunks = GetNumChunks(num_keys, kMinKeysPerThread);
+        vector<uint32_t> sorted_keys(num_keys);
+        vector<uint32_t> sorted_values(num_keys);
+
+        for (size_t shift = 0; shift < 32; shift += kRadixBits) {
+            //each chunk counts its own digits; chunk c's buckets are stored at [c * kNumBuckets, (c + 1) * kNumBuckets)
+            vector<size_t> offsets(num_chunks * kNumBuckets, 0);
+            ParallelFor(num_keys, kMinKeysPerThread, [&](size_t begin, size_t end, size_t chunk) {
+                size_t* counts = &offsets[chunk * kNumBuckets];
+                for (size_t i = begin; i < end; ++i) {
+                    counts[(keys[i] >> shift) & (kNumBuckets - 1)]++;
+                }
+            });
+
+            //exclusive prefix sum, bucket-major so that equal digits keep their chunk order (stable)
+            size_t total = 0;
+            for (size_t bucket = 0; bucket < kNumBuckets; ++bucket) {
+                for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+                    size_t count = offsets[chunk * kNumBuckets + bucket];
+                    offsets[chunk * kNumBuckets + bucket] = total;
+                    total += count;
+                }
+            }
+
+            //every chunk scatters into its own disjoint output ranges
+            ParallelFor(num_keys, kMinKeysPerThread, [&](size_t begin, size_t end, size_t chunk) {
+                size_t* next = &offsets[chunk * kNumBuckets];
+                for (size_t i = begin; i < end; ++i) {
+                    size_t dest = next[(keys[i] >> shift) & (kNumBuckets - 1)]++;
+                    sorted_keys[dest] = keys[i];
+                    sorted_values[dest] = values[i];
+                }
+            });
+
+            keys.swap(sorted_keys);
+            values.swap(sorted_values);
+        }
+    }
+
+    vector<uint32_t> GetMortonOrder(const vector<Particle>& particles, const glm::vec2& origin, const float cell_size) {
+        vector<uint32_t> keys(particles.size());
+        vector<uint32_t> order(particles.size());
+
+        ParallelFor(particles.size(), kMinKeysPerThread, [&](size_t begin, size_t end, size_t) {
+            for (size_t i = begin; i < end; ++i) {
+                keys[i] = CellMortonKey(particles[i].pos, origin, cell_size);
+                order[i] = static_cast<uint32_t>(i);
+            }
+        });
+
+        RadixSortByKey(keys, order);
+        return order;
+    }
+}
@@ -0,0 +1,201 @@
+#include "core/state_publisher.h"
+
+#ifndef _WIN32
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace idealgas {
+    /* Identifies a segment written by this version of StatePublisher */
+    static const uint32_t kMagic = 0x49474153; //"IGAS"
+    static const uint32_t kVersion = 1;
+
+    /* Bytes needed for a segment with the given sizes */
+    static size_t SegmentSize(const size_t max_particles, const size_t num_histograms, const size_t num_bins) {
+        return sizeof(SharedStateHeader) + max_particles * sizeof(SharedParticle) +
+               num_histograms * (2 * num_bins + 1) * sizeof(float);
+    }
+
+    StatePublisher::StatePublisher(const std::string& name, const size_t max_particles, const size_t num_histograms, const size_t num_bins)
+    : kName(name),
+      size_(SegmentSize(max_particles, num_histograms, num_bins)) {
+        //a fresh segment, so readers still mapping an old one with other sizes don't see it change under them
+        shm_unlink(kName.c_str());
+        int fd = shm_open(kName.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0) {
+            throw std::runtime_error("couldn't create shared memory " + kName + ": " + strerror(errno));
+        }
+        if (ftruncate(fd, static_cast<off_t>(size_)) != 0) {
+            close(fd);
+            shm_unlink(kName.c_str());
+            throw std::runtime_error("couldn't size shared memory " + kName + ": " + strerror(errno));
+        }
+        memory_ = mmap(nullptr, size_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (memory_ == MAP_FAILED) {
+            shm_unlink(kName.c_str());
+            throw std::runtime_error("couldn't map shared memory " + kName + ": " + strerror(errno));
+        }
+
+        header_ = new (memory_) SharedStateHeader();
+        header_->magic = kMagic;
+        header_->version = kVersion;
+        header_->max_particles = static_cast<uint32_t>(max_particles);
+        header_->num_histograms = static_cast<uint32_t>(num_histograms);
+        header_->num_bins = static_cast<uint32_t>(num_bins);
+        header_->num_particles = 0;
+        header_->frame = 0;
+        header_->temperature = 0;
+        header_->sequence.store(0, std::memory_order_release);
+
+        particles_ = reinterpret_cast<SharedParticle*>(static_cast<char*>(memory_) + sizeof(SharedStateHeader));
+        bins_ = reinterpret_cast<float*>(particles_ + max_particles);
+    }
+
+    StatePublisher::~StatePublisher() {
+        munmap(memory_, size_);
+        shm_unlink(kName.c_str());
+    }
+
+    void StatePublisher::Publish(const vector<Particle>& particles, vector<Histogram>& histograms, const float temperature) {
+        //odd sequence tells readers a frame is being written, the fence keeps the data writes after it
+        uint64_t sequence = header_->sequence.load(std::memory_order_relaxed);
+        header_->sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        size_t num_particles = std::min<size_t>(particles.size(), header_->max_particles);
+        for (size_t i = 0; i < num_particles; ++i) {
+            const Particle& p = particles[i];
+            glm::vec2 pos = ToVec2(p.pos);
+            SharedParticle& shared = particles_[i];
+            shared.id = p.id;
+            shared.type = static_cast<uint32_t>(p.type);
+            shared.x = pos.x;
+            shared.y = pos.y;
+            shared.vel_x = static_cast<float>(p.vel.x);
+            shared.vel_y = static_cast<float>(p.vel.y);
+            shared.speed = p.speed;
+            shared.radius = p.radius;
+        }
+
+        //histograms with fewer bins than the segment has room for are padded with zeros
+        size_t num_bins = header_->num_bins;
+        size_t num_histograms = std::min<size_t>(histograms.size(), header_->num_histograms);
+        for (size_t h = 0; h < num_histograms; ++h) {
+            float* x_values = bins_ + h * (2 * num_bins + 1);
+            float* bin_frequencies = x_values + num_bins + 1;
+            vector<float>& hist_x_values = histograms[h].GetXValues();
+            vector<float>& hist_frequencies = histograms[h].GetBinFrequencies();
+
+            size_t num_x_values = std::min(hist_x_values.size(), num_bins + 1);
+            std::copy(hist_x_values.begin(), hist_x_values.begin() + num_x_values, x_values);
+            std::fill(x_values + num_x_values, x_values + num_bins + 1, 0.0f);
+
+            size_t num_frequencies = std::min(hist_frequencies.size(), num_bins);
+            std::copy(hist_frequencies.begin(), hist_frequencies.begin() + num_frequencies, bin_frequencies);
+            std::fill(bin_frequencies + num_frequencies, bin_frequencies + num_bins, 0.0f);
+        }
+
+        header_->num_particles = static_cast<uint32_t>(num_particles);
+        header_->temperature = temperature;
+        header_->frame++;
+
+        //even again: the frame is complete
+        header_->sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    uint64_t StatePublisher::GetNumFrames() const { return header_->frame; }
+
+    StateReader::StateReader(const std::string& name) {
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) {
+            throw std::runtime_error("couldn't open shared memory " + name + ": " + strerror(errno));
+        }
+        struct stat info;
+        if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(SharedStateHeader)) {
+            close(fd);
+            throw std::runtime_error("shared memory " + name + " isn't a simulation state segment");
+        }
+        size_ = static_cast<size_t>(info.st_size);
+        memory_ = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (memory_ == MAP_FAILED) {
+            throw std::runtime_error("couldn't map shared memory " + name + ": " + strerror(errno));
+        }
+
+        header_ = static_cast<const SharedStateHeader*>(memory_);
+        if (header_->magic != kMagic || header_->version != kVersion ||
+            SegmentSize(header_->max_particles, header_->num_histograms, header_->num_bins) > size_) {
+            munmap(memory_, size_);
+            throw std::runtime_error("shared memory " + name + " isn't a simulation state segment");
+        }
+
+        particles_ = reinterpret_cast<const SharedParticle*>(static_cast<const char*>(memory_) + sizeof(SharedStateHeader));
+        bins_ = reinterpret_cast<const float*>(particles_ + header_->max_particles);
+    }
+
+    StateReader::~StateReader() {
+        munmap(memory_, size_);
+    }
+
+    bool StateReader::ReadFrame(StateFrame& frame, const size_t max_attempts) const {
+        size_t num_bins = header_->num_bins;
+        for (size_t attempt = 0; attempt < max_attempts; ++attempt) {
+            //a frame still being written uses up an attempt, like a torn copy
+            uint64_t sequence = 0;
+            if (!BeginRead(sequence, 1)) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            size_t num_particles = std::min(header_->num_particles, header_->max_particles);
+            frame.frame = header_->frame;
+            frame.temperature = header_->temperature;
+            frame.particles.assign(particles_, particles_ + num_particles);
+            frame.x_values.resize(header_->num_histograms);
+            frame.bin_frequencies.resize(header_->num_histograms);
+            for (size_t h = 0; h < header_->num_histograms; ++h) {
+                frame.x_values[h].assign(GetXValues(h), GetXValues(h) + num_bins + 1);
+                frame.bin_frequencies[h].assign(GetBinFrequencies(h), GetBinFrequencies(h) + num_bins);
+            }
+
+            //a torn copy is thrown away and read again
+            if (EndRead(sequence)) return true;
+        }
+        return false;
+    }
+
+    bool StateReader::BeginRead(uint64_t& sequence, const size_t max_attempts) const {
+        for (size_t attempt = 0; attempt < max_attempts; ++attempt) {
+            if (attempt > 0) std::this_thread::yield();
+            sequence = header_->sequence.load(std::memory_order_acquire);
+            if (sequence % 2 == 0) return true;
+        }
+        return false;
+    }
+
+    bool StateReader::EndRead(const uint64_t sequence) const {
+        //keeps the data reads before the second look at the sequence
+        std::atomic_thread_fence(std::memory_order_acquire);
+        return header_->sequence.load(std::memory_order_relaxed) == sequence;
+    }
+
+    const SharedStateHeader& StateReader::GetHeader() const { return *header_; }
+    const SharedParticle* StateReader::GetParticles() const { return particles_; }
+
+    const float* StateReader::GetXValues(const size_t histogram) const {
+        return bins_ + histogram * (2 * header_->num_bins + 1);
+    }
+
+    const float* StateReader::GetBinFrequencies(const size_t histogram) const {
+        return GetXValues(histogram) + header_->num_bins + 1;
+    }
+}
+#endif
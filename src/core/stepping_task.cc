@@ -0,0 +1,112 @@
+#include "core/stepping_task.h"
+#include <algorithm>
+
+namespace idealgas {
+    SteppingTask::SteppingTask(ParticleController& particle_controller, vector<Histogram>* histograms, const size_t slice_size)
+    : particle_controller_(particle_controller),
+      histograms_(histograms),
+      kSliceSize(std::max<size_t>(slice_size, 1)) {}
+
+    bool SteppingTask::Resume(const std::chrono::microseconds budget) {
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        StartResume();
+
+        //the clock is only read between pieces, so a call can overrun its budget by up to one piece; elapsed time
+        //is compared in microseconds so a budget as large as microseconds::max() can't overflow
+        do {
+            RunSlice();
+        } while (phase_ != StepPhase::kDone &&
+                 std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start) < budget);
+
+        if (phase_ == StepPhase::kDone) num_resumes_per_step_ = num_resumes_;
+        return phase_ == StepPhase::kDone;
+    }
+
+    void SteppingTask::RunToCompletion() {
+        StartResume();
+        while (phase_ != StepPhase::kDone) {
+            RunSlice();
+        }
+        num_resumes_per_step_ = num_resumes_;
+    }
+
+    void SteppingTask::StartResume() {
+        if (phase_ == StepPhase::kDone) {
+            phase_ = StepPhase::kStart;
+            num_resumes_ = 0;
+        }
+        num_resumes_++;
+    }
+
+    void SteppingTask::RunSlice() {
+        const vector<Particle>& particles = particle_controller_.GetParticles();
+        size_t slice_end = std::min(next_index_ + kSliceSize, particles.size());
+
+        switch (phase_) {
+            case StepPhase::kStart:
+                next_index_ = 0;
+                //a paused controller doesn't step, but its histograms are still brought up to date
+                if (particle_controller_.BeginStep()) {
+                    phase_ = particle_controller_.IsRebuildDue() ? StepPhase::kRebuild : StepPhase::kUpdateParticles;
+                } else {
+                    StartHistograms();
+                }
+                break;
+            case StepPhase::kRebuild:
+                particle_controller_.RebuildCandidateSearch();
+                phase_ = StepPhase::kUpdateParticles;
+                break;
+            case StepPhase::kUpdateParticles:
+                //stops early when a particle has moved far enough to need a rebuild before the rest
+                next_index_ = particle_controller_.UpdateParticleRange(next_index_, slice_end);
+                if (next_index_ >= particles.size()) {
+                    particle_controller_.EndStep();
+                    if (particle_controller_.IsReorderDue()) {
+                        phase_ = StepPhase::kReorder;
+                    } else {
+                        StartHistograms();
+                    }
+                } else if (particle_controller_.IsRebuildDue()) {
+                    phase_ = StepPhase::kRebuild;
+                }
+                break;
+            case StepPhase::kReorder:
+                particle_controller_.ReorderParticles();
+                StartHistograms();
+                break;
+            case StepPhase::kHistogramRanges:
+                reducer_.AddRangeSlice(*histograms_, particles, next_index_, slice_end);
+                next_index_ = slice_end;
+                if (next_index_ >= particles.size()) {
+                    reducer_.FinishRanges(*histograms_);
+                    next_index_ = 0;
+                    phase_ = StepPhase::kHistogramCounts;
+                }
+                break;
+            case StepPhase::kHistogramCounts:
+                reducer_.AddCountSlice(*histograms_, particles, next_index_, slice_end);
+                next_index_ = slice_end;
+                if (next_index_ >= particles.size()) {
+                    reducer_.FinishCounts(*histograms_);
+                    phase_ = StepPhase::kDone;
+                }
+                break;
+            case StepPhase::kDone:
+                break;
+        }
+    }
+
+    void SteppingTask::StartHistograms() {
+        next_index_ = 0;
+        if (histograms_ == nullptr) {
+            phase_ = StepPhase::kDone;
+            return;
+        }
+        reducer_.StartSlices(*histograms_);
+        phase_ = StepPhase::kHistogramRanges;
+    }
+
+    StepPhase SteppingTask::GetPhase() const { return phase_; }
+    bool SteppingTask::IsDone() const { return phase_ == StepPhase::kDone; }
+    size_t SteppingTask::GetNumResumesPerStep() const { return num_resumes_per_step_; }
+}
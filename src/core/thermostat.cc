@@ -0,0 +1,65 @@
+#include "core/thermostat.h"
+#include <algorithm>
+#include <cmath>
+
+namespace idealgas {
+    float Thermostat::BeginStep(const float) { return 1; }
+    bool Thermostat::ActsOnParticles() const { return false; }
+    void Thermostat::Apply(Particle&) {}
+    bool Thermostat::ReflectOffWall(Particle&, const glm::vec2&) { return false; }
+
+    VelocityRescaleThermostat::VelocityRescaleThermostat(const float target_temperature)
+    : kTargetTemperature(target_temperature) {}
+
+    float VelocityRescaleThermostat::BeginStep(const float temperature) {
+        //temperature is proportional to speed squared
+        return temperature > 0 ? sqrt(kTargetTemperature / temperature) : 1;
+    }
+
+    BerendsenThermostat::BerendsenThermostat(const float target_temperature, const float time_constant)
+    : kTargetTemperature(target_temperature),
+      kTimeConstant(std::max(time_constant, 1.0f)) {}
+
+    float BerendsenThermostat::BeginStep(const float temperature) {
+        if (temperature <= 0) return 1;
+        //lambda^2 = 1 + (dt / tau)(T0 / T - 1), with dt = 1 step
+        return sqrt(1 + (kTargetTemperature / temperature - 1) / kTimeConstant);
+    }
+
+    AndersenThermostat::AndersenThermostat(const float target_temperature, const float collision_probability, const uint32_t seed)
+    : kTargetTemperature(target_temperature),
+      kCollisionProbability(collision_probability),
+      random_engine_(seed),
+      uniform_(0, 1),
+      normal_(0, 1) {}
+
+    bool AndersenThermostat::ActsOnParticles() const { return true; }
+
+    void AndersenThermostat::Apply(Particle& p) {
+        if (uniform_(random_engine_) >= kCollisionProbability) return;
+
+        //each velocity component of a Maxwell-Boltzmann gas is normal with variance kT / m
+        float sigma = sqrt(kTargetTemperature / p.mass);
+        p.vel = glm::vec2(sigma * normal_(random_engine_), sigma * normal_(random_engine_));
+    }
+
+    ThermalWallThermostat::ThermalWallThermostat(const float wall_temperature, const uint32_t seed)
+    : kWallTemperature(wall_temperature),
+      random_engine_(seed),
+      uniform_(0, 1),
+      normal_(0, 1) {}
+
+    bool ThermalWallThermostat::ReflectOffWall(Particle& p, const glm::vec2& normal) {
+        float sigma = sqrt(kWallTemperature / p.mass);
+
+        //particles leaving a wall are weighted by how fast they leave, so the normal speed is Rayleigh distributed
+        //(1 - u is in (0, 1], so the log is finite)
+        float normal_speed = sigma * sqrt(-2 * log(1 - uniform_(random_engine_)));
+        float tangent_speed = sigma * normal_(random_engine_);
+
+        glm::vec2 tangent(-normal.y, normal.x);
+        p.vel = glm::vec2(normal.x * normal_speed + tangent.x * tangent_speed,
+                          normal.y * normal_speed + tangent.y * tangent_speed);
+        return true;
+    }
+}
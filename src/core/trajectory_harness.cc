@@ -0,0 +1,225 @@
+#include "core/trajectory_harness.h"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+
+namespace idealgas {
+    ControllerEngine::ControllerEngine(const vector<Particle>& particles, const float x_min, const float x_max, const float y_min, const float y_max)
+    : particle_controller_(particles, x_min, x_max, y_min, y_max) {
+        particle_controller_.SetInvariantMonitor(&invariant_monitor_);
+    }
+
+    void ControllerEngine::Step() {
+        particle_controller_.UpdateParticles();
+    }
+
+    const vector<Particle>& ControllerEngine::GetParticles() const {
+        return particle_controller_.GetParticles();
+    }
+
+    size_t ControllerEngine::GetNumCollisions() const {
+        return invariant_monitor_.GetNumCollisions();
+    }
+
+    ParticleController& ControllerEngine::GetController() {
+        return particle_controller_;
+    }
+
+    /* Helper function for an engine's state with particles sorted by id */
+    static TrajectoryFrame CaptureFrame(const TrajectoryEngine& engine, const uint64_t num_collisions) {
+        vector<const Particle*> sorted;
+        for (const Particle& p : engine.GetParticles()) {
+            sorted.push_back(&p);
+        }
+        std::sort(sorted.begin(), sorted.end(), [](const Particle* a, const Particle* b) { return a->id < b->id; });
+
+        TrajectoryFrame frame;
+        frame.num_collisions = num_collisions;
+        for (const Particle* p : sorted) {
+            frame.ids.push_back(p->id);
+            frame.positions.push_back(ToVec2(p->pos));
+            frame.velocities.push_back(glm::vec2(p->vel));
+        }
+        return frame;
+    }
+
+    GoldenTrajectory TrajectoryHarness::Record(TrajectoryEngine& engine, const size_t num_steps) {
+        GoldenTrajectory trajectory;
+        trajectory.frames.push_back(CaptureFrame(engine, 0));
+        for (size_t step = 0; step < num_steps; ++step) {
+            size_t collisions_before = engine.GetNumCollisions();
+            engine.Step();
+            trajectory.frames.push_back(CaptureFrame(engine, engine.GetNumCollisions() - collisions_before));
+        }
+        return trajectory;
+    }
+
+    TrajectoryHarness::TrajectoryHarness(const size_t num_bins)
+    : kNumBins(std::max<size_t>(num_bins, 1)) {}
+
+    TrajectoryReport TrajectoryHarness::Compare(TrajectoryEngine& reference, TrajectoryEngine& candidate, const size_t num_steps) const {
+        //stepped alternately rather than one run after the other, so engines sharing a resource see the same order
+        vector<TrajectoryFrame> reference_frames = {CaptureFrame(reference, 0)};
+        vector<TrajectoryFrame> candidate_frames = {CaptureFrame(candidate, 0)};
+        for (size_t step = 0; step < num_steps; ++step) {
+            size_t reference_before = reference.GetNumCollisions();
+            reference.Step();
+            reference_frames.push_back(CaptureFrame(reference, reference.GetNumCollisions() - reference_before));
+
+            size_t candidate_before = candidate.GetNumCollisions();
+            candidate.Step();
+            candidate_frames.push_back(CaptureFrame(candidate, candidate.GetNumCollisions() - candidate_before));
+        }
+        return CompareFrames(reference_frames, candidate_frames);
+    }
+
+    TrajectoryReport TrajectoryHarness::Compare(const GoldenTrajectory& golden, TrajectoryEngine& candidate) const {
+        size_t num_steps = golden.frames.empty() ? 0 : golden.frames.size() - 1;
+        return CompareFrames(golden.frames, Record(candidate, num_steps).frames);
+    }
+
+    TrajectoryReport TrajectoryHarness::CompareFrames(const vector<TrajectoryFrame>& reference, const vector<TrajectoryFrame>& candidate) const {
+        TrajectoryReport report;
+        for (size_t step = 0; step < std::min(reference.size(), candidate.size()); ++step) {
+            const TrajectoryFrame& ref = reference[step];
+            const TrajectoryFrame& cand = candidate[step];
+            if (ref.ids != cand.ids) {
+                report.are_particles_matched = false;
+                return report;
+            }
+
+            StepDivergence divergence = {step, 0, 0, static_cast<int64_t>(cand.num_collisions) - static_cast<int64_t>(ref.num_collisions), 0};
+            for (size_t i = 0; i < ref.positions.size(); ++i) {
+                divergence.max_position_error = std::max(divergence.max_position_error, glm::length(cand.positions[i] - ref.positions[i]));
+                divergence.max_velocity_error = std::max(divergence.max_velocity_error, glm::length(cand.velocities[i] - ref.velocities[i]));
+            }
+            divergence.max_histogram_delta = HistogramDelta(ref, cand);
+
+            report.max_position_error = std::max(report.max_position_error, divergence.max_position_error);
+            report.max_velocity_error = std::max(report.max_velocity_error, divergence.max_velocity_error);
+            report.total_collision_difference += divergence.collision_difference;
+            report.max_histogram_delta = std::max(report.max_histogram_delta, divergence.max_histogram_delta);
+            report.steps.push_back(divergence);
+        }
+        return report;
+    }
+
+    float TrajectoryHarness::HistogramDelta(const TrajectoryFrame& reference, const TrajectoryFrame& candidate) const {
+        if (reference.velocities.empty()) return 0;
+
+        //same bins for both frames, so counts can be compared bin by bin
+        float max_speed = 0;
+        for (size_t i = 0; i < reference.velocities.size(); ++i) {
+            max_speed = std::max(max_speed, std::max(glm::length(reference.velocities[i]), glm::length(candidate.velocities[i])));
+        }
+        if (max_speed == 0) return 0;
+
+        vector<int> count_difference(kNumBins, 0);
+        for (size_t i = 0; i < reference.velocities.size(); ++i) {
+            count_difference[std::min(static_cast<size_t>(glm::length(reference.velocities[i]) / max_speed * kNumBins), kNumBins - 1)]--;
+            count_difference[std::min(static_cast<size_t>(glm::length(candidate.velocities[i]) / max_speed * kNumBins), kNumBins - 1)]++;
+        }
+
+        int max_difference = 0;
+        for (int difference : count_difference) {
+            max_difference = std::max(max_difference, std::abs(difference));
+        }
+        return static_cast<float>(max_difference) / reference.velocities.size();
+    }
+
+    size_t TrajectoryReport::FirstDivergentStep(const float position_tolerance) const {
+        for (size_t i = 0; i < steps.size(); ++i) {
+            if (steps[i].max_position_error > position_tolerance) return i;
+        }
+        return steps.size();
+    }
+
+    static const char kTrajectoryMagic[4] = {'I', 'G', 'T', 'R'};
+    static const uint32_t kTrajectoryVersion = 2;
+
+    void GoldenTrajectory::Save(const std::string& path) const {
+        std::ofstream out(path, std::ios::binary);
+        if (!out) {
+            throw std::runtime_error("couldn't open trajectory " + path + " for writing");
+        }
+
+        uint64_t num_frames = frames.size();
+        uint64_t num_particles = frames.empty() ? 0 : frames[0].ids.size();
+        out.write(kTrajectoryMagic, sizeof(kTrajectoryMagic));
+        out.write(reinterpret_cast<const char*>(&kTrajectoryVersion), sizeof(kTrajectoryVersion));
+        out.write(reinterpret_cast<const char*>(&num_frames), sizeof(num_frames));
+        out.write(reinterpret_cast<const char*>(&num_particles), sizeof(num_particles));
+
+        //x and y of every position, then of every velocity, written as plain floats
+        vector<float> values(4 * num_particles);
+        for (const TrajectoryFrame& frame : frames) {
+            if (frame.ids.size() != num_particles || frame.positions.size() != num_particles || frame.velocities.size() != num_particles) {
+                throw std::runtime_error("every frame of a trajectory needs the same number of particles");
+            }
+            for (size_t i = 0; i < num_particles; ++i) {
+                values[2 * i] = frame.positions[i].x;
+                values[2 * i + 1] = frame.positions[i].y;
+                values[2 * (num_particles + i)] = frame.velocities[i].x;
+                values[2 * (num_particles + i) + 1] = frame.velocities[i].y;
+            }
+            out.write(reinterpret_cast<const char*>(&frame.num_collisions), sizeof(frame.num_collisions));
+            out.write(reinterpret_cast<const char*>(frame.ids.data()), num_particles * sizeof(uint32_t));
+            out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(float));
+        }
+
+        if (!out) {
+            throw std::runtime_error("couldn't write trajectory " + path);
+        }
+    }
+
+    GoldenTrajectory GoldenTrajectory::Load(const std::string& path) {
+        std::ifstream in(path, std::ios::binary);
+        if (!in) {
+            throw std::runtime_error("couldn't open trajectory " + path);
+        }
+
+        char magic[4];
+        uint32_t version = 0;
+        uint64_t num_frames = 0;
+        uint64_t num_particles = 0;
+        in.read(magic, sizeof(magic));
+        in.read(reinterpret_cast<char*>(&version), sizeof(version));
+        in.read(reinterpret_cast<char*>(&num_frames), sizeof(num_frames));
+        in.read(reinterpret_cast<char*>(&num_particles), sizeof(num_particles));
+        if (!in || !std::equal(magic, magic + 4, kTrajectoryMagic) || version != kTrajectoryVersion) {
+            throw std::runtime_error(path + " isn't a golden trajectory");
+        }
+
+        //corrupt counts could ask for any amount of memory, so they're checked against what the file holds first;
+        //each frame is a collision count, then an id and 4 floats per particle
+        std::streampos frames_start = in.tellg();
+        in.seekg(0, std::ios::end);
+        uint64_t num_frame_bytes = static_cast<uint64_t>(in.tellg() - frames_start);
+        in.seekg(frames_start);
+        const uint64_t kParticleBytes = sizeof(uint32_t) + 4 * sizeof(float);
+        if (!in || num_particles > num_frame_bytes / kParticleBytes ||
+            num_frames > num_frame_bytes / (sizeof(uint64_t) + num_particles * kParticleBytes)) {
+            throw std::runtime_error("trajectory " + path + " is truncated");
+        }
+
+        GoldenTrajectory trajectory;
+        vector<float> values(4 * num_particles);
+        for (uint64_t f = 0; f < num_frames; ++f) {
+            TrajectoryFrame frame;
+            frame.ids.resize(num_particles);
+            in.read(reinterpret_cast<char*>(&frame.num_collisions), sizeof(frame.num_collisions));
+            in.read(reinterpret_cast<char*>(frame.ids.data()), num_particles * sizeof(uint32_t));
+            in.read(reinterpret_cast<char*>(values.data()), values.size() * sizeof(float));
+            if (!in) {
+                throw std::runtime_error("trajectory " + path + " is truncated");
+            }
+            for (size_t i = 0; i < num_particles; ++i) {
+                frame.positions.push_back(glm::vec2(values[2 * i], values[2 * i + 1]));
+                frame.velocities.push_back(glm::vec2(values[2 * (num_particles + i)], values[2 * (num_particles + i) + 1]));
+            }
+            trajectory.frames.push_back(frame);
+        }
+        return trajectory;
+    }
+}
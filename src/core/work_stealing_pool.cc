@@ -0,0 +1,81 @@
+#include "core/work_stealing_pool.h"
+#include <algorithm>
+#include <exception>
+#include <thread>
+
+namespace idealgas {
+    WorkStealingPool::WorkStealingPool(const size_t num_threads)
+    : kNumThreads(num_threads > 0 ? num_threads : std::max<size_t>(std::thread::hardware_concurrency(), 1)) {}
+
+    void WorkStealingPool::Run(const vector<std::function<void(size_t thread_index)>>& tasks) {
+        size_t num_threads = std::max<size_t>(std::min(kNumThreads, tasks.size()), 1);
+
+        //contiguous blocks, so each thread starts on tasks next to each other
+        vector<WorkQueue> queues(num_threads);
+        size_t block_size = (tasks.size() + num_threads - 1) / num_threads;
+        for (size_t i = 0; i < tasks.size(); ++i) {
+            queues[i / std::max<size_t>(block_size, 1)].tasks.push_back(i);
+        }
+
+        std::mutex error_mutex;
+        std::exception_ptr first_error;
+        vector<size_t> steals_per_thread(num_threads, 0);
+
+        auto work = [&](size_t thread_index) {
+            size_t task;
+            while (NextTask(queues, thread_index, task, steals_per_thread[thread_index])) {
+                try {
+                    tasks[task](thread_index);
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(error_mutex);
+                    if (!first_error) first_error = std::current_exception();
+                }
+            }
+        };
+
+        //the calling thread works too, like ParallelFor
+        vector<std::thread> threads;
+        for (size_t i = 1; i < num_threads; ++i) {
+            threads.push_back(std::thread(work, i));
+        }
+        work(0);
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        num_steals_ = 0;
+        for (size_t num_steals : steals_per_thread) {
+            num_steals_ += num_steals;
+        }
+
+        if (first_error) std::rethrow_exception(first_error);
+    }
+
+    bool WorkStealingPool::NextTask(vector<WorkQueue>& queues, const size_t thread_index, size_t& task, size_t& num_steals) {
+        {
+            WorkQueue& own = queues[thread_index];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = own.tasks.front();
+                own.tasks.pop_front();
+                return true;
+            }
+        }
+
+        //no new tasks are ever added, so once every queue has been seen empty the thread is done
+        for (size_t offset = 1; offset < queues.size(); ++offset) {
+            WorkQueue& victim = queues[(thread_index + offset) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty()) {
+                task = victim.tasks.back();
+                victim.tasks.pop_back();
+                num_steals++;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    size_t WorkStealingPool::GetNumThreads() const { return kNumThreads; }
+    size_t WorkStealingPool::GetNumSteals() const { return num_steals_; }
+}
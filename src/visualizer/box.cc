@@ -1,13 +1,18 @@
 #include "visualizer/box.h"
+#include "cinder/app/App.h"
+#include <algorithm>
 
 using namespace ci;
 
 namespace idealgas {
-    Box::Box(const size_t width, const glm::vec2& top_left, const float border_width, ParticleController& particle_controller)
+    Box::Box(const size_t width, const glm::vec2& top_left, const float border_width, ParticleController& particle_controller,
+             const size_t density_threshold)
     : kBoxWidth(width),
       kBoxTopLeft(top_left),
       kBoxBorderWidth(border_width),
-      particle_controller_(particle_controller) {}
+      particle_controller_(particle_controller),
+      kDensityThreshold(density_threshold),
+      density_field_(width, width) {}
 
     void Box::UpdateBox() {
         // updates positions and velocities of all particles before re-drawing
@@ -15,8 +20,37 @@ namespace idealgas {
     }
 
     void Box::DrawBox() {
+        //particles go first so the border covers any drawn past the walls when zoomed in
+        //counted rather than estimated from the zoom, so zooming in on a dense corner still draws a density field
+        Rectf view = GetView();
+        size_t num_in_view = DensityField::CountInView(particle_controller_.GetParticles(), view.x1, view.x2, view.y1, view.y2,
+                                                       kDensityThreshold);
+        if (num_in_view > kDensityThreshold) {
+            DrawDensityField();
+        } else {
+            DrawParticles();
+        }
         DrawBorder();
-        DrawParticles();
+        DrawPiston();
+    }
+
+    void Box::SetZoom(const float zoom) {
+        zoom_ = std::max(1.0f, std::min(zoom, kMaxZoom));
+    }
+
+    float Box::GetZoom() const {
+        return zoom_;
+    }
+
+    Rectf Box::GetView() const {
+        glm::vec2 center = kBoxTopLeft + glm::vec2(kBoxWidth / 2.0f, kBoxWidth / 2.0f);
+        float half_view = kBoxWidth / 2.0f / zoom_;
+        return Rectf(center.x - half_view, center.y - half_view, center.x + half_view, center.y + half_view);
+    }
+
+    glm::vec2 Box::ToScreen(const glm::vec2& point) const {
+        glm::vec2 center = kBoxTopLeft + glm::vec2(kBoxWidth / 2.0f, kBoxWidth / 2.0f);
+        return center + (point - center) * zoom_;
     }
     
     void Box::DrawBorder() {
@@ -26,9 +60,44 @@ namespace idealgas {
     }
     
     void Box::DrawParticles() {
+        //scissor is in window pixels from the bottom left, and keeps zoomed in particles inside the box
+        gl::ScopedScissor scissor(glm::ivec2(kBoxTopLeft.x, app::getWindowHeight() - (kBoxTopLeft.y + kBoxWidth)),
+                                  glm::ivec2(kBoxWidth, kBoxWidth));
+        Rectf view(kBoxTopLeft.x, kBoxTopLeft.y, kBoxTopLeft.x + kBoxWidth, kBoxTopLeft.y + kBoxWidth);
         for (Particle& p : particle_controller_.GetParticles()) {
+            glm::vec2 center = ToScreen(ToVec2(p.pos));
+            float radius = p.radius * zoom_;
+            if (center.x + radius < view.x1 || center.x - radius > view.x2 || center.y + radius < view.y1 || center.y - radius > view.y2) continue;
             gl::color(p.color);
-            gl::drawSolidCircle(p.pos, p.radius);
+            gl::drawSolidCircle(center, radius);
+        }
+    }
+
+    void Box::DrawDensityField() {
+        //the part of the box in view, one texel per pixel of the box
+        Rectf view = GetView();
+        density_field_.Splat(particle_controller_.GetParticles(), view.x1, view.x2, view.y1, view.y2);
+
+        //the surface only wraps the field's pixels, they're copied once, straight into the texture
+        Surface8u surface(const_cast<uint8_t*>(density_field_.GetPixels().data()), static_cast<int32_t>(density_field_.GetWidth()),
+                          static_cast<int32_t>(density_field_.GetHeight()), 4 * density_field_.GetWidth(), SurfaceChannelOrder::RGBA);
+        if (density_texture_) {
+            density_texture_->update(surface);
+        } else {
+            density_texture_ = gl::Texture2d::create(surface);
         }
+
+        gl::color(Colorf(1, 1, 1));
+        gl::draw(density_texture_, Rectf(kBoxTopLeft.x, kBoxTopLeft.y, kBoxTopLeft.x + kBoxWidth, kBoxTopLeft.y + kBoxWidth));
+    }
+    
+    void Box::DrawPiston() {
+        //fills the space between the right wall of the box and where the piston has been moved to
+        float piston_x = std::max(ToScreen(glm::vec2(particle_controller_.GetXMax(), 0)).x, kBoxTopLeft.x);
+        float inner_right = kBoxTopLeft.x + kBoxWidth - kBoxBorderWidth / 2;
+        if (piston_x >= inner_right) return;
+        
+        gl::color(Colorf(0.5f, 0.5f, 0.5f));
+        gl::drawSolidRect(Rectf(piston_x, kBoxTopLeft.y, inner_right, kBoxTopLeft.y + kBoxWidth));
     }
 }
\ No newline at end of file
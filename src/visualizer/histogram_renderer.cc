@@ -0,0 +1,145 @@
+#include "visualizer/histogram_renderer.h"
+#include <sstream>
+
+using namespace ci;
+
+namespace idealgas {
+    HistogramRenderer::HistogramRenderer(const size_t width, const size_t height, const Colorf& color, const size_t num_bins)
+    : kWidth(static_cast<float>(width)),
+      kHeight(static_cast<float>(height)),
+      kColor(color),
+      kNumBins(num_bins),
+      title_font_("Roboto", 23),
+      label_font_("Roboto", 20) {}
+
+    void HistogramRenderer::Draw(Histogram& hist, MaxwellBoltzmannFit& fit, const glm::vec2& top_left) {
+        if (!static_layer_) {
+            BakeStaticLayer();
+            MakeMeshes();
+        }
+        UpdateBars(hist.GetBinFrequencies());
+        UpdateFit(fit.GetLastFit().expected_frequencies);
+
+        gl::ScopedBlendAlpha blend;
+        gl::color(Colorf(1, 1, 1));
+        gl::draw(static_layer_->getColorTexture(), Rectf(top_left.x - kPadLeft, top_left.y - kPadTop,
+                                                         top_left.x + kWidth + kPadRight, top_left.y + kHeight + kPadBottom));
+
+        DrawText(fit.IsEquilibrated() ? "Distribution of Speeds (MB)" : "Distribution of Speeds", title_font_,
+                 glm::vec2(top_left.x + kWidth / 2, top_left.y - 22));
+
+        //labels are spaced so 9 bins fit in the histogram, with more bins only some edges are labelled
+        vector<float>& x_values = hist.GetXValues();
+        size_t label_stride = (hist.GetNumBins() + 8) / 9;
+        float label_spacing = (kWidth - 27.0f) / hist.GetNumBins() * label_stride;
+        std::stringstream ss;
+        ss.precision(2);
+        for (size_t i = 0; i < x_values.size(); i += label_stride) {
+            ss.str(std::string());
+            ss << std::fixed << x_values[i];
+            DrawText(ss.str(), label_font_, glm::vec2(top_left.x + 12 + (i / label_stride) * label_spacing, top_left.y + kHeight + 3));
+        }
+
+        gl::ScopedModelMatrix model;
+        gl::translate(top_left);
+        gl::color(kColor);
+        bars_batch_->draw();
+        if (!drawn_fit_.empty()) {
+            gl::color(Colorf(1, 1, 1));
+            fit_batch_->draw();
+        }
+    }
+
+    void HistogramRenderer::BakeStaticLayer() {
+        static_layer_ = gl::Fbo::create(static_cast<int>(kPadLeft + kWidth + kPadRight), static_cast<int>(kPadTop + kHeight + kPadBottom),
+                                        gl::Fbo::Format().samples(4));
+        gl::ScopedFramebuffer framebuffer(static_layer_);
+        gl::ScopedViewport viewport(glm::ivec2(0), static_layer_->getSize());
+        gl::ScopedMatrices matrices;
+        gl::setMatricesWindow(static_layer_->getSize());
+        gl::clear(ColorA(0, 0, 0, 0));
+
+        //everything below is relative to the histogram's top left, which sits kPadLeft, kPadTop into the texture
+        gl::translate(kPadLeft, kPadTop);
+        gl::color(kColor);
+        gl::drawStrokedRect(Rectf(0, 0, kWidth, kHeight), 1);
+        gl::drawSolidCircle(glm::vec2(102, -14), 7);
+        gl::drawSolidCircle(glm::vec2(kWidth - 102, -14), 7);
+
+        gl::drawStringCentered("Speed (px/frame)", glm::vec2(kWidth / 2, kHeight + 22), Colorf(1, 1, 1), label_font_);
+
+        gl::pushModelMatrix();
+        gl::translate(-55, kHeight / 2);
+        gl::rotate(-1.57f);
+        gl::drawStringCentered("Frequency (%)", glm::vec2(0, 0), Colorf(1, 1, 1), label_font_);
+        gl::popModelMatrix();
+
+        float label_y = kHeight - 12;
+        for (int percent = 0; percent <= 100; percent += 10) {
+            gl::drawStringCentered(std::to_string(percent), glm::vec2(-15, label_y), Colorf(1, 1, 1), label_font_);
+            label_y -= 20;
+        }
+    }
+
+    void HistogramRenderer::MakeMeshes() {
+        //bar vertices are rewritten when the bins change, the triangles joining them never change
+        vector<uint16_t> indices;
+        for (size_t bar = 0; bar < kNumBins; ++bar) {
+            uint16_t first = static_cast<uint16_t>(4 * bar);
+            indices.insert(indices.end(), {first, static_cast<uint16_t>(first + 1), static_cast<uint16_t>(first + 2),
+                                           first, static_cast<uint16_t>(first + 2), static_cast<uint16_t>(first + 3)});
+        }
+        gl::VboMesh::Layout layout = gl::VboMesh::Layout().usage(GL_DYNAMIC_DRAW).attrib(geom::POSITION, 2);
+        bars_mesh_ = gl::VboMesh::create(static_cast<uint32_t>(4 * kNumBins), GL_TRIANGLES, {layout},
+                                         static_cast<uint32_t>(indices.size()), GL_UNSIGNED_SHORT);
+        bars_mesh_->bufferIndices(indices.size() * sizeof(uint16_t), indices.data());
+        fit_mesh_ = gl::VboMesh::create(static_cast<uint32_t>(kNumBins), GL_LINE_STRIP, {layout});
+
+        //the stock shader without vertex colors draws in the current gl::color
+        gl::GlslProgRef shader = gl::getStockShader(gl::ShaderDef());
+        bars_batch_ = gl::Batch::create(bars_mesh_, shader);
+        fit_batch_ = gl::Batch::create(fit_mesh_, shader);
+    }
+
+    void HistogramRenderer::UpdateBars(const vector<float>& frequencies) {
+        if (frequencies == drawn_frequencies_ || frequencies.size() != kNumBins) return;
+        drawn_frequencies_ = frequencies;
+
+        //y decreases as you go "up", so a bar's top is the bottom of the histogram minus its frequency * height
+        float bar_width = kWidth / kNumBins;
+        vector<glm::vec2> vertices;
+        for (size_t bar = 0; bar < kNumBins; ++bar) {
+            float left = bar * bar_width;
+            float top = kHeight - frequencies[bar] * kHeight;
+            vertices.insert(vertices.end(), {glm::vec2(left, top), glm::vec2(left + bar_width, top),
+                                             glm::vec2(left + bar_width, kHeight), glm::vec2(left, kHeight)});
+        }
+        bars_mesh_->bufferAttrib(geom::POSITION, vertices.size() * sizeof(glm::vec2), vertices.data());
+    }
+
+    void HistogramRenderer::UpdateFit(const vector<float>& expected_frequencies) {
+        if (expected_frequencies == drawn_fit_ || expected_frequencies.size() != kNumBins) return;
+        drawn_fit_ = expected_frequencies;
+
+        float bar_width = kWidth / kNumBins;
+        vector<glm::vec2> vertices;
+        for (size_t bar = 0; bar < kNumBins; ++bar) {
+            vertices.push_back(glm::vec2((bar + 0.5f) * bar_width, kHeight - expected_frequencies[bar] * kHeight));
+        }
+        fit_mesh_->bufferAttrib(geom::POSITION, vertices.size() * sizeof(glm::vec2), vertices.data());
+    }
+
+    void HistogramRenderer::DrawText(const std::string& text, const Font& font, const glm::vec2& center_top) {
+        std::string key = std::to_string(font.getSize()) + ":" + text;
+        std::map<std::string, gl::Texture2dRef>::iterator cached = text_textures_.find(key);
+        if (cached == text_textures_.end()) {
+            if (text_textures_.size() >= kMaxCachedLabels) {
+                text_textures_.clear();
+            }
+            cached = text_textures_.insert(std::make_pair(key, gl::Texture2d::create(renderString(text, font, ColorA(1, 1, 1, 1))))).first;
+        }
+
+        gl::Texture2dRef texture = cached->second;
+        gl::draw(texture, glm::vec2(center_top.x - texture->getWidth() / 2.0f, center_top.y));
+    }
+}
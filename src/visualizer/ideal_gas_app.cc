@@ -1,15 +1,32 @@
 #include "visualizer/ideal_gas_app.h"
+#include <algorithm>
+#include <cstdlib>
 
 namespace idealgas {
     //initializes particle_controller_ and box_; reference to particle_controller_ gets passed to box_
     IdealGasApp::IdealGasApp()
-    : particle_controller_(kBoxWidth, kBoxTopLeft, kBoxBorderWidth - 10),
+    : particle_controller_(kBoxWidth, kBoxTopLeft, kBoxBorderWidth - 10, kPlacementStrategy),
       box_(kBoxWidth, kBoxTopLeft, kBoxBorderWidth, particle_controller_),
-      histograms_(kNumHists, kHistWidth, kHistHeight, kHistTopLeft, particle_controller_) {}
+      histograms_(kNumHists, kHistWidth, kHistHeight, kHistTopLeft, particle_controller_, kBinningStrategy, kNumBins) {
+        //the species' radii differ 3x, so each one gets a grid level of its own
+        particle_controller_.SetHierarchicalGrid(true);
+#ifndef _WIN32
+        const char* shm_name = std::getenv("IDEALGAS_SHM_NAME");
+        if (shm_name != nullptr) {
+            state_publisher_.reset(new StatePublisher(shm_name, kMaxPublishedParticles, kNumHists, kNumBins));
+        }
+#endif
+    }
     
     void IdealGasApp::update() {
         box_.UpdateBox();
         histograms_.UpdateHistograms();
+#ifndef _WIN32
+        //published between steps, so the update itself never waits on the export
+        if (state_publisher_) {
+            state_publisher_->Publish(particle_controller_.GetParticles(), histograms_.GetHistograms(), particle_controller_.GetTemperature());
+        }
+#endif
     }
 
     void IdealGasApp::draw() {
@@ -21,14 +38,37 @@ namespace idealgas {
     }
 
     void IdealGasApp::keyDown(KeyEvent event) {
+        //commands are applied by the simulation at the start of its next step, spread over kRampSteps frames
         switch(event.getCode()) {
             case KeyEvent::KEY_1:
-                //1 clicked, so should_speed_up is true
-                particle_controller_.ChangeSpeeds(true);
+                //1 clicked, so heat up (speed up)
+                particle_controller_.EnqueueCommand(SimulationCommand::TemperatureRamp(kTemperatureChange, kRampSteps));
                 break;
             case KeyEvent::KEY_0:
-                //0 clicked, so should_speed_up is false (speed down)
-                particle_controller_.ChangeSpeeds(false);
+                //0 clicked, so cool down (speed down)
+                particle_controller_.EnqueueCommand(SimulationCommand::TemperatureRamp(1 / kTemperatureChange, kRampSteps));
+                break;
+            case KeyEvent::KEY_LEFT:
+                //compress the gas with the piston
+                particle_controller_.EnqueueCommand(SimulationCommand::MoveWall(particle_controller_.GetXMax() - kPistonMove, kRampSteps));
+                break;
+            case KeyEvent::KEY_RIGHT:
+                //expand the gas, the piston can't go past the box
+                particle_controller_.EnqueueCommand(SimulationCommand::MoveWall(
+                        std::min(particle_controller_.GetXMax() + kPistonMove, kBoxTopLeft.x + kBoxWidth - (kBoxBorderWidth - 10)), kRampSteps));
+                break;
+            case KeyEvent::KEY_p:
+                particle_controller_.EnqueueCommand(particle_controller_.IsPaused() ? SimulationCommand::Resume() : SimulationCommand::Pause());
+                break;
+            case KeyEvent::KEY_s:
+                particle_controller_.EnqueueCommand(SimulationCommand::SingleStep());
+                break;
+            case KeyEvent::KEY_EQUALS:
+                //zoom in; with many particles in view they're drawn as a density field
+                box_.SetZoom(box_.GetZoom() * kZoomChange);
+                break;
+            case KeyEvent::KEY_MINUS:
+                box_.SetZoom(box_.GetZoom() / kZoomChange);
                 break;
         }
     }
@@ -42,7 +82,7 @@ namespace idealgas {
     
     void IdealGasApp::DrawSpeedInfo() {
         Font speed_note_font("Roboto", 32);
-        gl::drawStringCentered("Press 1 to speed up the particles or 0 to slow them down.",
+        gl::drawStringCentered("Press 1 / 0 to heat / cool, arrows to move the piston, P to pause, S to step, +/- to zoom.",
                                glm::vec2(kBoxTopLeft.x + kBoxWidth / 2, getWindowHeight() - 59),
                                Colorf(1, 1, 1), speed_note_font);
 
@@ -0,0 +1,200 @@
+/* - C program (no C++ in the caller) driving libidealgas through include/capi/idealgas.h
+   - A box of 2 species is stepped, read through views into the library's storage, and checked against the
+     invariants of the simulation; then every error path is hit once
+   - Exits non-zero if any check failed, so it can run as a test target */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "capi/idealgas.h"
+
+static int num_failures = 0;
+
+#define CHECK(condition)                                                           \
+    do {                                                                           \
+        if (!(condition)) {                                                        \
+            fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition); \
+            num_failures++;                                                        \
+        }                                                                          \
+    } while (0)
+
+/* Component c of element i of a view, as a double whatever the library's precision */
+static double ViewComponent(const idealgas_view* view, size_t i, size_t c) {
+    const char* element = (const char*)view->data + i * view->stride;
+    switch (view->type) {
+        case IDEALGAS_FLOAT32: {
+            float value;
+            memcpy(&value, element + c * sizeof(float), sizeof(float));
+            return value;
+        }
+        case IDEALGAS_FLOAT64: {
+            double value;
+            memcpy(&value, element + c * sizeof(double), sizeof(double));
+            return value;
+        }
+        case IDEALGAS_FIXED32: {
+            int32_t raw;
+            memcpy(&raw, element + c * sizeof(int32_t), sizeof(int32_t));
+            return ldexp((double)raw, -view->fraction_bits);
+        }
+        case IDEALGAS_UINT32: {
+            uint32_t value;
+            memcpy(&value, element + c * sizeof(uint32_t), sizeof(uint32_t));
+            return value;
+        }
+        case IDEALGAS_SIZE_T: {
+            size_t value;
+            memcpy(&value, element + c * sizeof(size_t), sizeof(size_t));
+            return (double)value;
+        }
+    }
+    return 0;
+}
+
+static void TestSteppedBox(void) {
+    const float kWidth = 400;
+    const float kHeight = 300;
+    idealgas_box* box = idealgas_box_create(kWidth, kHeight, 8, 7);
+    idealgas_view positions;
+    idealgas_view velocities;
+    idealgas_view ids;
+    idealgas_view types;
+    const float* speeds;
+    const float* frequencies;
+    size_t num_bins;
+    size_t species;
+    size_t i;
+
+    CHECK(box != NULL);
+    CHECK(idealgas_box_add_species(box, 1, 2, 300, 2) == IDEALGAS_OK);
+    CHECK(idealgas_box_add_species(box, 5, 6, 50, 1) == IDEALGAS_OK);
+    CHECK(idealgas_box_num_particles(box) == 0);
+
+    //views of a box without particles are empty, not errors
+    CHECK(idealgas_box_positions(box, &positions) == IDEALGAS_OK);
+    CHECK(positions.data == NULL && positions.count == 0);
+
+    CHECK(idealgas_box_step(box, 0) == IDEALGAS_OK);
+    CHECK(idealgas_box_num_particles(box) == 350);
+    CHECK(idealgas_box_step(box, 20) == IDEALGAS_OK);
+    CHECK(idealgas_box_temperature(box) > 0);
+
+    CHECK(idealgas_box_positions(box, &positions) == IDEALGAS_OK);
+    CHECK(idealgas_box_velocities(box, &velocities) == IDEALGAS_OK);
+    CHECK(idealgas_box_ids(box, &ids) == IDEALGAS_OK);
+    CHECK(idealgas_box_types(box, &types) == IDEALGAS_OK);
+    CHECK(positions.count == 350 && velocities.count == 350 && ids.count == 350 && types.count == 350);
+    CHECK(positions.num_components == 2 && velocities.num_components == 2 && ids.num_components == 1);
+    CHECK(ids.type == IDEALGAS_UINT32 && types.type == IDEALGAS_SIZE_T);
+
+    //views point into one array of particles, so they share its stride and are never copies
+    CHECK(positions.stride == ids.stride && velocities.stride == ids.stride);
+
+    {
+        int seen[350] = {0};
+        size_t num_per_type[3] = {0, 0, 0};
+        for (i = 0; i < positions.count; ++i) {
+            double x = ViewComponent(&positions, i, 0);
+            double y = ViewComponent(&positions, i, 1);
+            double id = ViewComponent(&ids, i, 0);
+            double type = ViewComponent(&types, i, 0);
+            CHECK(x >= 0 && x <= kWidth && y >= 0 && y <= kHeight);
+            CHECK(isfinite(ViewComponent(&velocities, i, 0)) && isfinite(ViewComponent(&velocities, i, 1)));
+            CHECK(id >= 0 && id < 350 && !seen[(size_t)id]);
+            CHECK(type == 1 || type == 2);
+            if (id >= 0 && id < 350) seen[(size_t)id] = 1;
+            if (type == 1 || type == 2) num_per_type[(size_t)type]++;
+        }
+        CHECK(num_per_type[1] == 300 && num_per_type[2] == 50);
+    }
+
+    for (species = 0; species < 2; ++species) {
+        double total_frequency = 0;
+        CHECK(idealgas_box_histogram(box, species, &speeds, &frequencies, &num_bins) == IDEALGAS_OK);
+        CHECK(num_bins == 8);
+        for (i = 0; i < num_bins; ++i) {
+            CHECK(speeds[i] <= speeds[i + 1]);
+            total_frequency += frequencies[i];
+        }
+        CHECK(fabs(total_frequency - 1) < 1e-4);
+    }
+
+    idealgas_box_destroy(box);
+}
+
+static void TestEquilibration(void) {
+    idealgas_box* box = idealgas_box_create(200, 200, 6, 3);
+    size_t num_steps = 1;
+
+    CHECK(idealgas_box_add_species(box, 1, 2, 40, 2) == IDEALGAS_OK);
+    CHECK(idealgas_box_add_species(box, 5, 3, 20, 1) == IDEALGAS_OK);
+    CHECK(idealgas_box_is_equilibrated(box) == 0);
+    CHECK(idealgas_box_step_until_equilibrated(box, 5000, 0, &num_steps) == IDEALGAS_INVALID_ARGUMENT);
+    CHECK(num_steps == 0);
+
+    //30 passing fits in a row are needed, so the earliest possible stop is after 60 steps
+    CHECK(idealgas_box_step_until_equilibrated(box, 5000, 2, &num_steps) == IDEALGAS_OK);
+    CHECK(idealgas_box_is_equilibrated(box) == 1);
+    CHECK(num_steps >= 60 && num_steps < 5000 && num_steps % 2 == 0);
+
+    //an equilibrated box stops straight away
+    CHECK(idealgas_box_step_until_equilibrated(box, 5000, 2, &num_steps) == IDEALGAS_OK);
+    CHECK(num_steps == 0);
+    idealgas_box_destroy(box);
+}
+
+static void TestErrors(void) {
+    idealgas_box* box;
+    idealgas_view view;
+    const float* speeds;
+    const float* frequencies;
+    size_t num_bins;
+
+    CHECK(idealgas_api_version() == IDEALGAS_API_VERSION);
+
+    CHECK(idealgas_box_create(0, 100, 8, 0) == NULL);
+    CHECK(strlen(idealgas_last_error()) > 0);
+    CHECK(idealgas_box_create(100, 100, 0, 0) == NULL);
+
+    box = idealgas_box_create(100, 100, 4, 0);
+    CHECK(box != NULL);
+    CHECK(strlen(idealgas_last_error()) == 0);
+    CHECK(idealgas_box_step(box, 1) == IDEALGAS_INVALID_STATE);
+    CHECK(idealgas_box_histogram(box, 0, &speeds, &frequencies, &num_bins) == IDEALGAS_INVALID_STATE);
+    CHECK(idealgas_box_add_species(box, -1, 2, 10, 1) == IDEALGAS_INVALID_ARGUMENT);
+    CHECK(idealgas_box_add_species(box, 1, 2, 0, 1) == IDEALGAS_INVALID_ARGUMENT);
+    CHECK(idealgas_box_add_species(NULL, 1, 2, 10, 1) == IDEALGAS_INVALID_ARGUMENT);
+    CHECK(idealgas_box_positions(box, NULL) == IDEALGAS_INVALID_ARGUMENT);
+    CHECK(idealgas_box_positions(NULL, &view) == IDEALGAS_INVALID_ARGUMENT);
+
+    CHECK(idealgas_box_add_species(box, 1, 2, 10, 1) == IDEALGAS_OK);
+    CHECK(idealgas_box_step(box, 1) == IDEALGAS_OK);
+    CHECK(idealgas_box_add_species(box, 1, 2, 10, 1) == IDEALGAS_INVALID_STATE);
+    CHECK(idealgas_box_histogram(box, 1, &speeds, &frequencies, &num_bins) == IDEALGAS_INVALID_ARGUMENT);
+    CHECK(idealgas_box_histogram(box, 0, NULL, &frequencies, &num_bins) == IDEALGAS_INVALID_ARGUMENT);
+
+    //too many particles to place without overlaps, which leaves the box unplaced
+    idealgas_box_destroy(box);
+    box = idealgas_box_create(10, 10, 4, 0);
+    CHECK(idealgas_box_add_species(box, 1, 3, 1000, 1) == IDEALGAS_OK);
+    CHECK(idealgas_box_step(box, 1) != IDEALGAS_OK);
+    CHECK(idealgas_box_num_particles(box) == 0);
+    idealgas_box_destroy(box);
+
+    idealgas_box_destroy(NULL);
+    CHECK(idealgas_box_num_particles(NULL) == 0);
+}
+
+int main(void) {
+    TestSteppedBox();
+    TestEquilibration();
+    TestErrors();
+
+    if (num_failures > 0) {
+        fprintf(stderr, "%d checks failed\n", num_failures);
+        return EXIT_FAILURE;
+    }
+    printf("All C API checks passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,84 @@
+/* - MPI program run under mpiexec with 2 or more processes, testing MpiTransport between real ranks
+   - Each rank sends its neighbours a different number of particles in each direction, tagged with the sending rank
+     and their index, so every received particle can be checked
+   - A transport with tiny chunks splits each message into many MPI calls, which must give the same result as one
+   - Exits non-zero on any rank if a check failed there */
+
+#include <mpi.h>
+#include <cstdio>
+#include <cstdlib>
+#include "core/particle_transport.h"
+
+using idealgas::MpiTransport;
+using idealgas::Neighbour;
+using idealgas::Particle;
+
+static int num_failures = 0;
+
+#define CHECK(condition)                                                                          \
+    do {                                                                                          \
+        if (!(condition)) {                                                                       \
+            std::fprintf(stderr, "%s:%d: check failed: %s\n", __FILE__, __LINE__, #condition);    \
+            num_failures++;                                                                       \
+        }                                                                                         \
+    } while (0)
+
+/* Particles rank sends towards neighbour: a count that differs by rank and direction, each particle's position
+   holding the sender's rank and its index */
+static vector<Particle> MakeOutgoing(const int rank, const Neighbour neighbour) {
+    size_t count = neighbour == Neighbour::kLeft ? 5 + 3 * rank : 40 + 7 * rank;
+    vector<Particle> particles;
+    for (size_t i = 0; i < count; ++i) {
+        particles.push_back(Particle(1, glm::vec2(rank, i), glm::vec2(0, 0), 1, 1, cinder::Colorf(1, 1, 1)));
+    }
+    return particles;
+}
+
+/* What arrives from neighbour is what it sent the other way */
+static void CheckIncoming(MpiTransport& transport, const Neighbour neighbour, const vector<Particle>& incoming) {
+    int other_rank = neighbour == Neighbour::kLeft ? transport.GetRank() - 1 : transport.GetRank() + 1;
+    if (other_rank < 0 || other_rank >= transport.GetNumRanks()) {
+        CHECK(incoming.empty());
+        return;
+    }
+
+    vector<Particle> expected = MakeOutgoing(other_rank, neighbour == Neighbour::kLeft ? Neighbour::kRight : Neighbour::kLeft);
+    CHECK(incoming.size() == expected.size());
+    for (size_t i = 0; i < incoming.size() && i < expected.size(); ++i) {
+        CHECK(glm::vec2(incoming[i].pos) == glm::vec2(expected[i].pos));
+    }
+}
+
+static void TestExchange(MpiTransport& transport) {
+    for (Neighbour neighbour : {Neighbour::kLeft, Neighbour::kRight}) {
+        vector<Particle> incoming = transport.Exchange(neighbour, MakeOutgoing(transport.GetRank(), neighbour));
+        CheckIncoming(transport, neighbour, incoming);
+    }
+
+    //nothing sent either way is still a matched exchange
+    CHECK(transport.Exchange(Neighbour::kRight, vector<Particle>()).empty());
+    CHECK(transport.Exchange(Neighbour::kLeft, vector<Particle>()).empty());
+}
+
+int main(int argc, char* argv[]) {
+    MPI_Init(&argc, &argv);
+
+    MpiTransport transport;
+    CHECK(transport.GetNumRanks() >= 2);
+    TestExchange(transport);
+
+    //chunks of 3 particles (rounded down from 3.5), so every message takes several calls and the two directions
+    //take different numbers of them
+    MpiTransport chunked(sizeof(Particle) * 7 / 2);
+    TestExchange(chunked);
+
+    int rank = transport.GetRank();
+    MPI_Finalize();
+
+    if (num_failures > 0) {
+        std::fprintf(stderr, "rank %d: %d checks failed\n", rank, num_failures);
+        return EXIT_FAILURE;
+    }
+    if (rank == 0) std::printf("All MPI transport checks passed\n");
+    return EXIT_SUCCESS;
+}
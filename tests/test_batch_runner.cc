@@ -0,0 +1,164 @@
+#include <catch2/catch.hpp>
+#include <atomic>
+#include <chrono>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include "core/batch_runner.h"
+#include "core/work_stealing_pool.h"
+
+namespace idealgas {
+    /* - Pools use 4 threads whatever the machine has, so stealing happens even on a single core
+       - Batch runs are small boxes with a few particles of two species, stepped briefly */
+
+    RunConfig MakeRunConfig(const size_t run_id, const uint32_t seed) {
+        RunConfig config;
+        config.run_id = run_id;
+        config.seed = seed;
+        config.num_steps = 20;
+        config.box_width = 100;
+        config.max_initial_speed = 2;
+        config.species = {{1, 10, 1, 2}, {2, 5, 5, 4}};
+        config.num_bins = 5;
+        return config;
+    }
+
+    vector<string> SplitLines(const string& text) {
+        vector<string> lines;
+        std::istringstream stream(text);
+        string line;
+        while (std::getline(stream, line)) {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    TEST_CASE("Work stealing pool runs every task once") {
+        WorkStealingPool pool(4);
+        vector<std::atomic<int>> counts(100);
+        for (std::atomic<int>& count : counts) {
+            count = 0;
+        }
+
+        vector<std::function<void(size_t)>> tasks;
+        for (size_t i = 0; i < counts.size(); ++i) {
+            tasks.push_back([&counts, i](size_t) { counts[i]++; });
+        }
+        pool.Run(tasks);
+
+        bool all_once = true;
+        for (std::atomic<int>& count : counts) {
+            all_once = all_once && count == 1;
+        }
+        REQUIRE(all_once);
+    }
+
+    TEST_CASE("Work stealing pool balances uneven tasks") {
+        WorkStealingPool pool(4);
+        std::atomic<int> num_done(0);
+
+        //all the slow tasks are in the first thread's block, so other threads have to steal them
+        vector<std::function<void(size_t)>> tasks;
+        for (size_t i = 0; i < 40; ++i) {
+            tasks.push_back([&num_done, i](size_t) {
+                if (i < 10) std::this_thread::sleep_for(std::chrono::milliseconds(5));
+                num_done++;
+            });
+        }
+        pool.Run(tasks);
+
+        REQUIRE(num_done == 40);
+        REQUIRE(pool.GetNumSteals() > 0);
+    }
+
+    TEST_CASE("Work stealing pool rethrows a task's exception after running the rest") {
+        WorkStealingPool pool(4);
+        std::atomic<int> num_done(0);
+
+        vector<std::function<void(size_t)>> tasks;
+        for (size_t i = 0; i < 20; ++i) {
+            tasks.push_back([&num_done, i](size_t) {
+                if (i == 3) throw std::runtime_error("failed run");
+                num_done++;
+            });
+        }
+
+        REQUIRE_THROWS_AS(pool.Run(tasks), std::runtime_error);
+        REQUIRE(num_done == 19);
+    }
+
+    TEST_CASE("Batch runner streams one line per species of each run") {
+        std::ostringstream out;
+        BatchRunner runner(out, 4);
+        vector<RunConfig> configs;
+        for (size_t i = 0; i < 12; ++i) {
+            configs.push_back(MakeRunConfig(i, static_cast<uint32_t>(i)));
+        }
+
+        runner.Run(configs);
+        vector<string> lines = SplitLines(out.str());
+
+        REQUIRE(runner.GetNumCompleted() == 12);
+        REQUIRE(lines.size() == 1 + 12 * 2);
+        REQUIRE(lines[0] == "run_id,seed,temperature,num_steps,is_equilibrated,type,num_particles,mean_speed,x_values,bin_frequencies");
+    }
+
+    TEST_CASE("Batch runs are reproducible from their seed") {
+        RunResult first = BatchRunner::RunOne(MakeRunConfig(0, 7));
+        RunResult second = BatchRunner::RunOne(MakeRunConfig(1, 7));
+        RunResult other_seed = BatchRunner::RunOne(MakeRunConfig(2, 8));
+
+        REQUIRE(first.species.size() == 2);
+        REQUIRE(first.species[0].num_particles == 10);
+        REQUIRE(first.species[1].num_particles == 5);
+        REQUIRE(first.species[0].bin_frequencies.size() == 5);
+        REQUIRE(first.temperature == second.temperature);
+        REQUIRE(first.species[0].bin_frequencies == second.species[0].bin_frequencies);
+        REQUIRE(first.temperature != other_seed.temperature);
+        REQUIRE(first.num_steps == 20);
+        REQUIRE_FALSE(first.is_equilibrated);
+    }
+
+    TEST_CASE("Batch runs can stop once every species has equilibrated") {
+        RunConfig config = MakeRunConfig(0, 7);
+        config.num_steps = 5000;
+        config.equilibrium_check_interval = 2;
+        RunResult result = BatchRunner::RunOne(config);
+
+        //30 passing fits in a row are needed, so the earliest possible stop is after 60 steps
+        REQUIRE(result.is_equilibrated);
+        REQUIRE(result.num_steps >= 60);
+        REQUIRE(result.num_steps < config.num_steps);
+        REQUIRE(result.num_steps % 2 == 0);
+
+        SECTION("A run that can't equilibrate in time runs every step") {
+            config.num_steps = 40;
+            RunResult short_result = BatchRunner::RunOne(config);
+            REQUIRE_FALSE(short_result.is_equilibrated);
+            REQUIRE(short_result.num_steps == 40);
+        }
+    }
+
+    TEST_CASE("Batch runs start with no particles overlapping") {
+        RunConfig config = MakeRunConfig(0, 3);
+        config.species = {{1, 60, 1, 2}, {2, 30, 5, 4}};
+
+        for (PlacementStrategy placement : {PlacementStrategy::kLatticeJitter, PlacementStrategy::kPoissonDisk}) {
+            config.placement = placement;
+            vector<Particle> particles = BatchRunner::PlaceParticles(config);
+            REQUIRE(particles.size() == 90);
+
+            size_t num_overlapping = 0;
+            for (size_t i = 0; i < particles.size(); ++i) {
+                for (size_t j = i + 1; j < particles.size(); ++j) {
+                    float dist = glm::length(glm::vec2(particles[i].pos) - glm::vec2(particles[j].pos));
+                    if (dist < particles[i].radius + particles[j].radius) num_overlapping++;
+                }
+            }
+            REQUIRE(num_overlapping == 0);
+            REQUIRE(particles[0].type == 1);
+            REQUIRE(particles[60].type == 2);
+        }
+    }
+}
@@ -0,0 +1,95 @@
+#include <catch2/catch.hpp>
+#include <cstdlib>
+#include "core/collision_kernel.h"
+
+namespace idealgas {
+    /* - Head-on collisions along x between particles of radius 1 touching at x = 1
+       - Batched results are compared with resolving the same neighbours one at a time */
+
+    TEST_CASE("Fused pair kernel") {
+        SECTION("Equal masses colliding head-on swap velocities") {
+            Particle p1(0, glm::vec2(0, 0), glm::vec2(1, 0), 1, 1, "Red");
+            Particle p2(0, glm::vec2(2, 0), glm::vec2(-2, 0), 1, 1, "Red");
+
+            REQUIRE(ResolvePair(p1, p2));
+            REQUIRE(glm::vec2(p1.vel) == glm::vec2(-2, 0));
+            REQUIRE(glm::vec2(p2.vel) == glm::vec2(1, 0));
+        }
+
+        SECTION("Different masses keep momentum and energy") {
+            Particle p1(0, glm::vec2(0, 0), glm::vec2(1, 0.5f), 3, 1, "Red");
+            Particle p2(0, glm::vec2(1.5f, 0.5f), glm::vec2(-2, 0), 1, 1, "Red");
+
+            REQUIRE(ResolvePair(p1, p2));
+            REQUIRE(3 * p1.vel.x + p2.vel.x == Approx(1));
+            REQUIRE(3 * p1.vel.y + p2.vel.y == Approx(1.5f));
+            REQUIRE(1.5f * glm::dot(p1.vel, p1.vel) + 0.5f * glm::dot(p2.vel, p2.vel) == Approx(1.5f * 1.25f + 2));
+        }
+
+        SECTION("Particles that aren't touching don't collide") {
+            Particle p1(0, glm::vec2(0, 0), glm::vec2(1, 0), 1, 1, "Red");
+            Particle p2(0, glm::vec2(3, 0), glm::vec2(-1, 0), 1, 1, "Red");
+
+            REQUIRE_FALSE(ResolvePair(p1, p2));
+            REQUIRE(glm::vec2(p1.vel) == glm::vec2(1, 0));
+            REQUIRE(glm::vec2(p2.vel) == glm::vec2(-1, 0));
+        }
+
+        SECTION("Particles moving apart don't collide") {
+            Particle p1(0, glm::vec2(0, 0), glm::vec2(-1, 0), 1, 1, "Red");
+            Particle p2(0, glm::vec2(1, 0), glm::vec2(1, 0), 1, 1, "Red");
+
+            REQUIRE_FALSE(ResolvePair(p1, p2));
+            REQUIRE(glm::vec2(p1.vel) == glm::vec2(-1, 0));
+        }
+
+        SECTION("Particles at the same position don't collide") {
+            Particle p1(0, glm::vec2(0, 0), glm::vec2(1, 0), 1, 1, "Red");
+            Particle p2(0, glm::vec2(0, 0), glm::vec2(-1, 0), 1, 1, "Red");
+
+            REQUIRE_FALSE(ResolvePair(p1, p2));
+            REQUIRE(glm::vec2(p1.vel) == glm::vec2(1, 0));
+        }
+    }
+
+    TEST_CASE("Batched neighbour kernel gives the same result as resolving neighbours in order") {
+        srand(3);
+        vector<Particle> particles;
+        for (size_t i = 0; i < 40; ++i) {
+            glm::vec2 pos(rand() % 6, rand() % 6);
+            glm::vec2 vel(rand() % 5 - 2, rand() % 5 - 2);
+            particles.push_back(Particle(0, pos, vel, 1 + rand() % 3, 1.5f, "Red"));
+        }
+
+        //storage order differs from id order, and the particles are crowded so a row often has several collisions
+        vector<uint32_t> id_to_index(particles.size());
+        for (uint32_t id = 0; id < id_to_index.size(); ++id) {
+            id_to_index[id] = (id * 7) % particles.size();
+        }
+
+        vector<Particle> expected = particles;
+        size_t expected_collisions = 0;
+        size_t num_collisions = 0;
+        for (uint32_t id = 0; id < particles.size(); ++id) {
+            vector<uint32_t> neighbour_ids;
+            for (uint32_t other = 0; other < particles.size(); ++other) {
+                if (other != id) neighbour_ids.push_back(other);
+            }
+
+            Particle& p = expected[id_to_index[id]];
+            for (uint32_t other : neighbour_ids) {
+                if (ResolvePair(p, expected[id_to_index[other]])) expected_collisions++;
+            }
+            num_collisions += ResolveNeighbours(particles[id_to_index[id]], particles, id_to_index, neighbour_ids.data(),
+                                                neighbour_ids.size());
+        }
+
+        bool all_equal = true;
+        for (size_t i = 0; i < particles.size(); ++i) {
+            all_equal = all_equal && particles[i].vel == expected[i].vel;
+        }
+        REQUIRE(num_collisions == expected_collisions);
+        REQUIRE(num_collisions > particles.size());
+        REQUIRE(all_equal);
+    }
+}
@@ -0,0 +1,94 @@
+#include <catch2/catch.hpp>
+#include "core/density_field.h"
+
+namespace idealgas {
+    /* - Fields are 10 x 10 pixels over a 100 x 100 area, so each pixel covers a 10 x 10 square
+       - The large splat has enough particles to be split across threads on machines with more than one core
+       - Particles counted in view are crowded into one corner, so the count depends on where the view is */
+
+    TEST_CASE("Density field counts particles per pixel") {
+        DensityField field(10, 10);
+
+        SECTION("Particles land in the pixel under their center") {
+            vector<Particle> particles = {Particle(1, glm::vec2(5, 5), glm::vec2(0, 0), 1, 1, cinder::Colorf(1, 0, 0)),
+                                          Particle(1, glm::vec2(7, 2), glm::vec2(0, 0), 1, 1, cinder::Colorf(1, 0, 0)),
+                                          Particle(1, glm::vec2(95, 15), glm::vec2(0, 0), 1, 1, cinder::Colorf(1, 0, 0))};
+            field.Splat(particles, 0, 100, 0, 100);
+
+            REQUIRE(field.GetCount(0, 0) == 2);
+            REQUIRE(field.GetCount(9, 1) == 1);
+            REQUIRE(field.GetCount(1, 0) == 0);
+        }
+
+        SECTION("Particles outside the view are left out") {
+            vector<Particle> particles = {Particle(1, glm::vec2(5, 5), glm::vec2(0, 0), 1, 1, cinder::Colorf(1, 0, 0)),
+                                          Particle(1, glm::vec2(60, 60), glm::vec2(0, 0), 1, 1, cinder::Colorf(1, 0, 0))};
+            field.Splat(particles, 50, 100, 50, 100);
+
+            REQUIRE(field.GetCount(2, 2) == 1);
+            uint32_t total = 0;
+            for (size_t y = 0; y < 10; ++y) {
+                for (size_t x = 0; x < 10; ++x) {
+                    total += field.GetCount(x, y);
+                }
+            }
+            REQUIRE(total == 1);
+        }
+
+        SECTION("Pixels are the average color, brightest where densest, and empty pixels are transparent") {
+            vector<Particle> particles = {Particle(1, glm::vec2(5, 5), glm::vec2(0, 0), 1, 1, cinder::Colorf(1, 0, 0)),
+                                          Particle(2, glm::vec2(5, 5), glm::vec2(0, 0), 1, 1, cinder::Colorf(0, 0, 1)),
+                                          Particle(1, glm::vec2(25, 5), glm::vec2(0, 0), 1, 1, cinder::Colorf(1, 0, 0))};
+            field.Splat(particles, 0, 100, 0, 100);
+            const vector<uint8_t>& pixels = field.GetPixels();
+
+            REQUIRE(pixels.size() == 400);
+            //densest pixel: half red, half blue at full brightness
+            REQUIRE(pixels[0] == 127);
+            REQUIRE(pixels[2] == 127);
+            REQUIRE(pixels[3] == 255);
+            //single red particle is dimmer
+            REQUIRE(pixels[8] > 127);
+            REQUIRE(pixels[8] < 255);
+            REQUIRE(pixels[4 * 1 + 3] == 0);
+        }
+    }
+
+    TEST_CASE("Density field counts every particle of a large splat") {
+        DensityField field(10, 10);
+        vector<Particle> particles;
+        for (size_t i = 0; i < 200000; ++i) {
+            particles.push_back(Particle(1, glm::vec2(static_cast<float>(i % 100), static_cast<float>((i / 100) % 100)),
+                                         glm::vec2(0, 0), 1, 1, cinder::Colorf(1, 1, 1)));
+        }
+        field.Splat(particles, 0, 100, 0, 100);
+
+        bool all_equal = true;
+        for (size_t y = 0; y < 10; ++y) {
+            for (size_t x = 0; x < 10; ++x) {
+                all_equal = all_equal && field.GetCount(x, y) == 2000;
+            }
+        }
+        REQUIRE(all_equal);
+    }
+
+    TEST_CASE("Counting particles in view") {
+        //every particle crowded into the top left quarter
+        vector<Particle> particles;
+        for (size_t i = 0; i < 100; ++i) {
+            particles.push_back(Particle(1, glm::vec2(static_cast<float>(i % 10), static_cast<float>(i / 10)),
+                                         glm::vec2(0, 0), 1, 1, cinder::Colorf(1, 1, 1)));
+        }
+
+        SECTION("Only particles inside the view count, however many are in the box") {
+            REQUIRE(DensityField::CountInView(particles, 0, 50, 0, 50, 1000) == 100);
+            REQUIRE(DensityField::CountInView(particles, 50, 100, 50, 100, 1000) == 0);
+            REQUIRE(DensityField::CountInView(particles, 0, 5, 0, 10, 1000) == 50);
+        }
+
+        SECTION("Counting stops just past the maximum") {
+            REQUIRE(DensityField::CountInView(particles, 0, 50, 0, 50, 20) == 21);
+            REQUIRE(DensityField::CountInView(particles, 0, 50, 0, 50, 100) == 100);
+        }
+    }
+}
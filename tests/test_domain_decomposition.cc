@@ -0,0 +1,156 @@
+#include <catch2/catch.hpp>
+#include <cstdlib>
+#include <stdexcept>
+#include <thread>
+#include "core/domain_decomposition.h"
+
+namespace idealgas {
+    /* - Ranks run as threads connected by UNIX sockets, each one stepping its own slab of a 200x100 box
+       - Assertions are made on the main thread after every rank has finished
+       - Forked ranks are separate processes, so nothing is asserted inside them: they send their particles back */
+
+    /* Steps every rank num_steps times and returns each rank's particles (and total particles migrated) */
+    vector<vector<Particle>> RunRanks(const int num_ranks, const vector<Particle>& particles, const size_t num_steps,
+                                      size_t& num_migrated) {
+        vector<std::unique_ptr<SocketTransport>> transports = SocketTransport::CreateConnected(num_ranks);
+        vector<vector<Particle>> results(num_ranks);
+        vector<size_t> migrated(num_ranks, 0);
+
+        vector<std::thread> threads;
+        for (int rank = 0; rank < num_ranks; ++rank) {
+            threads.push_back(std::thread([&, rank]() {
+                DomainDecomposition domain(*transports[rank], particles, 0, 200, 0, 100, 2);
+                for (size_t i = 0; i < num_steps; ++i) {
+                    domain.Step();
+                }
+                results[rank] = domain.GetController().GetParticles();
+                migrated[rank] = domain.GetNumMigrated();
+            }));
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+
+        num_migrated = 0;
+        for (size_t count : migrated) {
+            num_migrated += count;
+        }
+        return results;
+    }
+
+    TEST_CASE("Slabs split the box evenly") {
+        vector<std::unique_ptr<SocketTransport>> transports = SocketTransport::CreateConnected(4);
+        vector<Particle> v;
+
+        DomainDecomposition first(*transports[0], v, 0, 200, 0, 100, 2);
+        DomainDecomposition last(*transports[3], v, 0, 200, 0, 100, 2);
+
+        REQUIRE(first.GetSlabXMin() == 0);
+        REQUIRE(first.GetSlabXMax() == 50);
+        REQUIRE(last.GetSlabXMin() == 150);
+        REQUIRE(last.GetSlabXMax() == 200);
+    }
+
+    TEST_CASE("Each rank keeps only the particles in its slab") {
+        vector<std::unique_ptr<SocketTransport>> transports = SocketTransport::CreateConnected(2);
+        vector<Particle> v = {Particle(0, glm::vec2(50, 50), glm::vec2(0, 0), 1, 1, "Red"),
+                              Particle(0, glm::vec2(150, 50), glm::vec2(0, 0), 1, 1, "Red"),
+                              Particle(0, glm::vec2(160, 50), glm::vec2(0, 0), 1, 1, "Red")};
+
+        DomainDecomposition left(*transports[0], v, 0, 200, 0, 100, 2);
+        DomainDecomposition right(*transports[1], v, 0, 200, 0, 100, 2);
+
+        REQUIRE(left.GetController().GetParticles().size() == 1);
+        REQUIRE(right.GetController().GetParticles().size() == 2);
+    }
+
+    TEST_CASE("Particle crossing a slab boundary moves to the neighbour") {
+        vector<Particle> v = {Particle(0, glm::vec2(98, 50), glm::vec2(1, 0), 1, 1, "Red")};
+        size_t num_migrated = 0;
+
+        vector<vector<Particle>> results = RunRanks(2, v, 3, num_migrated);
+
+        REQUIRE(results[0].empty());
+        REQUIRE(results[1].size() == 1);
+        REQUIRE(glm::vec2(results[1][0].pos) == glm::vec2(101, 50));
+        REQUIRE(num_migrated == 1);
+    }
+
+    TEST_CASE("Particles collide across a slab boundary") {
+        vector<Particle> v = {Particle(0, glm::vec2(98.5f, 50), glm::vec2(1, 0), 1, 1, "Red"),
+                              Particle(0, glm::vec2(101.5f, 50), glm::vec2(-1, 0), 1, 1, "Red")};
+        size_t num_migrated = 0;
+
+        //touching after the first step, each rank bounces its particle off the other's ghost in the second
+        vector<vector<Particle>> results = RunRanks(2, v, 2, num_migrated);
+
+        REQUIRE(results[0].size() == 1);
+        REQUIRE(results[1].size() == 1);
+        REQUIRE(glm::vec2(results[0][0].vel) == glm::vec2(-1, 0));
+        REQUIRE(glm::vec2(results[1][0].vel) == glm::vec2(1, 0));
+        REQUIRE(num_migrated == 0);
+    }
+
+    TEST_CASE("Particles aren't lost or duplicated between ranks") {
+        srand(11);
+        vector<Particle> v;
+        for (size_t i = 0; i < 300; ++i) {
+            glm::vec2 pos(2 + rand() % 196, 2 + rand() % 96);
+            glm::vec2 vel(rand() % 5 - 2, rand() % 5 - 2);
+            v.push_back(Particle(0, pos, vel, 1, 0.5f, "Red"));
+        }
+        size_t num_migrated = 0;
+
+        vector<vector<Particle>> results = RunRanks(4, v, 50, num_migrated);
+
+        size_t num_particles = 0;
+        for (size_t rank = 0; rank < results.size(); ++rank) {
+            num_particles += results[rank].size();
+        }
+        REQUIRE(num_particles == 300);
+        REQUIRE(num_migrated > 0);
+    }
+
+    TEST_CASE("Ranks in forked processes give the same result as ranks in threads") {
+        srand(5);
+        vector<Particle> v;
+        for (size_t i = 0; i < 200; ++i) {
+            glm::vec2 pos(2 + rand() % 196, 2 + rand() % 96);
+            glm::vec2 vel(rand() % 5 - 2, rand() % 5 - 2);
+            v.push_back(Particle(0, pos, vel, 1, 0.5f, "Red"));
+        }
+        size_t num_migrated = 0;
+        vector<vector<Particle>> expected = RunRanks(3, v, 40, num_migrated);
+
+        vector<vector<Particle>> results = RunForkedRanks(3, [&](ParticleTransport& transport) {
+            DomainDecomposition domain(transport, v, 0, 200, 0, 100, 2);
+            for (size_t i = 0; i < 40; ++i) {
+                domain.Step();
+            }
+            return domain.GetController().GetParticles();
+        });
+
+        REQUIRE(results.size() == 3);
+        for (size_t rank = 0; rank < results.size(); ++rank) {
+            REQUIRE(results[rank].size() == expected[rank].size());
+            bool all_equal = true;
+            for (size_t i = 0; i < results[rank].size(); ++i) {
+                all_equal = all_equal && glm::vec2(results[rank][i].pos) == glm::vec2(expected[rank][i].pos) &&
+                            glm::vec2(results[rank][i].vel) == glm::vec2(expected[rank][i].vel);
+            }
+            REQUIRE(all_equal);
+        }
+        REQUIRE(num_migrated > 0);
+    }
+
+    TEST_CASE("A forked rank that fails is reported, and its neighbours don't wait for it") {
+        //rank 1 gives up before its first exchange, so ranks 0 and 2 find its sockets closed
+        REQUIRE_THROWS_AS(RunForkedRanks(3, [](ParticleTransport& transport) {
+            if (transport.GetRank() == 1) throw std::runtime_error("rank 1 gave up");
+            vector<Particle> v;
+            DomainDecomposition domain(transport, v, 0, 200, 0, 100, 2);
+            domain.Step();
+            return domain.GetController().GetParticles();
+        }), std::runtime_error);
+    }
+}
@@ -0,0 +1,209 @@
+#include <catch2/catch.hpp>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <thread>
+#include "core/frame_encoder.h"
+#include "core/frame_rasterizer.h"
+#include "core/png_encoder.h"
+
+namespace idealgas {
+    /* - Rasterizer checks read single pixels of small images, (x, y) is column x of row y from the top
+       - PNGs are checked by undoing the stored deflate blocks by hand, and with the known CRC of the IEND chunk
+       - Pipe sinks run shell commands, so they're only tested where there's a POSIX shell */
+
+    cinder::Colorf PixelAt(const FrameRasterizer& rasterizer, const size_t x, const size_t y) {
+        const vector<uint8_t>& pixels = rasterizer.GetPixels();
+        size_t index = 3 * (y * rasterizer.GetWidth() + x);
+        return cinder::Colorf(pixels[index] / 255.0f, pixels[index + 1] / 255.0f, pixels[index + 2] / 255.0f);
+    }
+
+    uint32_t ReadBigEndian(const vector<uint8_t>& bytes, const size_t offset) {
+        return (static_cast<uint32_t>(bytes[offset]) << 24) | (static_cast<uint32_t>(bytes[offset + 1]) << 16) |
+               (static_cast<uint32_t>(bytes[offset + 2]) << 8) | bytes[offset + 3];
+    }
+
+    vector<uint8_t> ReadFile(const string& path) {
+        std::ifstream in(path, std::ios::binary);
+        return vector<uint8_t>((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    }
+
+    TEST_CASE("CPU rasterizer") {
+        FrameRasterizer rasterizer(20, 20);
+        rasterizer.Clear(cinder::Colorf(0, 0, 0));
+
+        SECTION("Circles cover pixels whose centers are inside them") {
+            rasterizer.FillCircle(glm::vec2(10, 10), 4, cinder::Colorf(1, 0, 0));
+            REQUIRE(PixelAt(rasterizer, 10, 10).r == 1);
+            REQUIRE(PixelAt(rasterizer, 6, 10).r == 1);
+            REQUIRE(PixelAt(rasterizer, 5, 10).r == 0);
+            REQUIRE(PixelAt(rasterizer, 13, 13).r == 0);
+        }
+
+        SECTION("Shapes past the edges are clipped") {
+            rasterizer.FillCircle(glm::vec2(0, 0), 30, cinder::Colorf(0, 1, 0));
+            rasterizer.FillRect(-5, 15, 100, 100, cinder::Colorf(0, 0, 1));
+            REQUIRE(PixelAt(rasterizer, 0, 0).g == 1);
+            REQUIRE(PixelAt(rasterizer, 19, 19).b == 1);
+        }
+
+        SECTION("Strokes are centered on the rectangle's edges") {
+            rasterizer.StrokeRect(5, 5, 15, 15, 2, cinder::Colorf(1, 1, 1));
+            REQUIRE(PixelAt(rasterizer, 4, 10).r == 1);
+            REQUIRE(PixelAt(rasterizer, 5, 10).r == 1);
+            REQUIRE(PixelAt(rasterizer, 6, 10).r == 0);
+            REQUIRE(PixelAt(rasterizer, 10, 10).r == 0);
+        }
+
+        SECTION("Box draws particles and the piston") {
+            vector<Particle> particles = {Particle(1, glm::vec2(8, 8), glm::vec2(0, 0), 1, 2, cinder::Colorf(0, 0, 1))};
+            rasterizer.DrawBox(particles, glm::vec2(2, 2), 16, 2, 14);
+            REQUIRE(PixelAt(rasterizer, 8, 8).b == 1);
+            REQUIRE(PixelAt(rasterizer, 15, 8).r == Approx(0.5f).margin(0.01f));
+            REQUIRE(PixelAt(rasterizer, 2, 8).g == 1);
+        }
+    }
+
+    TEST_CASE("PNG encoding") {
+        vector<uint8_t> rgb(3 * 300 * 250);
+        for (size_t i = 0; i < rgb.size(); ++i) {
+            rgb[i] = static_cast<uint8_t>(i * 7);
+        }
+        vector<uint8_t> png = EncodePng(rgb, 300, 250);
+
+        SECTION("Has the signature, header, and end chunks") {
+            REQUIRE(png[0] == 0x89);
+            REQUIRE(string(png.begin() + 1, png.begin() + 4) == "PNG");
+            REQUIRE(string(png.begin() + 12, png.begin() + 16) == "IHDR");
+            REQUIRE(ReadBigEndian(png, 16) == 300);
+            REQUIRE(ReadBigEndian(png, 20) == 250);
+            REQUIRE(string(png.end() - 8, png.end() - 4) == "IEND");
+            REQUIRE(ReadBigEndian(png, png.size() - 4) == 0xae426082);
+        }
+
+        SECTION("Stored blocks hold every row, each after a filter byte") {
+            size_t idat_length = ReadBigEndian(png, 33);
+            REQUIRE(string(png.begin() + 37, png.begin() + 41) == "IDAT");
+            vector<uint8_t> zlib(png.begin() + 41, png.begin() + 41 + idat_length);
+
+            vector<uint8_t> raw;
+            size_t offset = 2;
+            bool is_final = false;
+            while (!is_final) {
+                is_final = zlib[offset] == 1;
+                size_t block_size = zlib[offset + 1] | (zlib[offset + 2] << 8);
+                REQUIRE(static_cast<uint16_t>(block_size ^ (zlib[offset + 3] | (zlib[offset + 4] << 8))) == 0xffff);
+                raw.insert(raw.end(), zlib.begin() + offset + 5, zlib.begin() + offset + 5 + block_size);
+                offset += 5 + block_size;
+            }
+
+            REQUIRE(raw.size() == 250 * (1 + 3 * 300));
+            REQUIRE(raw[0] == 0);
+            REQUIRE(raw[901] == 0);
+            REQUIRE(vector<uint8_t>(raw.begin() + 902, raw.begin() + 1802) == vector<uint8_t>(rgb.begin() + 900, rgb.begin() + 1800));
+            REQUIRE(offset + 4 == zlib.size());
+        }
+
+        SECTION("Wrong sized pixel data is rejected") {
+            REQUIRE_THROWS_AS(EncodePng(rgb, 300, 251), std::invalid_argument);
+        }
+    }
+
+    TEST_CASE("Background frame encoder") {
+        vector<uint8_t> frame(3 * 8 * 4, 100);
+        string prefix = "idealgas_capture_test_";
+
+        SECTION("Writes a numbered PNG per frame") {
+            FrameEncoder encoder(prefix, CaptureSink::kPngSequence, 8, 4, 100);
+            for (size_t i = 0; i < 5; ++i) {
+                REQUIRE(encoder.Submit(frame));
+            }
+            encoder.Finish();
+
+            REQUIRE(encoder.GetNumEncoded() == 5);
+            REQUIRE(encoder.GetNumDropped() == 0);
+            REQUIRE(ReadFile(prefix + "000004.png") == EncodePng(frame, 8, 4));
+            for (size_t i = 0; i < 5; ++i) {
+                std::remove((prefix + "00000" + std::to_string(i) + ".png").c_str());
+            }
+        }
+
+        SECTION("Frames can be drawn on the encoder thread") {
+            std::thread::id caller = std::this_thread::get_id();
+            std::thread::id drawer = caller;
+            {
+                FrameEncoder encoder(prefix, CaptureSink::kPngSequence, 8, 4, 100);
+                REQUIRE(encoder.Submit([&](vector<uint8_t>& rgb) {
+                    drawer = std::this_thread::get_id();
+                    rgb = frame;
+                }));
+                encoder.Finish();
+                REQUIRE(encoder.GetNumEncoded() == 1);
+            }
+
+            REQUIRE(drawer != caller);
+            REQUIRE(ReadFile(prefix + "000000.png") == EncodePng(frame, 8, 4));
+            std::remove((prefix + "000000.png").c_str());
+        }
+
+        SECTION("A drawn frame of the wrong size is reported by Finish") {
+            FrameEncoder encoder(prefix, CaptureSink::kPngSequence, 8, 4);
+            encoder.Submit([](vector<uint8_t>& rgb) { rgb.assign(5, 0); });
+            REQUIRE_THROWS_AS(encoder.Finish(), std::invalid_argument);
+            REQUIRE(encoder.GetNumEncoded() == 0);
+        }
+
+        SECTION("Writing to a missing directory is reported by Finish") {
+            FrameEncoder encoder("/nonexistent_idealgas_dir/frame_", CaptureSink::kPngSequence, 8, 4);
+            encoder.Submit(frame);
+            REQUIRE_THROWS_AS(encoder.Finish(), std::runtime_error);
+        }
+
+#ifndef _WIN32
+        SECTION("Pipes raw frames to a command") {
+            string path = prefix + "raw";
+            {
+                FrameEncoder encoder("cat > " + path, CaptureSink::kPipe, 8, 4, 100);
+                for (size_t i = 0; i < 3; ++i) {
+                    encoder.Submit(frame);
+                }
+            }
+            REQUIRE(ReadFile(path).size() == 3 * frame.size());
+            std::remove(path.c_str());
+        }
+
+        SECTION("A full queue drops frames unless told to wait") {
+            //frames bigger than a pipe's buffer, so the encoder is stuck on the first one while the command sleeps
+            vector<uint8_t> big_frame(3 * 300 * 300, 100);
+            FrameEncoder dropping("sleep 0.3; cat > /dev/null", CaptureSink::kPipe, 300, 300, 1, FullQueuePolicy::kDrop);
+            FrameEncoder waiting("sleep 0.3; cat > /dev/null", CaptureSink::kPipe, 300, 300, 1, FullQueuePolicy::kWait);
+            for (size_t i = 0; i < 5; ++i) {
+                //only the encoder takes frames off, so a frame can only be dropped if the queue was already full
+                bool was_full = dropping.IsFull();
+                REQUIRE((dropping.Submit(big_frame) || was_full));
+                REQUIRE_FALSE(waiting.IsFull());
+                waiting.Submit(big_frame);
+            }
+            dropping.Finish();
+            waiting.Finish();
+
+            REQUIRE(dropping.GetNumDropped() > 0);
+            REQUIRE(dropping.GetNumEncoded() + dropping.GetNumDropped() == 5);
+            REQUIRE(waiting.GetNumDropped() == 0);
+            REQUIRE(waiting.GetNumEncoded() == 5);
+        }
+
+        SECTION("A pipe command that exits without reading fails the capture instead of killing it") {
+            //bigger than a pipe's buffer, so writing it can't finish before the command has exited
+            vector<uint8_t> big_frame(3 * 300 * 300, 100);
+            FrameEncoder encoder("exit 0", CaptureSink::kPipe, 300, 300, 100, FullQueuePolicy::kWait);
+            for (size_t i = 0; i < 3; ++i) {
+                encoder.Submit(big_frame);
+            }
+            REQUIRE_THROWS_AS(encoder.Finish(), std::runtime_error);
+            REQUIRE(encoder.GetNumEncoded() == 0);
+        }
+#endif
+    }
+}
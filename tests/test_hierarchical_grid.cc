@@ -0,0 +1,210 @@
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include <random>
+#include "core/hierarchical_grid.h"
+#include "core/invariant_monitor.h"
+#include "core/particle_controller.h"
+
+namespace idealgas {
+    /* - Gathered candidates are checked against comparing every pair of particles
+       - Mixes have radii up to 40x apart, in a 500 x 500 box unless stated otherwise */
+
+    vector<Particle> MakeMixedRadiusParticles(const size_t num_small, const size_t num_large, const float large_radius) {
+        std::mt19937 random_engine(11);
+        std::uniform_real_distribution<float> coordinate(0, 500);
+        std::uniform_real_distribution<float> vel_component(-1, 1);
+
+        vector<Particle> particles;
+        for (size_t i = 0; i < num_small + num_large; ++i) {
+            float radius = i < num_small ? 1 + (i % 4) : large_radius;
+            Particle p(1, glm::vec2(coordinate(random_engine), coordinate(random_engine)),
+                       glm::vec2(vel_component(random_engine), vel_component(random_engine)), radius * radius, radius, "White");
+            p.id = static_cast<uint32_t>(i);
+            particles.push_back(p);
+        }
+        return particles;
+    }
+
+    bool Contains(const vector<uint32_t>& ids, const uint32_t id) {
+        return std::find(ids.begin(), ids.end(), id) != ids.end();
+    }
+
+    TEST_CASE("Particles go to the level of their radius class") {
+        REQUIRE(HierarchicalGrid::GetLevel(0.2f) == 0);
+        REQUIRE(HierarchicalGrid::GetLevel(2) == 2);
+        REQUIRE(HierarchicalGrid::GetLevel(10) == 5);
+        REQUIRE(HierarchicalGrid::GetLevel(20) == 6);
+        REQUIRE(HierarchicalGrid::GetLevel(30) == 6);
+    }
+
+    TEST_CASE("Hierarchical grid finds every touching pair") {
+        vector<Particle> particles = MakeMixedRadiusParticles(800, 30, 40);
+        //one particle outside the bounds, as after leaving through an open wall
+        particles[0].pos = glm::vec2(-60, 250);
+        particles[1].pos = glm::vec2(-61, 251);
+        HierarchicalGrid grid(0, 500, 0, 500);
+        for (const Particle& p : particles) {
+            grid.Insert(p);
+        }
+        REQUIRE(grid.GetNumLevels() == 4);
+
+        vector<vector<uint32_t>> candidates(particles.size());
+        for (const Particle& p : particles) {
+            grid.GatherCandidates(p, candidates[p.id]);
+        }
+
+        SECTION("Every touching pair is gathered by at least one of the two") {
+            size_t num_touching = 0;
+            for (const Particle& p1 : particles) {
+                for (const Particle& p2 : particles) {
+                    if (p1.id >= p2.id || glm::distance(ToVec2(p1.pos), ToVec2(p2.pos)) > p1.radius + p2.radius) continue;
+                    num_touching++;
+                    REQUIRE((Contains(candidates[p1.id], p2.id) || Contains(candidates[p2.id], p1.id)));
+                }
+            }
+            REQUIRE(num_touching > 10);
+        }
+
+        SECTION("Large particles don't gather small ones") {
+            for (size_t i = 800; i < particles.size(); ++i) {
+                for (uint32_t id : candidates[i]) {
+                    REQUIRE(id >= 800);
+                }
+            }
+        }
+
+        SECTION("Moved particles are found where they are now") {
+            Particle& small = particles[2];
+            small.pos = glm::vec2(ToVec2(particles[805].pos)) + glm::vec2(41, 0);
+            grid.Move(small);
+            vector<uint32_t> moved_candidates;
+            grid.GatherCandidates(small, moved_candidates);
+            REQUIRE(Contains(moved_candidates, 805));
+
+            //a particle of the same size at the same spot finds it until it's removed
+            Particle probe = small;
+            probe.id = 10000;
+            grid.GatherCandidates(probe, moved_candidates);
+            REQUIRE(Contains(moved_candidates, 2));
+            grid.Remove(small);
+            grid.GatherCandidates(probe, moved_candidates);
+            REQUIRE_FALSE(Contains(moved_candidates, 2));
+        }
+    }
+
+    TEST_CASE("Controller finds collisions with a hierarchical grid") {
+        SECTION("Small particle bounces off a large one") {
+            vector<Particle> pair = {Particle(1, glm::vec2(100, 100), glm::vec2(1, 0), 1, 2, "White"),
+                                     Particle(1, glm::vec2(145, 100), glm::vec2(0, 0), 1000, 40, "White")};
+            ParticleController particle_controller(pair, 0, 500, 0, 500);
+            particle_controller.SetHierarchicalGrid(true);
+            for (size_t step = 0; step < 5; ++step) {
+                particle_controller.UpdateParticles();
+            }
+
+            REQUIRE(particle_controller.GetParticle(0).vel.x < 0);
+            REQUIRE(particle_controller.GetParticle(1).vel.x > 0);
+        }
+
+        SECTION("Mixed gas keeps energy and momentum, with about as many collisions as range queries") {
+            vector<Particle> particles = MakeMixedRadiusParticles(800, 10, 20);
+            ParticleController reference(particles, 0, 500, 0, 500);
+            ParticleController candidate(particles, 0, 500, 0, 500);
+            candidate.SetHierarchicalGrid(true);
+            InvariantMonitor reference_monitor;
+            InvariantMonitor candidate_monitor;
+            reference.SetInvariantMonitor(&reference_monitor);
+            candidate.SetInvariantMonitor(&candidate_monitor);
+            for (size_t step = 0; step < 100; ++step) {
+                reference.UpdateParticles();
+                candidate.UpdateParticles();
+            }
+
+            REQUIRE(candidate_monitor.GetNumViolations() == 0);
+            REQUIRE(candidate_monitor.GetNumCollisions() > 0);
+            //range queries only search the querying particle's radius, so they miss some small-large pairs
+            REQUIRE(candidate_monitor.GetNumCollisions() >= 0.9 * reference_monitor.GetNumCollisions());
+            REQUIRE(candidate_monitor.GetNumCollisions() <= 1.5 * reference_monitor.GetNumCollisions());
+        }
+
+        SECTION("Added and removed particles are picked up") {
+            vector<Particle> one = {Particle(1, glm::vec2(100, 100), glm::vec2(1, 0), 1, 2, "White")};
+            ParticleController particle_controller(one, 0, 500, 0, 500);
+            particle_controller.SetHierarchicalGrid(true);
+            uint32_t id = particle_controller.AddParticle(Particle(1, glm::vec2(150, 100), glm::vec2(-1, 0), 50, 45, "White"));
+            for (size_t step = 0; step < 5; ++step) {
+                particle_controller.UpdateParticles();
+            }
+            REQUIRE(particle_controller.GetParticle(0).vel.x < 0);
+
+            particle_controller.RemoveParticle(id);
+            particle_controller.UpdateParticles();
+            particle_controller.SetHierarchicalGrid(false);
+            particle_controller.UpdateParticles();
+            REQUIRE(particle_controller.GetParticles().size() == 1);
+        }
+
+        SECTION("Grid is rebuilt once when the piston moves out past it") {
+            vector<Particle> particles = MakeMixedRadiusParticles(400, 10, 20);
+            ParticleController particle_controller(particles, 0, 500, 0, 500);
+            particle_controller.SetHierarchicalGrid(true);
+            InvariantMonitor monitor;
+            particle_controller.SetInvariantMonitor(&monitor);
+            REQUIRE(particle_controller.GetNumGridBuilds() == 1);
+
+            //moving in stays inside the grid
+            particle_controller.EnqueueCommand(SimulationCommand::MoveWall(400, 10));
+            for (size_t step = 0; step < 20; ++step) {
+                particle_controller.UpdateParticles();
+            }
+            REQUIRE(particle_controller.GetNumGridBuilds() == 1);
+
+            particle_controller.EnqueueCommand(SimulationCommand::MoveWall(900, 30));
+            for (size_t step = 0; step < 100; ++step) {
+                particle_controller.UpdateParticles();
+            }
+            REQUIRE(particle_controller.GetXMax() == Approx(900));
+            REQUIRE(particle_controller.GetNumGridBuilds() == 2);
+            REQUIRE(monitor.GetNumViolations() == 0);
+
+            //particles have followed the piston out into the part of the box only the rebuilt grid covers
+            bool has_particle_past_old_bounds = false;
+            for (const Particle& p : particle_controller.GetParticles()) {
+                has_particle_past_old_bounds = has_particle_past_old_bounds || ToVec2(p.pos).x > 550;
+            }
+            REQUIRE(has_particle_past_old_bounds);
+        }
+    }
+
+    TEST_CASE("Mixed radii cost about as much per particle as one radius") {
+        //candidates gathered per particle stand in for the broadphase's work
+        auto mean_candidates = [](const vector<Particle>& particles) {
+            HierarchicalGrid grid(0, 500, 0, 500);
+            for (const Particle& p : particles) {
+                grid.Insert(p);
+            }
+            size_t num_candidates = 0;
+            vector<uint32_t> candidates;
+            for (const Particle& p : particles) {
+                grid.GatherCandidates(p, candidates);
+                num_candidates += candidates.size();
+            }
+            return static_cast<double>(num_candidates) / particles.size();
+        };
+
+        vector<Particle> small_only = MakeMixedRadiusParticles(2000, 0, 0);
+        vector<Particle> mixed = MakeMixedRadiusParticles(2000, 20, 40);
+        //what one grid sized for the largest radius would do: every particle searching cells for radius 40
+        vector<Particle> single_level = mixed;
+        for (Particle& p : single_level) {
+            p.radius = 40;
+        }
+
+        double small_only_candidates = mean_candidates(small_only);
+        double mixed_candidates = mean_candidates(mixed);
+        INFO(small_only_candidates << " candidates per particle alone, " << mixed_candidates << " mixed");
+        //the extra candidates are the large particles close to each small one, which cover 40% of the box
+        REQUIRE(mixed_candidates < 3 * small_only_candidates);
+        REQUIRE(mixed_candidates * 10 < mean_candidates(single_level));
+    }
+}
@@ -2,6 +2,7 @@
 #include <limits>
 #include "core/particle_controller.h"
 #include "core/histogram.h"
+#include "core/histogram_reducer.h"
 
 namespace idealgas {
     /* - Each call to UpdateParticles and UpdateHistogram represents one unit of time, or frame
@@ -18,9 +19,9 @@ namespace idealgas {
 
             ParticleController pc(v_pc, 0, 10, 0, 10);
 
-            vector<Particle*> v = {&pc.GetParticles()[0]};
+            vector<uint32_t> v = {pc.GetParticles()[0].id};
 
-            Histogram h(v);
+            Histogram h(pc, v);
 
             //histogram before particle moves
             vector<float> expected_x_values = {1.4142f, 1.4142f, 1.4142f, 1.4142f, 1.4142f, 1.4142f, 1.4142f, 1.4142f, 1.4142f, 1.4142f};
@@ -68,9 +69,9 @@ namespace idealgas {
 
             ParticleController pc(v_pc, 0, 10, 0, 10);
 
-            vector<Particle*> v = {&pc.GetParticles()[0], &pc.GetParticles()[1]};
+            vector<uint32_t> v = {pc.GetParticles()[0].id, pc.GetParticles()[1].id};
 
-            Histogram h(v);
+            Histogram h(pc, v);
 
             //histogram before particles move
             //bin increment: 0.1571
@@ -121,9 +122,9 @@ namespace idealgas {
 
             ParticleController pc(v_pc, 0, 10, 0, 10);
 
-            vector<Particle*> v = {&pc.GetParticles()[0], &pc.GetParticles()[1]};
+            vector<uint32_t> v = {pc.GetParticles()[0].id, pc.GetParticles()[1].id};
 
-            Histogram h(v);
+            Histogram h(pc, v);
 
             //histogram before particles collide with wall
             //bin increment: 0.1571
@@ -174,9 +175,9 @@ namespace idealgas {
 
             ParticleController pc(v_pc, 0, 10, 0, 10);
 
-            vector<Particle*> v = {&pc.GetParticles()[0], &pc.GetParticles()[1]};
+            vector<uint32_t> v = {pc.GetParticles()[0].id, pc.GetParticles()[1].id};
 
-            Histogram h(v);
+            Histogram h(pc, v);
 
             //histogram before particles collide
             //bin increment: 0.1111
@@ -227,13 +228,13 @@ namespace idealgas {
 
             ParticleController pc(v_pc, 0, 10, 0, 10);
 
-            vector<Particle*> v1 = {&pc.GetParticles()[0]};
+            vector<uint32_t> v1 = {pc.GetParticles()[0].id};
 
-            vector<Particle*> v2 = {&pc.GetParticles()[1]};
+            vector<uint32_t> v2 = {pc.GetParticles()[1].id};
 
             //diff. masses = diff. particles = 2 histograms
-            Histogram h1(v1);
-            Histogram h2(v2);
+            Histogram h1(pc, v1);
+            Histogram h2(pc, v2);
 
             //histograms before particles collide
             vector<float> expected_x_values_h1 = {2, 2, 2, 2, 2, 2, 2, 2, 2, 2};
@@ -312,13 +313,13 @@ namespace idealgas {
 
             ParticleController pc(v_pc, 0, 10, 0, 10);
 
-            vector<Particle*> v1 = {&pc.GetParticles()[0]};
+            vector<uint32_t> v1 = {pc.GetParticles()[0].id};
 
-            vector<Particle*> v2 = {&pc.GetParticles()[1]};
+            vector<uint32_t> v2 = {pc.GetParticles()[1].id};
 
             //diff. masses = diff. particles = 2 histograms
-            Histogram h1(v1);
-            Histogram h2(v2);
+            Histogram h1(pc, v1);
+            Histogram h2(pc, v2);
 
             //histograms before particles collide
             vector<float> expected_x_values_h1 = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
@@ -386,4 +387,178 @@ namespace idealgas {
             }
         }
     }
-}
\ No newline at end of file
+
+    TEST_CASE("Histogram binning strategies") {
+        /* - 9 particles with speeds 1 to 9 and one outlier with speed 100 */
+        vector<Particle> v_pc;
+        for (size_t i = 1; i <= 9; ++i) {
+            v_pc.push_back(Particle(0, glm::vec2(5, 5), glm::vec2(i, 0), 1, 1, "Red"));
+        }
+        v_pc.push_back(Particle(0, glm::vec2(5, 5), glm::vec2(100, 0), 1, 1, "Red"));
+
+        ParticleController pc(v_pc, 0, 10, 0, 10);
+
+        vector<uint32_t> v;
+        for (Particle& p : pc.GetParticles()) {
+            v.push_back(p.id);
+        }
+
+        SECTION("Fixed width histogram with a configurable number of bins") {
+            Histogram h(pc, v, BinningStrategy::kFixedWidth, 99);
+
+            REQUIRE(h.GetNumBins() == 99);
+            REQUIRE(h.GetXValues().size() == 100);
+            REQUIRE(h.GetBinFrequencies().size() == 99);
+
+            //bins are 1 wide from 1 to 100, speed 1 goes in bin 0 and speeds 2-9 each go in the bin below them
+            REQUIRE(h.GetBinFrequencies()[0] == Approx(0.2f));
+            for (size_t i = 1; i < 8; ++i) {
+                REQUIRE(h.GetBinFrequencies()[i] == Approx(0.1f));
+            }
+            REQUIRE(h.GetBinFrequencies()[98] == Approx(0.1f));
+        }
+
+        SECTION("Log scale histogram edges grow geometrically") {
+            Histogram h(pc, v, BinningStrategy::kLogScale, 2);
+
+            //edges 1, 10, 100
+            vector<float> expected_x_values = {1, 10, 100};
+            vector<float> expected_bin_freqs = {0.9f, 0.1f};
+
+            for (size_t i = 0; i < expected_x_values.size(); ++i) {
+                REQUIRE(h.GetXValues()[i] == Approx(expected_x_values[i]).epsilon(0.001));
+            }
+            for (size_t i = 0; i < expected_bin_freqs.size(); ++i) {
+                REQUIRE(h.GetBinFrequencies()[i] == Approx(expected_bin_freqs[i]));
+            }
+        }
+
+    }
+
+    TEST_CASE("Quantile sketch histogram isn't stretched by an outlier") {
+        /* - 99 particles with speeds 1 to 99 and one outlier with speed 1000 */
+        vector<Particle> v_pc;
+        for (size_t i = 1; i <= 99; ++i) {
+            v_pc.push_back(Particle(0, glm::vec2(5, 5), glm::vec2(i, 0), 1, 1, "Red"));
+        }
+        v_pc.push_back(Particle(0, glm::vec2(5, 5), glm::vec2(1000, 0), 1, 1, "Red"));
+
+        ParticleController pc(v_pc, 0, 10, 0, 10);
+
+        vector<uint32_t> v;
+        for (Particle& p : pc.GetParticles()) {
+            v.push_back(p.id);
+        }
+
+        Histogram h(pc, v, BinningStrategy::kQuantileSketch, 9);
+
+        SECTION("Edges span the 1st to 99th percentile of the speeds rather than 1 to 1000") {
+            REQUIRE(h.GetXValues().front() == 1);
+            REQUIRE(h.GetXValues().back() == 99);
+        }
+
+        SECTION("Outlier is counted in the last bin") {
+            float total_freq = 0;
+            for (float freq : h.GetBinFrequencies()) {
+                total_freq += freq;
+            }
+            REQUIRE(total_freq == Approx(1));
+            REQUIRE(h.GetBinFrequencies().back() >= 0.1f);
+        }
+    }
+
+    TEST_CASE("Species histograms hold every particle of their type") {
+        vector<Particle> v_pc = {Particle(3, glm::vec2(10, 10), glm::vec2(1, 0), 1, 1, "Red"),
+                                 Particle(1, glm::vec2(30, 10), glm::vec2(2, 0), 1, 1, "Red"),
+                                 Particle(3, glm::vec2(50, 10), glm::vec2(3, 0), 1, 1, "Red"),
+                                 Particle(2, glm::vec2(70, 10), glm::vec2(4, 0), 1, 1, "Red")};
+        ParticleController pc(v_pc, 0, 100, 0, 100);
+
+        //in the order asked for, and type 2 has no histogram
+        vector<Histogram> histograms = MakeSpeciesHistograms(pc, {3, 1}, BinningStrategy::kLogScale, 4);
+
+        REQUIRE(histograms.size() == 2);
+        REQUIRE(histograms[0].GetIds() == vector<uint32_t>({0, 2}));
+        REQUIRE(histograms[1].GetIds() == vector<uint32_t>({1}));
+        REQUIRE(histograms[0].GetBinningStrategy() == BinningStrategy::kLogScale);
+        REQUIRE(histograms[0].GetNumBins() == 4);
+    }
+
+    TEST_CASE("Parallel histogram reduction matches updating each histogram") {
+        /* - 100000 particles of types 1 to 3 with varied speeds, enough to be split across threads */
+        vector<Particle> v_pc;
+        for (size_t i = 0; i < 100000; ++i) {
+            float speed = static_cast<float>((i * 7919) % 1000) / 100;
+            v_pc.push_back(Particle(i % 3 + 1, glm::vec2(5, 5), glm::vec2(speed, 0), 1, 1, "Red"));
+        }
+
+        ParticleController pc(v_pc, 0, 10, 0, 10);
+
+        vector<vector<uint32_t>> particle_vectors(3);
+        for (Particle& p : pc.GetParticles()) {
+            particle_vectors[p.type - 1].push_back(p.id);
+        }
+
+        SECTION("Fixed width bins") {
+            vector<Histogram> expected_hists;
+            vector<Histogram> actual_hists;
+            for (size_t i = 0; i < 3; ++i) {
+                expected_hists.push_back(Histogram(pc, particle_vectors[i], BinningStrategy::kFixedWidth, 50));
+                actual_hists.push_back(Histogram(pc, particle_vectors[i], BinningStrategy::kFixedWidth, 50));
+            }
+
+            HistogramReducer reducer;
+            reducer.Reduce(actual_hists, pc.GetParticles());
+
+            for (size_t i = 0; i < 3; ++i) {
+                REQUIRE(actual_hists[i].GetXValues() == expected_hists[i].GetXValues());
+                REQUIRE(actual_hists[i].GetBinFrequencies() == expected_hists[i].GetBinFrequencies());
+            }
+        }
+
+        SECTION("Quantile sketch bins are merged from every thread") {
+            vector<Histogram> actual_hists;
+            for (size_t i = 0; i < 3; ++i) {
+                actual_hists.push_back(Histogram(pc, particle_vectors[i], BinningStrategy::kQuantileSketch, 9));
+            }
+
+            HistogramReducer reducer;
+            reducer.Reduce(actual_hists, pc.GetParticles());
+
+            for (size_t i = 0; i < 3; ++i) {
+                REQUIRE(actual_hists[i].GetSketch().GetCount() == particle_vectors[i].size());
+                REQUIRE(actual_hists[i].GetXValues().front() == Approx(0.1f).margin(0.2f));
+                REQUIRE(actual_hists[i].GetXValues().back() == Approx(9.9f).margin(0.2f));
+
+                float total_freq = 0;
+                for (float freq : actual_hists[i].GetBinFrequencies()) {
+                    total_freq += freq;
+                }
+                REQUIRE(total_freq == Approx(1));
+            }
+        }
+
+        SECTION("Particles are binned by the ids each histogram holds, not by type") {
+            //species in reverse order, and the first species split between two histograms by id
+            vector<vector<uint32_t>> id_sets = {particle_vectors[2], particle_vectors[1], {}, {}};
+            for (uint32_t id : particle_vectors[0]) {
+                id_sets[2 + id % 2].push_back(id);
+            }
+
+            vector<Histogram> expected_hists;
+            vector<Histogram> actual_hists;
+            for (const vector<uint32_t>& ids : id_sets) {
+                expected_hists.push_back(Histogram(pc, ids, BinningStrategy::kFixedWidth, 20));
+                actual_hists.push_back(Histogram(pc, ids, BinningStrategy::kFixedWidth, 20));
+            }
+
+            HistogramReducer reducer;
+            reducer.Reduce(actual_hists, pc.GetParticles());
+
+            for (size_t i = 0; i < id_sets.size(); ++i) {
+                REQUIRE(actual_hists[i].GetXValues() == expected_hists[i].GetXValues());
+                REQUIRE(actual_hists[i].GetBinFrequencies() == expected_hists[i].GetBinFrequencies());
+            }
+        }
+    }
+}
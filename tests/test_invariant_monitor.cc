@@ -0,0 +1,97 @@
+#include <catch2/catch.hpp>
+#include "core/particle_controller.h"
+#include "core/invariant_monitor.h"
+
+namespace idealgas {
+    /* - Collisions recorded directly use particles of mass 1 moving along x, so energy and momentum are easy to check
+       - Full runs use the randomly placed particles of the app's box, so plenty of collisions happen */
+
+    TEST_CASE("Invariant monitor measures drift of recorded collisions") {
+        Particle p1_before(0, glm::vec2(0, 0), glm::vec2(1, 0), 1, 1, "Red");
+        Particle p2_before(0, glm::vec2(2, 0), glm::vec2(-1, 0), 1, 1, "Red");
+
+        SECTION("Elastic collision has no drift") {
+            InvariantMonitor monitor;
+            Particle p1_after(0, glm::vec2(0, 0), glm::vec2(-1, 0), 1, 1, "Red");
+            Particle p2_after(0, glm::vec2(2, 0), glm::vec2(1, 0), 1, 1, "Red");
+
+            monitor.BeginStep();
+            monitor.RecordCollision(p1_before, p2_before, p1_after, p2_after);
+            monitor.EndStep();
+
+            REQUIRE(monitor.GetEnergyDrift() == 0);
+            REQUIRE(monitor.GetMomentumDrift() == 0);
+            REQUIRE(monitor.GetNumViolations() == 0);
+            REQUIRE(monitor.GetNumCollisions() == 1);
+        }
+
+        SECTION("Collision that loses energy is a violation") {
+            InvariantMonitor monitor;
+            //both stop: momentum is still 0, energy goes from 1 to 0
+            Particle p1_after(0, glm::vec2(0, 0), glm::vec2(0, 0), 1, 1, "Red");
+            Particle p2_after(0, glm::vec2(2, 0), glm::vec2(0, 0), 1, 1, "Red");
+
+            monitor.BeginStep();
+            monitor.RecordCollision(p1_before, p2_before, p1_after, p2_after);
+            monitor.EndStep();
+
+            REQUIRE(monitor.GetEnergyDrift() == Approx(1));
+            REQUIRE(monitor.GetMomentumDrift() == 0);
+            REQUIRE(monitor.GetNumViolations() == 1);
+        }
+
+        SECTION("Collision that creates momentum is a violation") {
+            InvariantMonitor monitor;
+            //same energy, but both move right
+            Particle p1_after(0, glm::vec2(0, 0), glm::vec2(1, 0), 1, 1, "Red");
+            Particle p2_after(0, glm::vec2(2, 0), glm::vec2(1, 0), 1, 1, "Red");
+
+            monitor.BeginStep();
+            monitor.RecordCollision(p1_before, p2_before, p1_after, p2_after);
+            monitor.EndStep();
+
+            REQUIRE(monitor.GetEnergyDrift() == 0);
+            REQUIRE(monitor.GetMomentumDrift() == Approx(1));
+            REQUIRE(monitor.GetNumViolations() == 1);
+        }
+
+        SECTION("Throw policy aborts on a violation") {
+            InvariantMonitor monitor(1e-4f, 1e-4f, InvariantPolicy::kThrow);
+            Particle p1_after(0, glm::vec2(0, 0), glm::vec2(0, 0), 1, 1, "Red");
+
+            monitor.BeginStep();
+            monitor.RecordCollision(p1_before, p2_before, p1_after, p2_before);
+
+            REQUIRE_THROWS_AS(monitor.EndStep(), InvariantViolation);
+        }
+
+        SECTION("Drift is measured per step") {
+            InvariantMonitor monitor;
+            Particle p1_after(0, glm::vec2(0, 0), glm::vec2(0, 0), 1, 1, "Red");
+
+            monitor.BeginStep();
+            monitor.RecordCollision(p1_before, p2_before, p1_after, p2_before);
+            monitor.EndStep();
+            monitor.BeginStep();
+            monitor.EndStep();
+
+            REQUIRE(monitor.GetEnergyDrift() == 0);
+            REQUIRE(monitor.GetMaxEnergyDrift() == Approx(0.5));
+        }
+    }
+
+    TEST_CASE("Collisions in a full run conserve energy and momentum") {
+        ParticleController pc(600, glm::vec2(0, 0), 5);
+        InvariantMonitor monitor(1e-4f, 1e-4f, InvariantPolicy::kThrow);
+        pc.SetInvariantMonitor(&monitor);
+
+        for (size_t i = 0; i < 200; ++i) {
+            REQUIRE_NOTHROW(pc.UpdateParticles());
+        }
+
+        REQUIRE(monitor.GetNumCollisions() > 0);
+        REQUIRE(monitor.GetNumViolations() == 0);
+        REQUIRE(monitor.GetMaxEnergyDrift() < 1e-4f);
+        REQUIRE(monitor.GetMaxMomentumDrift() < 1e-4f);
+    }
+}
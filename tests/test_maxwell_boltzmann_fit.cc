@@ -0,0 +1,116 @@
+#include <catch2/catch.hpp>
+#include <cmath>
+#include "core/particle_controller.h"
+#include "core/histogram.h"
+#include "core/maxwell_boltzmann_fit.h"
+
+namespace idealgas {
+    /* - Particles with speeds at evenly spaced quantiles of a 2D Maxwell-Boltzmann distribution
+         are used to build histograms with a known temperature */
+
+    vector<Particle> MakeMaxwellBoltzmannParticles(const size_t num, const float mass, const float temperature) {
+        vector<Particle> particles;
+        for (size_t i = 0; i < num; ++i) {
+            //inverse of the cumulative distribution: v = sqrt(-2kT ln(1 - q) / m)
+            float quantile = (i + 0.5f) / num;
+            float speed = sqrt(-2 * temperature * log(1 - quantile) / mass);
+            particles.push_back(Particle(0, glm::vec2(5, 5), glm::vec2(speed, 0), mass, 1, "Red"));
+        }
+        return particles;
+    }
+
+    TEST_CASE("Cumulative probability of a 2D Maxwell-Boltzmann distribution") {
+        SECTION("No particles are slower than 0") {
+            REQUIRE(MaxwellBoltzmannFit::CumulativeProbability(0, 10, 5) == 0);
+        }
+
+        SECTION("Speed of sqrt(2kT / m) has cumulative probability 1 - 1/e") {
+            REQUIRE(MaxwellBoltzmannFit::CumulativeProbability(1, 10, 5) == Approx(1 - exp(-1)).epsilon(0.001));
+        }
+    }
+
+    TEST_CASE("Maxwell-Boltzmann fit of histogram bins") {
+        SECTION("Fit recovers temperature of Maxwell-Boltzmann distributed speeds") {
+            vector<Particle> v_pc = MakeMaxwellBoltzmannParticles(1000, 10, 20);
+            ParticleController pc(v_pc, 0, 10, 0, 10);
+
+            vector<uint32_t> v;
+            for (Particle& p : pc.GetParticles()) {
+                v.push_back(p.id);
+            }
+
+            Histogram h(pc, v);
+            MaxwellBoltzmannFit fit(10);
+            FitResult result = fit.Fit(h.GetXValues(), h.GetBinFrequencies(), v.size());
+
+            REQUIRE(result.temperature == Approx(20).epsilon(0.05));
+            REQUIRE(sqrt(1000.0f) * result.ks_statistic < 1.36f);
+            REQUIRE(result.expected_frequencies.size() == h.GetBinFrequencies().size());
+        }
+
+        SECTION("Particles that all have the same speed don't fit") {
+            vector<Particle> v_pc;
+            for (size_t i = 0; i < 100; ++i) {
+                v_pc.push_back(Particle(0, glm::vec2(5, 5), glm::vec2(1, 1), 10, 1, "Red"));
+            }
+            ParticleController pc(v_pc, 0, 10, 0, 10);
+
+            vector<uint32_t> v;
+            for (Particle& p : pc.GetParticles()) {
+                v.push_back(p.id);
+            }
+
+            Histogram h(pc, v);
+            MaxwellBoltzmannFit fit(10);
+            FitResult result = fit.Fit(h.GetXValues(), h.GetBinFrequencies(), v.size());
+
+            //kT = m<v^2> / 2 = 10 * 2 / 2
+            REQUIRE(result.temperature == Approx(10).epsilon(0.001));
+            REQUIRE(sqrt(100.0f) * result.ks_statistic > 1.36f);
+        }
+
+        SECTION("Fit of an empty histogram reports the worst KS statistic") {
+            MaxwellBoltzmannFit fit(10);
+            FitResult result = fit.Fit(vector<float>(), vector<float>(), 0);
+
+            REQUIRE(result.temperature == 0);
+            REQUIRE(result.ks_statistic == 1);
+        }
+    }
+
+    TEST_CASE("Maxwell-Boltzmann fit reports equilibrium") {
+        vector<Particle> v_pc = MakeMaxwellBoltzmannParticles(1000, 10, 20);
+        ParticleController pc(v_pc, 0, 10, 0, 10);
+
+        vector<uint32_t> v;
+        for (Particle& p : pc.GetParticles()) {
+            v.push_back(p.id);
+        }
+
+        Histogram h(pc, v);
+        MaxwellBoltzmannFit fit(10, 1.36f, 3);
+
+        SECTION("Not equilibrated until enough updates pass in a row") {
+            fit.Update(h);
+            fit.Update(h);
+            REQUIRE_FALSE(fit.IsEquilibrated());
+
+            fit.Update(h);
+            REQUIRE(fit.IsEquilibrated());
+        }
+
+        SECTION("A failing update resets equilibrium") {
+            fit.Update(h);
+            fit.Update(h);
+            fit.Update(h);
+            REQUIRE(fit.IsEquilibrated());
+
+            for (Particle& p : pc.GetParticles()) {
+                p.speed = 1;
+            }
+            h.UpdateHistogram();
+            fit.Update(h);
+            REQUIRE_FALSE(fit.IsEquilibrated());
+        }
+    }
+}
@@ -0,0 +1,145 @@
+#include <catch2/catch.hpp>
+#include <algorithm>
+#include "core/invariant_monitor.h"
+#include "core/neighbour_list.h"
+#include "core/particle_controller.h"
+#include "core/particle_placer.h"
+
+namespace idealgas {
+    /* - Lists are checked against comparing every pair of particles
+       - Controllers using the list run the same seeded boxes as ones using range queries, and should see about
+         the same collisions */
+
+    vector<Particle> MakeNeighbourTestParticles(const size_t num, const float box_width, const float max_speed) {
+        ParticlePlacer placer(0, box_width, 0, box_width, 5);
+        vector<Particle> particles = placer.MakeParticles({{1, num, 1, 2, max_speed, cinder::Colorf(1, 1, 1)}});
+        //lists are built straight from these, without a controller to give out ids
+        for (size_t i = 0; i < particles.size(); ++i) {
+            particles[i].id = static_cast<uint32_t>(i);
+        }
+        return particles;
+    }
+
+    TEST_CASE("Neighbour list holds every pair within range") {
+        vector<Particle> particles = MakeNeighbourTestParticles(500, 200, 0.5f);
+        //leaves id 500 unused, and puts one particle far outside the box
+        particles.back().id = 501;
+        particles.back().pos = glm::vec2(5000, -3000);
+        NeighbourList neighbour_list(3);
+        neighbour_list.Build(particles, 502, 2);
+
+        const vector<uint32_t>& offsets = neighbour_list.GetOffsets();
+        const vector<uint32_t>& neighbour_ids = neighbour_list.GetNeighbourIds();
+
+        SECTION("Rows match comparing every pair") {
+            REQUIRE(offsets.size() == 503);
+            size_t num_pairs = 0;
+            for (const Particle& p1 : particles) {
+                vector<uint32_t> expected;
+                for (const Particle& p2 : particles) {
+                    if (p1.id != p2.id && glm::distance(ToVec2(p1.pos), ToVec2(p2.pos)) <= 7) expected.push_back(p2.id);
+                }
+                vector<uint32_t> row(neighbour_ids.begin() + offsets[p1.id], neighbour_ids.begin() + offsets[p1.id + 1]);
+                std::sort(expected.begin(), expected.end());
+                std::sort(row.begin(), row.end());
+                REQUIRE(row == expected);
+                num_pairs += row.size();
+            }
+            REQUIRE(num_pairs > 0);
+            REQUIRE(num_pairs == neighbour_ids.size());
+        }
+
+        SECTION("Unused ids have empty rows") {
+            REQUIRE(offsets[500] == offsets[501]);
+            REQUIRE(offsets[501] == offsets[502]);
+        }
+
+        SECTION("Particles only need a rebuild once they've moved more than half the skin") {
+            REQUIRE(neighbour_list.GetSkin() == 3);
+            Particle p = particles[0];
+            REQUIRE_FALSE(neighbour_list.HasMovedTooFar(p));
+            p.pos = glm::vec2(ToVec2(p.pos)) + glm::vec2(1.4f, 0);
+            REQUIRE_FALSE(neighbour_list.HasMovedTooFar(p));
+            p.pos = glm::vec2(ToVec2(p.pos)) + glm::vec2(0, 0.6f);
+            REQUIRE(neighbour_list.HasMovedTooFar(p));
+        }
+
+        SECTION("Invalidated list needs a rebuild") {
+            neighbour_list.Invalidate();
+            REQUIRE_FALSE(neighbour_list.IsValid());
+            REQUIRE(neighbour_list.HasMovedTooFar(particles[0]));
+            neighbour_list.Build(particles, 502, 2);
+            REQUIRE(neighbour_list.IsValid());
+            REQUIRE(neighbour_list.GetNumBuilds() == 2);
+        }
+
+        SECTION("Skin is widened for fast particles") {
+            size_t num_narrow_pairs = neighbour_ids.size();
+            particles[0].vel = glm::vec2(3, 4);
+            neighbour_list.Build(particles, 502, 2);
+            REQUIRE(neighbour_list.GetSkin() == 20);
+            REQUIRE(neighbour_list.GetNeighbourIds().size() > num_narrow_pairs);
+        }
+    }
+
+    TEST_CASE("Controller finds collisions with a neighbour list") {
+        vector<Particle> particles = MakeNeighbourTestParticles(1000, 200, 0.2f);
+
+        SECTION("Nearly the same collisions as range queries in a dense, slow gas") {
+            ParticleController reference(particles, 0, 200, 0, 200);
+            ParticleController candidate(particles, 0, 200, 0, 200);
+            candidate.SetNeighbourListSkin(2);
+            InvariantMonitor reference_monitor;
+            InvariantMonitor candidate_monitor;
+            reference.SetInvariantMonitor(&reference_monitor);
+            candidate.SetInvariantMonitor(&candidate_monitor);
+            for (size_t step = 0; step < 100; ++step) {
+                reference.UpdateParticles();
+                candidate.UpdateParticles();
+            }
+
+            REQUIRE(reference_monitor.GetNumCollisions() > 0);
+            //not exactly the same: pairs are visited in a different order, and the range queries' corners miss a few
+            //touching pairs lined up with an axis, which the list doesn't
+            REQUIRE(candidate_monitor.GetNumCollisions() == Approx(reference_monitor.GetNumCollisions()).epsilon(0.02));
+            REQUIRE(candidate_monitor.GetNumViolations() == 0);
+            REQUIRE(candidate.GetTemperature() == Approx(reference.GetTemperature()).epsilon(0.01));
+            //slow particles take several steps to cross half the skin, so most steps reuse the list
+            REQUIRE(candidate.GetNumNeighbourListBuilds() > 1);
+            REQUIRE(candidate.GetNumNeighbourListBuilds() < 50);
+        }
+
+        SECTION("Added and removed particles are picked up") {
+            vector<Particle> pair = {Particle(1, glm::vec2(50, 50), glm::vec2(1, 0), 1, 2, "White")};
+            ParticleController particle_controller(pair, 0, 200, 0, 200);
+            particle_controller.SetNeighbourListSkin(1);
+            particle_controller.UpdateParticles();
+            uint32_t id = particle_controller.AddParticle(Particle(1, glm::vec2(56, 50), glm::vec2(-1, 0), 1, 2, "White"));
+            particle_controller.UpdateParticles();
+            particle_controller.UpdateParticles();
+
+            REQUIRE(particle_controller.GetParticle(0).vel.x < 0);
+            REQUIRE(particle_controller.GetParticle(id).vel.x > 0);
+            REQUIRE(particle_controller.GetNumNeighbourListBuilds() >= 2);
+
+            particle_controller.RemoveParticle(id);
+            particle_controller.UpdateParticles();
+            REQUIRE(particle_controller.GetParticles().size() == 1);
+        }
+
+        SECTION("Going back to range queries still finds collisions") {
+            vector<Particle> pair = {Particle(1, glm::vec2(50, 50), glm::vec2(1, 0), 1, 2, "White"),
+                                     Particle(1, glm::vec2(56, 50), glm::vec2(-1, 0), 1, 2, "White")};
+            ParticleController particle_controller(pair, 0, 200, 0, 200);
+            particle_controller.SetNeighbourListSkin(1);
+            particle_controller.UpdateParticles();
+            particle_controller.SetNeighbourListSkin(0);
+            particle_controller.UpdateParticles();
+            particle_controller.UpdateParticles();
+
+            REQUIRE(particle_controller.GetNumNeighbourListBuilds() == 0);
+            REQUIRE(particle_controller.GetParticle(0).vel.x < 0);
+            REQUIRE(particle_controller.GetParticle(1).vel.x > 0);
+        }
+    }
+}
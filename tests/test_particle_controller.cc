@@ -0,0 +1,421 @@
+#include <catch2/catch.hpp>
+#include "core/particle_controller.h"
+#include "core/histogram.h"
+#include "core/spatial_sort.h"
+
+namespace idealgas {
+    /* - Bounds passed to ParticleController (0, 10, 0, 10) simulates a 10x10 box */
+
+    TEST_CASE("Particles get stable ids") {
+        glm::vec2 pos1(1, 1);
+        glm::vec2 vel1(1, 0);
+        Particle p1(0, pos1, vel1, 1, 1, "Red");
+
+        glm::vec2 pos2(5, 5);
+        glm::vec2 vel2(0, 2);
+        Particle p2(0, pos2, vel2, 1, 1, "Red");
+
+        glm::vec2 pos3(8, 8);
+        glm::vec2 vel3(-3, 0);
+        Particle p3(0, pos3, vel3, 1, 1, "Red");
+
+        vector<Particle> v = {p1, p2, p3};
+
+        ParticleController pc(v, 0, 10, 0, 10);
+
+        SECTION("Ids are assigned in order") {
+            for (size_t i = 0; i < 3; ++i) {
+                REQUIRE(pc.GetParticles()[i].id == i);
+                REQUIRE(pc.GetIndex(static_cast<uint32_t>(i)) == i);
+            }
+        }
+
+        SECTION("Ids still refer to the same particles after storage is permuted") {
+            vector<uint32_t> order = {2, 0, 1};
+            pc.PermuteParticles(order);
+
+            REQUIRE(glm::vec2(pc.GetParticles()[0].pos) == pos3);
+            REQUIRE(glm::vec2(pc.GetParticle(0).pos) == pos1);
+            REQUIRE(glm::vec2(pc.GetParticle(1).pos) == pos2);
+            REQUIRE(glm::vec2(pc.GetParticle(2).pos) == pos3);
+            REQUIRE(pc.GetIndex(2) == 0);
+        }
+
+        SECTION("Particles still move correctly after storage is permuted") {
+            vector<uint32_t> order = {1, 2, 0};
+            pc.PermuteParticles(order);
+            pc.UpdateParticles();
+
+            REQUIRE(glm::vec2(pc.GetParticle(0).pos) == glm::vec2(2, 1));
+            REQUIRE(glm::vec2(pc.GetParticle(1).pos) == glm::vec2(5, 7));
+            REQUIRE(glm::vec2(pc.GetParticle(2).pos) == glm::vec2(5, 8));
+        }
+
+        SECTION("Histogram still bins the same particles after storage is permuted") {
+            vector<uint32_t> ids = {0, 1};
+            Histogram h(pc, ids);
+
+            vector<uint32_t> order = {2, 1, 0};
+            pc.PermuteParticles(order);
+            h.UpdateHistogram();
+
+            //speeds 1 and 2, not 3
+            REQUIRE(h.GetXValues().front() == 1);
+            REQUIRE(h.GetXValues().back() == 2);
+        }
+    }
+
+    TEST_CASE("Particles created by the controller have unique ids") {
+        ParticleController pc(500, glm::vec2(0, 0), 10);
+
+        vector<bool> seen(pc.GetParticles().size(), false);
+        for (Particle& p : pc.GetParticles()) {
+            REQUIRE(p.id < seen.size());
+            REQUIRE_FALSE(seen[p.id]);
+            seen[p.id] = true;
+            REQUIRE(&pc.GetParticle(p.id) == &p);
+        }
+    }
+
+    TEST_CASE("Species are known without any of their particles in the box") {
+        ParticleController pc(500, glm::vec2(0, 0), 10);
+        pc.RemoveParticlesIf([](const Particle& p) { return p.type == 2; });
+
+        ParticleSpecies species = pc.GetSpecies(2);
+        REQUIRE(species.type == 2);
+        REQUIRE(species.mass == 50);
+        REQUIRE(species.radius == 20);
+        REQUIRE(species.color.r == 1);
+        REQUIRE_THROWS_AS(pc.GetSpecies(4), std::out_of_range);
+    }
+}
+
+namespace idealgas {
+    TEST_CASE("Morton keys follow the Z-order curve") {
+        SECTION("Bits of x and y are interleaved") {
+            REQUIRE(MortonKey(0, 0) == 0);
+            REQUIRE(MortonKey(1, 0) == 1);
+            REQUIRE(MortonKey(0, 1) == 2);
+            REQUIRE(MortonKey(1, 1) == 3);
+            REQUIRE(MortonKey(2, 0) == 4);
+            REQUIRE(MortonKey(3, 5) == 39);
+        }
+    }
+
+    TEST_CASE("Radix sort orders keys and carries values along") {
+        vector<uint32_t> keys;
+        vector<uint32_t> values;
+        for (uint32_t i = 0; i < 200000; ++i) {
+            keys.push_back((i * 2654435761u) % 1000003);
+            values.push_back(i);
+        }
+        vector<uint32_t> original_keys = keys;
+
+        RadixSortByKey(keys, values);
+
+        bool is_sorted = true;
+        bool values_match = true;
+        for (size_t i = 0; i < keys.size(); ++i) {
+            if (i > 0 && keys[i - 1] > keys[i]) is_sorted = false;
+            if (original_keys[values[i]] != keys[i]) values_match = false;
+        }
+
+        REQUIRE(is_sorted);
+        REQUIRE(values_match);
+    }
+
+    TEST_CASE("Particles are re-sorted along the Morton curve") {
+        /* - 4 particles in opposite corners of a 100x100 box, stored so neighbours in storage are far apart */
+        vector<Particle> v = {Particle(0, glm::vec2(5, 5), glm::vec2(0, 0), 1, 1, "Red"),
+                              Particle(0, glm::vec2(95, 95), glm::vec2(0, 0), 1, 1, "Red"),
+                              Particle(0, glm::vec2(6, 5), glm::vec2(0, 0), 1, 1, "Red"),
+                              Particle(0, glm::vec2(95, 96), glm::vec2(0, 0), 1, 1, "Red")};
+
+        ParticleController pc(v, 0, 100, 0, 100);
+
+        SECTION("Scattered fraction measures locality of storage") {
+            pc.SetReorderThreshold(0.9f);
+            pc.UpdateParticles();
+            REQUIRE(pc.GetScatteredFraction() == Approx(0.75f));
+        }
+
+        SECTION("Scattered fraction isn't measured while the reorder check is disabled") {
+            pc.UpdateParticles();
+            REQUIRE(pc.GetScatteredFraction() == 0);
+        }
+
+        SECTION("Reordering puts particles in the same cells next to each other") {
+            pc.SetReorderThreshold(0.9f);
+            pc.ReorderParticles();
+            pc.UpdateParticles();
+
+            REQUIRE(pc.GetScatteredFraction() == Approx(0.25f));
+            REQUIRE(pc.GetParticles()[0].id == 0);
+            REQUIRE(pc.GetParticles()[1].id == 2);
+            REQUIRE(glm::vec2(pc.GetParticle(3).pos) == glm::vec2(95, 96));
+        }
+
+        SECTION("Particles are re-sorted on a schedule") {
+            pc.SetReorderInterval(2);
+            pc.UpdateParticles();
+            REQUIRE(pc.GetParticles()[1].id == 1);
+
+            pc.UpdateParticles();
+            REQUIRE(pc.GetParticles()[1].id == 2);
+        }
+
+        SECTION("Particles are re-sorted when locality degrades") {
+            pc.SetReorderThreshold(0.5f);
+            pc.UpdateParticles();
+            REQUIRE(pc.GetParticles()[1].id == 2);
+        }
+    }
+
+    TEST_CASE("Scattered fraction uses the cells particles are sorted by") {
+        /* - Box starting at x = 1 with 2 px cells: particles at x = 2.5 and 5.5 are 2 cells apart from the box's
+             corner, though they'd be adjacent in cells measured from x = 0 */
+        vector<Particle> v = {Particle(0, glm::vec2(2.5f, 2), glm::vec2(0, 0), 1, 1, "Red"),
+                              Particle(0, glm::vec2(5.5f, 2), glm::vec2(0, 0), 1, 1, "Red")};
+
+        ParticleController pc(v, 1, 101, 1, 101);
+        pc.SetReorderThreshold(0.9f);
+        pc.UpdateParticles();
+
+        REQUIRE(pc.GetScatteredFraction() == Approx(0.5f));
+    }
+}
+
+namespace idealgas {
+    /* Records what it's told about, to check the controller notifies observers */
+    class RecordingObserver : public ParticleObserver {
+        public:
+            void OnParticleAdded(const Particle& p) override { added.push_back(p.id); }
+            void OnParticleRemoved(const Particle& p) override { removed.push_back(p.id); }
+            vector<uint32_t> added;
+            vector<uint32_t> removed;
+    };
+
+    TEST_CASE("Particles the same distance from the origin are all found by range queries") {
+        /* - A at (48, 14) and B at (30, 40) are both 50 px from the origin, C is approaching B and stored
+             between them, so C is checked after A has moved and before B has */
+        vector<Particle> v = {Particle(1, glm::vec2(48, 14), glm::vec2(0, 0), 1, 1, "Red"),
+                              Particle(1, glm::vec2(30, 41.5f), glm::vec2(0, -1), 1, 1, "Red"),
+                              Particle(1, glm::vec2(30, 40), glm::vec2(0, 0), 1, 1, "Red")};
+
+        ParticleController pc(v, 0, 100, 0, 100);
+        pc.UpdateParticles();
+
+        //C hits B before moving, so it's left where it was and B carries on with its velocity
+        REQUIRE(glm::vec2(pc.GetParticle(1).pos).y == Approx(41.5f));
+        REQUIRE(pc.GetParticle(1).vel.y == Approx(0).margin(1e-5f));
+        REQUIRE(pc.GetParticle(2).vel.y == Approx(-1));
+    }
+
+    TEST_CASE("Particles can be added and removed during a run") {
+        vector<Particle> v = {Particle(0, glm::vec2(1, 1), glm::vec2(1, 0), 1, 1, "Red"),
+                              Particle(0, glm::vec2(5, 5), glm::vec2(0, 1), 1, 1, "Red"),
+                              Particle(0, glm::vec2(8, 2), glm::vec2(0, 2), 1, 1, "Red")};
+
+        ParticleController pc(v, 0, 10, 0, 10);
+        RecordingObserver observer;
+        pc.AddObserver(&observer);
+
+        SECTION("Added particle gets a new id and moves") {
+            uint32_t id = pc.AddParticle(Particle(0, glm::vec2(2, 8), glm::vec2(1, 0), 1, 1, "Red"));
+            pc.UpdateParticles();
+
+            REQUIRE(id == 3);
+            REQUIRE(pc.GetParticles().size() == 4);
+            REQUIRE(glm::vec2(pc.GetParticle(id).pos) == glm::vec2(3, 8));
+            REQUIRE(observer.added == vector<uint32_t>{3});
+        }
+
+        SECTION("Removed particle's slot is filled by the last particle") {
+            pc.RemoveParticle(0);
+
+            REQUIRE(pc.GetParticles().size() == 2);
+            REQUIRE_FALSE(pc.HasParticle(0));
+            REQUIRE(pc.GetIndex(2) == 0);
+            REQUIRE(glm::vec2(pc.GetParticle(2).pos) == glm::vec2(8, 2));
+            REQUIRE(observer.removed == vector<uint32_t>{0});
+        }
+
+        SECTION("Ids of removed particles are reused") {
+            pc.RemoveParticle(1);
+            uint32_t id = pc.AddParticle(Particle(0, glm::vec2(2, 8), glm::vec2(1, 0), 1, 1, "Red"));
+
+            REQUIRE(id == 1);
+            REQUIRE(pc.HasParticle(1));
+            REQUIRE(glm::vec2(pc.GetParticle(1).pos) == glm::vec2(2, 8));
+        }
+
+        SECTION("Removed particle no longer collides") {
+            uint32_t id = pc.AddParticle(Particle(0, glm::vec2(3, 1), glm::vec2(-1, 0), 1, 1, "Red"));
+            pc.RemoveParticle(id);
+            pc.UpdateParticles();
+
+            REQUIRE(glm::vec2(pc.GetParticle(0).vel) == glm::vec2(1, 0));
+        }
+
+        SECTION("Particles past an open boundary are removed") {
+            vector<uint32_t> removed = pc.RemoveParticlesIf([](const Particle& p) { return p.pos.x > 4; });
+
+            REQUIRE(removed.size() == 2);
+            REQUIRE(pc.GetParticles().size() == 1);
+            REQUIRE(pc.GetParticles()[0].id == 0);
+            REQUIRE(observer.removed.size() == 2);
+        }
+
+        SECTION("Histogram is updated incrementally") {
+            vector<uint32_t> ids = {0, 1, 2};
+            Histogram h(pc, ids);
+
+            pc.RemoveParticle(2);
+            h.RemoveId(2);
+            uint32_t id = pc.AddParticle(Particle(0, glm::vec2(2, 8), glm::vec2(4, 0), 1, 1, "Red"));
+            h.AddId(id);
+            h.UpdateHistogram();
+
+            REQUIRE(h.GetIds().size() == 3);
+            REQUIRE(h.GetXValues().back() == 4);
+        }
+
+        SECTION("Histogram of removed particles is empty") {
+            vector<uint32_t> ids = {0};
+            Histogram h(pc, ids);
+
+            pc.RemoveParticle(0);
+            h.RemoveId(0);
+            h.UpdateHistogram();
+
+            for (float freq : h.GetBinFrequencies()) {
+                REQUIRE(freq == 0);
+            }
+        }
+    }
+
+    TEST_CASE("Particles collide with ghosts, which stay as they were") {
+        /* - Particle at (8, 5) moving right touches a ghost at (9.5, 5) past the open right wall, and one far away
+             at (9.5, 1) is never touched */
+        vector<Particle> v = {Particle(1, glm::vec2(8, 5), glm::vec2(1, 0), 1, 1, "Red")};
+        ParticleController pc(v, 0, 9, 0, 10);
+        pc.SetOpenWalls(false, true);
+        RecordingObserver observer;
+        pc.AddObserver(&observer);
+
+        vector<Particle> ghosts = {Particle(1, glm::vec2(9.5f, 1), glm::vec2(0, 0), 1, 1, "Red"),
+                                   Particle(1, glm::vec2(9.5f, 5), glm::vec2(-1, 0), 1, 1, "Red")};
+
+        SECTION("Range queries") {}
+        SECTION("Neighbour list") { pc.SetNeighbourListSkin(1); }
+        SECTION("Hierarchical grid") { pc.SetHierarchicalGrid(true); }
+
+        pc.SetGhosts(ghosts);
+        pc.UpdateParticles();
+
+        REQUIRE(pc.GetParticles().size() == 1);
+        REQUIRE(glm::vec2(pc.GetParticle(0).vel) == glm::vec2(-1, 0));
+        REQUIRE(observer.added.empty());
+
+        //once cleared, nothing is in the particle's way
+        pc.SetGhosts(vector<Particle>());
+        pc.GetParticle(0).vel = glm::vec2(1, 0);
+        pc.UpdateParticles();
+
+        REQUIRE(glm::vec2(pc.GetParticle(0).vel) == glm::vec2(1, 0));
+    }
+}
+
+namespace idealgas {
+    TEST_CASE("Queued commands are applied at the start of the next step") {
+        glm::vec2 pos(5, 5);
+        glm::vec2 vel(1, 0);
+        Particle p(0, pos, vel, 1, 1, "Red");
+
+        vector<Particle> v = {p};
+
+        ParticleController pc(v, 0, 100, 0, 10);
+
+        SECTION("Commands don't change anything until the next step") {
+            pc.EnqueueCommand(SimulationCommand::TemperatureRamp(4, 1));
+
+            REQUIRE(glm::vec2(pc.GetParticles()[0].vel) == glm::vec2(1, 0));
+        }
+
+        SECTION("Temperature ramp is spread over several steps") {
+            //4x the temperature = 2x the speed, sqrt(2) per step
+            pc.EnqueueCommand(SimulationCommand::TemperatureRamp(4, 2));
+
+            pc.UpdateParticles();
+            REQUIRE(pc.GetParticles()[0].vel.x == Approx(1.4142f));
+
+            pc.UpdateParticles();
+            REQUIRE(pc.GetParticles()[0].vel.x == Approx(2));
+            REQUIRE(pc.GetParticles()[0].speed == Approx(2));
+
+            pc.UpdateParticles();
+            REQUIRE(pc.GetParticles()[0].vel.x == Approx(2));
+        }
+
+        SECTION("Paused simulation doesn't move") {
+            pc.EnqueueCommand(SimulationCommand::Pause());
+            pc.UpdateParticles();
+            pc.UpdateParticles();
+
+            REQUIRE(pc.IsPaused());
+            REQUIRE(glm::vec2(pc.GetParticles()[0].pos) == glm::vec2(5, 5));
+        }
+
+        SECTION("Single step advances a paused simulation by one step") {
+            pc.EnqueueCommand(SimulationCommand::Pause());
+            pc.EnqueueCommand(SimulationCommand::SingleStep());
+            pc.UpdateParticles();
+            pc.UpdateParticles();
+
+            REQUIRE(glm::vec2(pc.GetParticles()[0].pos) == glm::vec2(6, 5));
+        }
+
+        SECTION("Resumed simulation moves again") {
+            pc.EnqueueCommand(SimulationCommand::Pause());
+            pc.UpdateParticles();
+            pc.EnqueueCommand(SimulationCommand::Resume());
+            pc.UpdateParticles();
+
+            REQUIRE_FALSE(pc.IsPaused());
+            REQUIRE(glm::vec2(pc.GetParticles()[0].pos) == glm::vec2(6, 5));
+        }
+
+        SECTION("Wall moves to its target over several steps") {
+            pc.EnqueueCommand(SimulationCommand::MoveWall(60, 4));
+
+            pc.UpdateParticles();
+            REQUIRE(pc.GetXMax() == 90);
+
+            pc.UpdateParticles();
+            pc.UpdateParticles();
+            pc.UpdateParticles();
+            pc.UpdateParticles();
+            REQUIRE(pc.GetXMax() == 60);
+        }
+    }
+
+    TEST_CASE("Particle bounces off a moving wall") {
+        glm::vec2 pos(8, 5);
+        glm::vec2 vel(1, 0);
+        Particle p(0, pos, vel, 1, 1, "Red");
+
+        vector<Particle> v = {p};
+
+        ParticleController pc(v, 0, 10, 0, 10);
+
+        //wall moves left at 1 per step, meets the particle at x = 9 - 1 (radius)
+        pc.EnqueueCommand(SimulationCommand::MoveWall(5, 5));
+        pc.UpdateParticles();
+        pc.UpdateParticles();
+
+        SECTION("Particle is reflected in the wall's frame, gaining speed") {
+            //v' = 2 * (-1) - 1
+            REQUIRE(glm::vec2(pc.GetParticles()[0].vel) == glm::vec2(-3, 0));
+        }
+    }
+}
@@ -0,0 +1,172 @@
+#include <catch2/catch.hpp>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include "core/particle_controller.h"
+#include "core/particle_placer.h"
+
+namespace idealgas {
+    /* - Placements are checked pair by pair, so they stay at a few hundred particles
+       - Particles "overlap" if their centers are closer than the sum of their radii */
+
+    bool AnyOverlap(const vector<glm::vec2>& positions, const float radius) {
+        for (size_t i = 0; i < positions.size(); ++i) {
+            for (size_t j = i + 1; j < positions.size(); ++j) {
+                if (glm::length(positions[i] - positions[j]) < 2 * radius) return true;
+            }
+        }
+        return false;
+    }
+
+    bool AllInside(const vector<glm::vec2>& positions, const float radius, const float min, const float max) {
+        for (const glm::vec2& pos : positions) {
+            if (pos.x < min + radius || pos.x > max - radius || pos.y < min + radius || pos.y > max - radius) return false;
+        }
+        return true;
+    }
+
+    TEST_CASE("Lattice placement") {
+        ParticlePlacer placer(0, 100, 0, 100, 3);
+
+        SECTION("Places every particle inside the box without overlaps") {
+            vector<glm::vec2> positions = placer.PlaceOnLattice(300, 2);
+            REQUIRE(positions.size() == 300);
+            REQUIRE(AllInside(positions, 2, 0, 100));
+            REQUIRE_FALSE(AnyOverlap(positions, 2));
+        }
+
+        SECTION("Same seed gives the same positions") {
+            REQUIRE(placer.PlaceOnLattice(50, 2) == ParticlePlacer(0, 100, 0, 100, 3).PlaceOnLattice(50, 2));
+            REQUIRE(placer.PlaceOnLattice(50, 2) != ParticlePlacer(0, 100, 0, 100, 4).PlaceOnLattice(50, 2));
+        }
+
+        SECTION("Throws if the particles can't fit") {
+            REQUIRE_THROWS_AS(placer.PlaceOnLattice(300, 4), std::runtime_error);
+        }
+    }
+
+    TEST_CASE("Poisson disk placement") {
+        ParticlePlacer placer(0, 100, 0, 100, 5);
+
+        SECTION("Places every particle inside the box without overlaps") {
+            vector<glm::vec2> positions = placer.PlacePoissonDisk(200, 2);
+            REQUIRE(positions.size() == 200);
+            REQUIRE(AllInside(positions, 2, 0, 100));
+            REQUIRE_FALSE(AnyOverlap(positions, 2));
+        }
+
+        SECTION("Throws if the particles can't fit") {
+            REQUIRE_THROWS_AS(placer.PlacePoissonDisk(200, 5), std::runtime_error);
+        }
+    }
+
+    TEST_CASE("Controller placement strategies") {
+        SECTION("Lattice placement starts with no overlapping particles") {
+            ParticleController particle_controller(740, glm::vec2(50, 80), 15, PlacementStrategy::kLatticeJitter);
+            vector<Particle>& particles = particle_controller.GetParticles();
+            REQUIRE(particles.size() == 75);
+
+            bool any_overlap = false;
+            for (size_t i = 0; i < particles.size(); ++i) {
+                for (size_t j = i + 1; j < particles.size(); ++j) {
+                    float dist = glm::length(ToVec2(particles[i].pos) - ToVec2(particles[j].pos));
+                    any_overlap = any_overlap || dist < particles[i].radius + particles[j].radius;
+                }
+            }
+            REQUIRE_FALSE(any_overlap);
+        }
+    }
+
+    TEST_CASE("Making particles of several species") {
+        ParticlePlacer placer(0, 200, 0, 200, 4);
+        vector<ParticleSpecies> species = {{2, 100, 1, 2, 1, cinder::Colorf(1, 0, 0)}, {5, 50, 10, 4, 3, cinder::Colorf(0, 1, 0)}};
+        vector<Particle> particles = placer.MakeParticles(species);
+
+        SECTION("Species are made in order with their own properties and speeds") {
+            REQUIRE(particles.size() == 150);
+            REQUIRE(particles[99].type == 2);
+            REQUIRE(particles[100].type == 5);
+            REQUIRE(particles[100].mass == 10);
+            REQUIRE(particles[100].color.g == 1);
+            for (const Particle& p : particles) {
+                float max_speed = p.type == 2 ? 1 : 3;
+                REQUIRE(std::abs(p.vel.x) <= max_speed);
+                REQUIRE(std::abs(p.vel.y) <= max_speed);
+            }
+        }
+
+        SECTION("Positions are the placer's, spaced for the largest radius") {
+            //both sides stored at the build's precision, which rounds them in fixed point builds
+            vector<glm::vec2> positions;
+            vector<glm::vec2> lattice_positions;
+            for (const glm::vec2& pos : placer.PlaceOnLattice(150, 4)) {
+                lattice_positions.push_back(glm::vec2(ToVec2(Position(pos))));
+            }
+            for (const Particle& p : particles) {
+                positions.push_back(glm::vec2(ToVec2(p.pos)));
+            }
+            REQUIRE(positions == lattice_positions);
+            REQUIRE_FALSE(AnyOverlap(positions, 4));
+        }
+
+        SECTION("The same seed makes the same particles") {
+            vector<Particle> again = placer.MakeParticles(species);
+            REQUIRE(glm::vec2(again[120].vel) == glm::vec2(particles[120].vel));
+        }
+    }
+
+    TEST_CASE("Snapshots") {
+        string path = "idealgas_snapshot_test.bin";
+
+        SECTION("Loading a saved snapshot gives back the same particles") {
+            vector<Particle> particles = {Particle(1, glm::vec2(10, 20), glm::vec2(1, -1), 10, 2, cinder::Colorf(1, 0, 0)),
+                                          Particle(3, glm::vec2(40, 50), glm::vec2(-0.5, 2), 300, 6, cinder::Colorf(0, 1, 0))};
+            ParticlePlacer::SaveSnapshot(path, particles);
+            vector<Particle> loaded = ParticlePlacer::LoadSnapshot(path);
+            std::remove(path.c_str());
+
+            REQUIRE(loaded.size() == 2);
+            REQUIRE(loaded[1].type == 3);
+            REQUIRE(glm::vec2(ToVec2(loaded[1].pos)) == glm::vec2(40, 50));
+            REQUIRE(glm::vec2(loaded[1].vel) == glm::vec2(-0.5, 2));
+            REQUIRE(loaded[1].mass == 300);
+            REQUIRE(loaded[1].radius == 6);
+            REQUIRE(loaded[0].color.r == 1);
+        }
+
+        SECTION("Positions load back exactly in every precision") {
+            //not a float value in double builds, and not a float value on the fixed point grid in fixed point builds
+            vector<Particle> particles = {Particle(1, glm::vec2(0, 0), glm::vec2(0.1f, 0), 1, 1, cinder::Colorf(1, 0, 0))};
+            Advance(particles[0].pos, Vec2(30000.1, 1.0 / 3));
+            ParticlePlacer::SaveSnapshot(path, particles);
+            vector<Particle> loaded = ParticlePlacer::LoadSnapshot(path);
+            std::remove(path.c_str());
+
+            REQUIRE(static_cast<double>(loaded[0].pos.x) == static_cast<double>(particles[0].pos.x));
+            REQUIRE(static_cast<double>(loaded[0].pos.y) == static_cast<double>(particles[0].pos.y));
+            REQUIRE(loaded[0].vel.x == particles[0].vel.x);
+        }
+
+        SECTION("Loading a missing or foreign file throws") {
+            REQUIRE_THROWS_AS(ParticlePlacer::LoadSnapshot(path + ".missing"), std::runtime_error);
+        }
+
+        SECTION("A count larger than the file holds throws before anything is allocated") {
+            vector<Particle> particles = {Particle(1, glm::vec2(10, 20), glm::vec2(1, -1), 10, 2, cinder::Colorf(1, 0, 0))};
+            ParticlePlacer::SaveSnapshot(path, particles);
+
+            //the count follows the 4 byte magic and 4 byte version
+            uint64_t huge_count = uint64_t(1) << 60;
+            std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(8);
+            file.write(reinterpret_cast<const char*>(&huge_count), sizeof(huge_count));
+            file.close();
+
+            REQUIRE_THROWS_AS(ParticlePlacer::LoadSnapshot(path), std::runtime_error);
+            std::remove(path.c_str());
+        }
+    }
+}
@@ -0,0 +1,54 @@
+#include <catch2/catch.hpp>
+#include <cstdlib>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include "core/performance_scenarios.h"
+
+#ifndef IDEALGAS_PERFORMANCE_BASELINE
+#define IDEALGAS_PERFORMANCE_BASELINE "tests/performance_baseline.txt"
+#endif
+
+namespace idealgas {
+    /* - Hidden behind the [.performance] tag, so they only run when asked for: ideal-gas-test "[performance]"
+       - Each scenario's best of 3 timed runs is compared against tests/performance_baseline.txt, along with its
+         collision count (from an untimed run with an InvariantMonitor), which shows whether the work done changed
+       - IDEALGAS_PERF_TOLERANCE sets the allowed relative slowdown (default 0.25), and IDEALGAS_UPDATE_BASELINE=1
+         rewrites the baseline with the measured values instead of comparing */
+
+    TEST_CASE("Physics core throughput stays within tolerance of the baseline", "[.performance]") {
+        const char* tolerance_env = std::getenv("IDEALGAS_PERF_TOLERANCE");
+        double tolerance = tolerance_env != nullptr ? std::atof(tolerance_env) : 0.25;
+        bool should_update = std::getenv("IDEALGAS_UPDATE_BASELINE") != nullptr;
+        std::map<string, PerformanceResult> baselines = ReadPerformanceResults(IDEALGAS_PERFORMANCE_BASELINE);
+
+        std::ostringstream updated;
+        updated << "# scenario steps_per_second collisions, written by IDEALGAS_UPDATE_BASELINE=1 ideal-gas-test \"[performance]\"\n";
+
+        for (const PerformanceScenario& scenario : kPerformanceScenarios) {
+            size_t num_collisions = CountScenarioCollisions(scenario);
+            double steps_per_second = MeasureStepsPerSecond(scenario);
+            WritePerformanceResult(updated, scenario.name, {steps_per_second, num_collisions});
+
+            //CHECK rather than REQUIRE, so one slow scenario doesn't hide the others
+            INFO(scenario.name << ": " << steps_per_second << " steps/s, " << num_collisions << " collisions");
+            if (should_update) continue;
+            if (baselines.count(scenario.name) == 0) {
+                WARN("no baseline for " << scenario.name);
+                continue;
+            }
+
+            const PerformanceResult& baseline = baselines[scenario.name];
+            INFO("baseline: " << baseline.steps_per_second << " steps/s, " << baseline.num_collisions << " collisions");
+            //a different collision count means the physics changed, so the timings aren't comparable
+            CHECK(std::abs(static_cast<double>(num_collisions) - baseline.num_collisions) <= tolerance * baseline.num_collisions);
+            CHECK(steps_per_second >= (1 - tolerance) * baseline.steps_per_second);
+        }
+
+        if (should_update) {
+            std::ofstream out(IDEALGAS_PERFORMANCE_BASELINE);
+            out << updated.str();
+            REQUIRE(out.good());
+        }
+    }
+}
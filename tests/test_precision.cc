@@ -0,0 +1,53 @@
+#include <catch2/catch.hpp>
+#include "core/precision.h"
+#include <vector>
+
+namespace idealgas {
+    /* - Fixed point tests run in every build, the selected Position type is only used through its traits */
+
+    TEST_CASE("Fixed point numbers") {
+        SECTION("Values on the fixed point grid round trip exactly") {
+            REQUIRE(static_cast<double>(FixedPoint(1.5)) == 1.5);
+            REQUIRE(static_cast<double>(FixedPoint(-20000.25)) == -20000.25);
+        }
+
+        SECTION("Other values are rounded to the nearest grid point") {
+            double resolution = 1.0 / (1 << IDEALGAS_FIXED_FRACTION_BITS);
+            REQUIRE(static_cast<double>(FixedPoint(0.1)) == Approx(0.1).margin(resolution / 2));
+        }
+
+        SECTION("Resolution is the same far from the origin") {
+            FixedPoint near(0.1);
+            FixedPoint far(30000.1);
+            REQUIRE(far.GetRaw() - near.GetRaw() == FixedPoint(30000).GetRaw());
+        }
+    }
+
+    TEST_CASE("Fixed point positions") {
+        SECTION("Advancing doesn't depend on the order velocities are added in") {
+            FixedVec2 forward(glm::vec2(1000, 1000));
+            FixedVec2 backward(glm::vec2(1000, 1000));
+            std::vector<glm::vec2> vels = {glm::vec2(0.1f, -0.3f), glm::vec2(1e-3f, 2.7f), glm::vec2(-5.1f, 0.01f)};
+
+            for (size_t i = 0; i < vels.size(); ++i) {
+                PositionTraits<FixedVec2>::Advance(forward, vels[i]);
+                PositionTraits<FixedVec2>::Advance(backward, vels[vels.size() - 1 - i]);
+            }
+
+            REQUIRE(forward.x.GetRaw() == backward.x.GetRaw());
+            REQUIRE(forward.y.GetRaw() == backward.y.GetRaw());
+        }
+
+        SECTION("Converts to a float vector") {
+            FixedVec2 pos(glm::vec2(3.5f, -2));
+            REQUIRE(glm::vec2(pos) == glm::vec2(3.5f, -2));
+        }
+    }
+
+    TEST_CASE("Selected position type") {
+        Position pos = Position(glm::vec2(1, 2));
+        Advance(pos, Vec2(0.5f, -1));
+
+        REQUIRE(glm::vec2(ToVec2(pos)) == glm::vec2(1.5f, 1));
+    }
+}
@@ -0,0 +1,88 @@
+#include <catch2/catch.hpp>
+#include "core/quantile_sketch.h"
+
+namespace idealgas {
+    /* - Values 0, 1, ..., n - 1 are inserted so the exact q quantile is q * n */
+
+    TEST_CASE("Quantile sketch of a small stream is exact") {
+        QuantileSketch sketch;
+        for (size_t i = 1; i <= 10; ++i) {
+            sketch.Insert(static_cast<float>(i));
+        }
+
+        SECTION("Min and max are the smallest and largest values") {
+            REQUIRE(sketch.GetMin() == 1);
+            REQUIRE(sketch.GetMax() == 10);
+            REQUIRE(sketch.Quantile(0) == 1);
+            REQUIRE(sketch.Quantile(1) == 10);
+        }
+
+        SECTION("Median is the middle value") {
+            REQUIRE(sketch.Quantile(0.5f) == 5);
+        }
+    }
+
+    TEST_CASE("Quantile sketch of a large stream") {
+        QuantileSketch sketch(200);
+        for (size_t i = 0; i < 100000; ++i) {
+            sketch.Insert(static_cast<float>(i));
+        }
+
+        SECTION("Memory stays bounded") {
+            REQUIRE(sketch.GetCount() == 100000);
+            REQUIRE(sketch.GetNumRetained() < 1000);
+        }
+
+        SECTION("Quantiles are within 2% of the exact values") {
+            REQUIRE(sketch.Quantile(0.1f) == Approx(10000).margin(2000));
+            REQUIRE(sketch.Quantile(0.5f) == Approx(50000).margin(2000));
+            REQUIRE(sketch.Quantile(0.99f) == Approx(99000).margin(2000));
+        }
+    }
+
+    TEST_CASE("Merged quantile sketches summarize both streams") {
+        QuantileSketch evens(200);
+        QuantileSketch odds(200);
+        for (size_t i = 0; i < 50000; ++i) {
+            evens.Insert(static_cast<float>(2 * i));
+            odds.Insert(static_cast<float>(2 * i + 1));
+        }
+
+        evens.Merge(odds);
+
+        SECTION("Count, min and max cover both streams") {
+            REQUIRE(evens.GetCount() == 100000);
+            REQUIRE(evens.GetMin() == 0);
+            REQUIRE(evens.GetMax() == 99999);
+        }
+
+        SECTION("Quantiles are within 2% of the exact values of the combined stream") {
+            REQUIRE(evens.Quantile(0.25f) == Approx(25000).margin(2000));
+            REQUIRE(evens.Quantile(0.75f) == Approx(75000).margin(2000));
+        }
+
+        SECTION("Memory stays bounded after merging") {
+            REQUIRE(evens.GetNumRetained() < 1000);
+        }
+    }
+
+    TEST_CASE("A cleared quantile sketch is refilled like a new one") {
+        QuantileSketch reused(200);
+        for (size_t frame = 0; frame < 3; ++frame) {
+            reused.Clear();
+            for (size_t i = 0; i < 20000; ++i) {
+                reused.Insert(static_cast<float>((i * 7919 + frame) % 20000));
+            }
+        }
+        QuantileSketch fresh(200);
+        for (size_t i = 0; i < 20000; ++i) {
+            fresh.Insert(static_cast<float>((i * 7919 + 2) % 20000));
+        }
+
+        REQUIRE(reused.GetCount() == 20000);
+        REQUIRE(reused.GetNumRetained() == fresh.GetNumRetained());
+        for (float fraction : {0.1f, 0.5f, 0.9f}) {
+            REQUIRE(reused.Quantile(fraction) == fresh.Quantile(fraction));
+        }
+    }
+}
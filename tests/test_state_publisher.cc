@@ -0,0 +1,117 @@
+#include <catch2/catch.hpp>
+#include <stdexcept>
+#include <string>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include "core/particle_controller.h"
+#include "core/histogram.h"
+#include "core/state_publisher.h"
+
+namespace idealgas {
+    /* - Segments are named after the test process so parallel test runs don't share one
+       - The publisher and reader are in the same process, which reads the segment the same way another process would */
+
+    std::string TestSegmentName() {
+        return "/idealgas-test-" + std::to_string(getpid());
+    }
+
+    TEST_CASE("Published state can be read back") {
+        vector<Particle> v = {Particle(1, glm::vec2(2, 3), glm::vec2(3, 4), 10, 1, "Red"),
+                              Particle(1, glm::vec2(7, 7), glm::vec2(0, 1), 10, 1, "Red")};
+        ParticleController pc(v, 0, 10, 0, 10);
+        vector<Histogram> histograms = {Histogram(pc, {0, 1})};
+
+        StatePublisher publisher(TestSegmentName(), 100, 1, 9);
+        StateReader reader(TestSegmentName());
+        publisher.Publish(pc.GetParticles(), histograms, 12.5f);
+
+        StateFrame frame;
+        REQUIRE(reader.ReadFrame(frame));
+
+        SECTION("Frame has the particles") {
+            REQUIRE(frame.frame == 1);
+            REQUIRE(frame.temperature == 12.5f);
+            REQUIRE(frame.particles.size() == 2);
+            REQUIRE(frame.particles[0].x == 2);
+            REQUIRE(frame.particles[0].y == 3);
+            REQUIRE(frame.particles[0].speed == 5);
+            REQUIRE(frame.particles[1].id == 1);
+        }
+
+        SECTION("Frame has the histogram bins") {
+            REQUIRE(frame.x_values.size() == 1);
+            REQUIRE(frame.x_values[0] == histograms[0].GetXValues());
+            REQUIRE(frame.bin_frequencies[0] == histograms[0].GetBinFrequencies());
+        }
+
+        SECTION("Later frames replace earlier ones") {
+            pc.UpdateParticles();
+            publisher.Publish(pc.GetParticles(), histograms, 13);
+
+            REQUIRE(reader.ReadFrame(frame));
+            REQUIRE(frame.frame == 2);
+            REQUIRE(frame.temperature == 13);
+            REQUIRE(frame.particles[0].x == 5);
+        }
+    }
+
+    TEST_CASE("Zero-copy reads detect frames written during the read") {
+        vector<Particle> v = {Particle(1, glm::vec2(2, 3), glm::vec2(3, 4), 10, 1, "Red")};
+        vector<Histogram> histograms;
+        StatePublisher publisher(TestSegmentName(), 10, 0, 9);
+        StateReader reader(TestSegmentName());
+        publisher.Publish(v, histograms, 1);
+
+        uint64_t sequence = 0;
+        REQUIRE(reader.BeginRead(sequence));
+        REQUIRE(reader.GetParticles()[0].x == 2);
+        REQUIRE(reader.EndRead(sequence));
+
+        REQUIRE(reader.BeginRead(sequence));
+        publisher.Publish(v, histograms, 1);
+        REQUIRE_FALSE(reader.EndRead(sequence));
+    }
+
+    TEST_CASE("Reads give up on a publisher that never finishes a frame") {
+        vector<Particle> v = {Particle(1, glm::vec2(2, 3), glm::vec2(3, 4), 10, 1, "Red")};
+        vector<Histogram> histograms;
+        StatePublisher publisher(TestSegmentName(), 10, 0, 9);
+        StateReader reader(TestSegmentName());
+        publisher.Publish(v, histograms, 1);
+
+        //a publisher that died mid-frame leaves the sequence odd
+        int fd = shm_open(TestSegmentName().c_str(), O_RDWR, 0);
+        REQUIRE(fd >= 0);
+        void* memory = mmap(nullptr, sizeof(SharedStateHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        REQUIRE(memory != MAP_FAILED);
+        static_cast<SharedStateHeader*>(memory)->sequence.fetch_add(1);
+
+        uint64_t sequence = 0;
+        StateFrame frame;
+        REQUIRE_FALSE(reader.BeginRead(sequence, 10));
+        REQUIRE_FALSE(reader.ReadFrame(frame, 10));
+
+        static_cast<SharedStateHeader*>(memory)->sequence.fetch_add(1);
+        REQUIRE(reader.ReadFrame(frame, 10));
+        munmap(memory, sizeof(SharedStateHeader));
+    }
+
+    TEST_CASE("Publisher writes at most the segment's capacity") {
+        vector<Particle> v(5, Particle(1, glm::vec2(2, 3), glm::vec2(3, 4), 10, 1, "Red"));
+        vector<Histogram> histograms;
+        StatePublisher publisher(TestSegmentName(), 3, 0, 9);
+        StateReader reader(TestSegmentName());
+
+        publisher.Publish(v, histograms, 1);
+
+        StateFrame frame;
+        REQUIRE(reader.ReadFrame(frame));
+        REQUIRE(frame.particles.size() == 3);
+    }
+
+    TEST_CASE("Reader can't open a segment that doesn't exist") {
+        REQUIRE_THROWS_AS(StateReader("/idealgas-test-missing"), std::runtime_error);
+    }
+}
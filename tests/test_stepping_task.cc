@@ -0,0 +1,165 @@
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <random>
+#include "core/histogram_reducer.h"
+#include "core/stepping_task.h"
+
+namespace idealgas {
+    /* - Boxes of 300 particles of 3 species, stepped by a task and by UpdateParticles from the same start
+       - A budget of 0 lets every Resume do exactly one slice, rebuild or reorder */
+
+    vector<Particle> MakeSteppingTestParticles() {
+        std::mt19937 random_engine(21);
+        std::uniform_real_distribution<float> coordinate(10, 290);
+        std::uniform_real_distribution<float> vel_component(-2, 2);
+
+        vector<Particle> particles;
+        for (size_t i = 0; i < 300; ++i) {
+            size_t type = 1 + i % 3;
+            particles.push_back(Particle(type, glm::vec2(coordinate(random_engine), coordinate(random_engine)),
+                                         glm::vec2(vel_component(random_engine), vel_component(random_engine)),
+                                         static_cast<float>(type), 2 + static_cast<float>(type), "White"));
+        }
+        return particles;
+    }
+
+    TEST_CASE("Stepping task gives the same result as UpdateParticles") {
+        vector<Particle> particles = MakeSteppingTestParticles();
+        ParticleController reference(particles, 0, 300, 0, 300);
+        ParticleController sliced(particles, 0, 300, 0, 300);
+        vector<Histogram> reference_histograms = MakeSpeciesHistograms(reference, {1, 2, 3});
+        vector<Histogram> sliced_histograms = MakeSpeciesHistograms(sliced, {1, 2, 3});
+        HistogramReducer reducer;
+        SteppingTask task(sliced, &sliced_histograms, 16);
+
+        for (size_t step = 0; step < 5; ++step) {
+            reference.UpdateParticles();
+            reducer.Reduce(reference_histograms, reference.GetParticles());
+            while (!task.Resume(std::chrono::microseconds(0))) {}
+        }
+
+        for (const Particle& p : reference.GetParticles()) {
+            const Particle& sliced_p = sliced.GetParticle(p.id);
+            REQUIRE(ToVec2(sliced_p.pos) == ToVec2(p.pos));
+            REQUIRE(sliced_p.vel == p.vel);
+        }
+        REQUIRE(sliced.GetTemperature() == reference.GetTemperature());
+        for (size_t h = 0; h < 3; ++h) {
+            REQUIRE(sliced_histograms[h].GetXValues() == reference_histograms[h].GetXValues());
+            REQUIRE(sliced_histograms[h].GetBinFrequencies() == reference_histograms[h].GetBinFrequencies());
+        }
+    }
+
+    TEST_CASE("Stepping task returns between slices") {
+        vector<Particle> particles = MakeSteppingTestParticles();
+        ParticleController particle_controller(particles, 0, 300, 0, 300);
+        vector<Histogram> histograms = MakeSpeciesHistograms(particle_controller, {1, 2, 3});
+
+        SECTION("Each phase is split into slices") {
+            SteppingTask task(particle_controller, &histograms, 100);
+            REQUIRE_FALSE(task.Resume(std::chrono::microseconds(0)));
+            REQUIRE(task.GetPhase() == StepPhase::kUpdateParticles);
+            for (size_t slice = 0; slice < 3; ++slice) {
+                REQUIRE_FALSE(task.Resume(std::chrono::microseconds(0)));
+            }
+            REQUIRE(task.GetPhase() == StepPhase::kHistogramRanges);
+            while (!task.Resume(std::chrono::microseconds(0))) {}
+
+            //applying commands, then 3 slices for each of the update, ranges and counts
+            REQUIRE(task.IsDone());
+            REQUIRE(task.GetNumResumesPerStep() == 10);
+        }
+
+        SECTION("Without histograms the step ends after the update") {
+            SteppingTask task(particle_controller, nullptr, 100);
+            while (!task.Resume(std::chrono::microseconds(0))) {}
+            REQUIRE(task.GetNumResumesPerStep() == 4);
+        }
+
+        SECTION("A long enough budget finishes the step in one call") {
+            SteppingTask task(particle_controller, &histograms, 100);
+            REQUIRE(task.Resume(std::chrono::seconds(10)));
+            REQUIRE(task.Resume(std::chrono::microseconds::max()));
+            REQUIRE(task.GetNumResumesPerStep() == 1);
+        }
+
+        SECTION("A step in progress can be finished at once") {
+            ParticleController reference(particles, 0, 300, 0, 300);
+            reference.UpdateParticles();
+            SteppingTask task(particle_controller, nullptr, 100);
+            task.Resume(std::chrono::microseconds(0));
+            task.Resume(std::chrono::microseconds(0));
+            task.RunToCompletion();
+
+            REQUIRE(task.IsDone());
+            REQUIRE(task.GetNumResumesPerStep() == 3);
+            REQUIRE(particle_controller.GetTemperature() == reference.GetTemperature());
+        }
+
+        SECTION("Paused controller doesn't move, but its histograms are updated") {
+            particle_controller.EnqueueCommand(SimulationCommand::Pause());
+            SteppingTask task(particle_controller, &histograms, 100);
+            task.RunToCompletion();
+
+            REQUIRE(ToVec2(particle_controller.GetParticles()[0].pos) == ToVec2(particles[0].pos));
+            float total_frequency = 0;
+            for (float frequency : histograms[0].GetBinFrequencies()) {
+                total_frequency += frequency;
+            }
+            REQUIRE(total_frequency == Approx(1));
+        }
+    }
+
+    /* Each particle's position, by id */
+    vector<Vec2> GetPositionsById(ParticleController& particle_controller, const size_t num) {
+        vector<Vec2> positions;
+        for (uint32_t id = 0; id < num; ++id) {
+            positions.push_back(ToVec2(particle_controller.GetParticle(id).pos));
+        }
+        return positions;
+    }
+
+    TEST_CASE("Rebuilds and reorders run in Resume calls of their own") {
+        vector<Particle> particles = MakeSteppingTestParticles();
+        ParticleController reference(particles, 0, 300, 0, 300);
+        ParticleController sliced(particles, 0, 300, 0, 300);
+        for (ParticleController* particle_controller : {&reference, &sliced}) {
+            //a thin skin is outgrown within a step or two, so the list is rebuilt partway through steps
+            particle_controller->SetNeighbourListSkin(0.5f);
+            particle_controller->SetReorderInterval(1);
+        }
+        SteppingTask task(sliced, nullptr, 64);
+
+        size_t num_rebuilds = 0;
+        size_t num_mid_step_rebuilds = 0;
+        size_t num_reorders = 0;
+        for (size_t step = 0; step < 10; ++step) {
+            reference.UpdateParticles();
+            bool has_updated = false;
+            do {
+                StepPhase phase = task.IsDone() ? StepPhase::kStart : task.GetPhase();
+                size_t num_builds = sliced.GetNumNeighbourListBuilds();
+                vector<Vec2> positions = GetPositionsById(sliced, particles.size());
+                task.Resume(std::chrono::microseconds(0));
+
+                //a call that rebuilds or reorders moves no particles, and only the rebuild phase builds
+                bool has_built = sliced.GetNumNeighbourListBuilds() > num_builds;
+                REQUIRE(has_built == (phase == StepPhase::kRebuild));
+                if (phase == StepPhase::kRebuild || phase == StepPhase::kReorder) {
+                    REQUIRE(GetPositionsById(sliced, particles.size()) == positions);
+                }
+                num_rebuilds += has_built;
+                num_mid_step_rebuilds += has_built && has_updated;
+                num_reorders += phase == StepPhase::kReorder;
+                has_updated = has_updated || phase == StepPhase::kUpdateParticles;
+            } while (!task.IsDone());
+        }
+
+        REQUIRE(num_reorders == 10);
+        REQUIRE(num_rebuilds == sliced.GetNumNeighbourListBuilds());
+        REQUIRE(num_mid_step_rebuilds > 0);
+        //stopping a slice for a rebuild leaves the trajectory the same as rebuilding inside the update
+        REQUIRE(sliced.GetNumNeighbourListBuilds() == reference.GetNumNeighbourListBuilds());
+        REQUIRE(GetPositionsById(sliced, particles.size()) == GetPositionsById(reference, particles.size()));
+    }
+}
@@ -0,0 +1,108 @@
+#include <catch2/catch.hpp>
+#include "core/particle_controller.h"
+#include "core/thermostat.h"
+
+namespace idealgas {
+    /* - Temperature is the mean kinetic energy per particle: kT = <mv^2 / 2>
+       - Particles are spread out in a 1000x1000 box so they don't collide */
+
+    vector<Particle> MakeSpreadOutParticles(const size_t num, const glm::vec2& vel) {
+        vector<Particle> particles;
+        for (size_t i = 0; i < num; ++i) {
+            glm::vec2 pos(100 + (i % 30) * 25, 100 + (i / 30) * 25);
+            particles.push_back(Particle(0, pos, vel, 2, 1, "Red"));
+        }
+        return particles;
+    }
+
+    TEST_CASE("Temperature is measured during the update") {
+        vector<Particle> v = MakeSpreadOutParticles(10, glm::vec2(3, 4));
+        ParticleController pc(v, 0, 1000, 0, 1000);
+
+        pc.UpdateParticles();
+
+        //0.5 * 2 * 25
+        REQUIRE(pc.GetTemperature() == Approx(25));
+    }
+
+    TEST_CASE("Velocity rescale thermostat holds the target temperature") {
+        vector<Particle> v = MakeSpreadOutParticles(10, glm::vec2(3, 4));
+        ParticleController pc(v, 0, 1000, 0, 1000);
+
+        pc.SetThermostat(std::unique_ptr<Thermostat>(new VelocityRescaleThermostat(100)));
+        pc.UpdateParticles();
+
+        SECTION("Temperature reaches the target in one step") {
+            REQUIRE(pc.GetTemperature() == Approx(100));
+            REQUIRE(pc.GetParticles()[0].speed == Approx(10));
+        }
+
+        SECTION("Temperature stays at the target") {
+            pc.UpdateParticles();
+            pc.UpdateParticles();
+            REQUIRE(pc.GetTemperature() == Approx(100));
+        }
+    }
+
+    TEST_CASE("Berendsen thermostat relaxes towards the target temperature") {
+        vector<Particle> v = MakeSpreadOutParticles(10, glm::vec2(3, 4));
+        ParticleController pc(v, 0, 1000, 0, 1000);
+
+        pc.SetThermostat(std::unique_ptr<Thermostat>(new BerendsenThermostat(100, 10)));
+
+        SECTION("Temperature moves a tenth of the way each step") {
+            pc.UpdateParticles();
+            //25 + (100 - 25) / 10
+            REQUIRE(pc.GetTemperature() == Approx(32.5f));
+        }
+
+        SECTION("Temperature approaches the target") {
+            for (size_t i = 0; i < 100; ++i) {
+                pc.UpdateParticles();
+            }
+            REQUIRE(pc.GetTemperature() == Approx(100).epsilon(0.01));
+        }
+    }
+
+    TEST_CASE("Andersen thermostat draws velocities at the target temperature") {
+        vector<Particle> v = MakeSpreadOutParticles(900, glm::vec2(0, 0));
+        ParticleController pc(v, 0, 1000, 0, 1000);
+
+        //every particle collides with the heat bath every step
+        pc.SetThermostat(std::unique_ptr<Thermostat>(new AndersenThermostat(10, 1, 42)));
+        pc.UpdateParticles();
+
+        REQUIRE(pc.GetTemperature() == Approx(10).epsilon(0.1));
+    }
+
+    TEST_CASE("Thermal walls send particles away from the wall") {
+        glm::vec2 pos(1, 5);
+        glm::vec2 vel(-1, 0);
+        Particle p(0, pos, vel, 1, 1, "Red");
+
+        vector<Particle> v = {p};
+
+        ParticleController pc(v, 0, 10, 0, 10);
+
+        pc.SetThermostat(std::unique_ptr<Thermostat>(new ThermalWallThermostat(5, 7)));
+        pc.UpdateParticles();
+
+        REQUIRE(pc.GetParticles()[0].vel.x > 0);
+    }
+
+    TEST_CASE("Removing the thermostat restores elastic walls") {
+        glm::vec2 pos(1, 5);
+        glm::vec2 vel(-1, 0);
+        Particle p(0, pos, vel, 1, 1, "Red");
+
+        vector<Particle> v = {p};
+
+        ParticleController pc(v, 0, 10, 0, 10);
+
+        pc.SetThermostat(std::unique_ptr<Thermostat>(new ThermalWallThermostat(5, 7)));
+        pc.SetThermostat(nullptr);
+        pc.UpdateParticles();
+
+        REQUIRE(glm::vec2(pc.GetParticles()[0].vel) == glm::vec2(1, 0));
+    }
+}
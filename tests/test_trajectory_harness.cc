@@ -0,0 +1,151 @@
+#include <catch2/catch.hpp>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include "core/particle_placer.h"
+#include "core/trajectory_harness.h"
+
+namespace idealgas {
+    /* - Every run starts from the same seeded box of 100 particles, so the reference engine matches itself exactly
+       - Candidates that differ are the reference with its velocities changed, before or during the run, or with
+         other particle ids
+       - The neighbour list and hierarchical grid controller modes are compared against range queries */
+
+    vector<Particle> MakeSeededParticles(const size_t num) {
+        ParticlePlacer placer(0, 200, 0, 200, 9);
+        return placer.MakeParticles({{1, num, 1, 4, 2, cinder::Colorf(1, 1, 1)}});
+    }
+
+    TEST_CASE("Comparing engines side by side") {
+        vector<Particle> particles = MakeSeededParticles(100);
+        TrajectoryHarness harness;
+
+        SECTION("Reference engine doesn't diverge from itself") {
+            ControllerEngine reference(particles, 0, 200, 0, 200);
+            ControllerEngine candidate(particles, 0, 200, 0, 200);
+            TrajectoryReport report = harness.Compare(reference, candidate, 100);
+
+            REQUIRE(report.are_particles_matched);
+            REQUIRE(report.steps.size() == 101);
+            REQUIRE(report.max_position_error == 0);
+            REQUIRE(report.max_velocity_error == 0);
+            REQUIRE(report.total_collision_difference == 0);
+            REQUIRE(report.max_histogram_delta == 0);
+            REQUIRE(reference.GetNumCollisions() > 0);
+        }
+
+        SECTION("A small velocity change shows up as divergence that grows") {
+            vector<Particle> nudged = particles;
+            nudged[0].vel += glm::vec2(0.01f, 0);
+            ControllerEngine reference(particles, 0, 200, 0, 200);
+            ControllerEngine candidate(nudged, 0, 200, 0, 200);
+            TrajectoryReport report = harness.Compare(reference, candidate, 100);
+
+            REQUIRE(report.steps[0].max_position_error == 0);
+            REQUIRE(report.steps[0].max_velocity_error > 0);
+            REQUIRE(report.steps[100].max_position_error > report.steps[1].max_position_error);
+            REQUIRE(report.FirstDivergentStep(0.001f) > 0);
+            REQUIRE(report.FirstDivergentStep(0.001f) < 101);
+        }
+
+        SECTION("Faster particles change the speed histograms") {
+            ControllerEngine reference(particles, 0, 200, 0, 200);
+            ControllerEngine candidate(particles, 0, 200, 0, 200);
+            candidate.GetController().ChangeSpeeds(true);
+            candidate.GetController().ChangeSpeeds(true);
+            TrajectoryReport report = harness.Compare(reference, candidate, 20);
+
+            REQUIRE(report.max_histogram_delta > 0);
+            REQUIRE(report.max_velocity_error > 0);
+        }
+
+        SECTION("Different particles aren't compared") {
+            ControllerEngine reference(particles, 0, 200, 0, 200);
+            ControllerEngine candidate(MakeSeededParticles(50), 0, 200, 0, 200);
+            TrajectoryReport report = harness.Compare(reference, candidate, 5);
+
+            REQUIRE_FALSE(report.are_particles_matched);
+            REQUIRE(report.steps.empty());
+        }
+
+        SECTION("The same number of particles with different ids aren't compared") {
+            ControllerEngine reference(particles, 0, 200, 0, 200);
+            ControllerEngine candidate(MakeSeededParticles(101), 0, 200, 0, 200);
+            candidate.GetController().RemoveParticle(0);
+            TrajectoryReport report = harness.Compare(reference, candidate, 5);
+
+            REQUIRE_FALSE(report.are_particles_matched);
+            REQUIRE(report.steps.empty());
+        }
+    }
+
+    TEST_CASE("Collision search modes against the range query reference") {
+        vector<Particle> particles = MakeSeededParticles(100);
+        TrajectoryHarness harness;
+        ControllerEngine reference(particles, 0, 200, 0, 200);
+        ControllerEngine candidate(particles, 0, 200, 0, 200);
+
+        SECTION("Neighbour list") {
+            candidate.GetController().SetNeighbourListSkin(2);
+        }
+
+        SECTION("Hierarchical grid") {
+            candidate.GetController().SetHierarchicalGrid(true);
+        }
+
+        TrajectoryReport report = harness.Compare(reference, candidate, 200);
+        REQUIRE(report.are_particles_matched);
+        REQUIRE(report.steps.size() == 201);
+        //the same trajectory until two collisions in one step are resolved in a different order, after which the
+        //gas is chaotic, so only its statistics still agree
+        REQUIRE(report.FirstDivergentStep(0.001f) >= 10);
+        REQUIRE(std::abs(report.total_collision_difference) <= 0.1 * reference.GetNumCollisions());
+        REQUIRE(report.max_histogram_delta < 0.25f);
+    }
+
+    TEST_CASE("Golden trajectories") {
+        vector<Particle> particles = MakeSeededParticles(100);
+        string path = "idealgas_golden_test.bin";
+
+        SECTION("Saved and loaded trajectory matches a fresh reference run") {
+            ControllerEngine recorded(particles, 0, 200, 0, 200);
+            GoldenTrajectory recording = TrajectoryHarness::Record(recorded, 50);
+            recording.Save(path);
+            GoldenTrajectory golden = GoldenTrajectory::Load(path);
+            std::remove(path.c_str());
+
+            REQUIRE(golden.frames.size() == 51);
+            REQUIRE(golden.frames[0].positions.size() == 100);
+            REQUIRE(golden.frames[50].ids == recording.frames[50].ids);
+
+            ControllerEngine candidate(particles, 0, 200, 0, 200);
+            TrajectoryReport report = TrajectoryHarness().Compare(golden, candidate);
+            REQUIRE(report.steps.size() == 51);
+            REQUIRE(report.max_position_error == 0);
+            REQUIRE(report.total_collision_difference == 0);
+        }
+
+        SECTION("Loading a missing file throws") {
+            REQUIRE_THROWS_AS(GoldenTrajectory::Load(path + ".missing"), std::runtime_error);
+        }
+
+        SECTION("Counts larger than the file holds throw before anything is allocated") {
+            ControllerEngine recorded(particles, 0, 200, 0, 200);
+            TrajectoryHarness::Record(recorded, 2).Save(path);
+
+            //the frame count follows the 4 byte magic and 4 byte version, and the particle count follows it
+            std::streamoff count_offset = 8;
+            SECTION("Frame count") {}
+            SECTION("Particle count") { count_offset = 16; }
+            uint64_t huge_count = uint64_t(1) << 60;
+            std::fstream file(path, std::ios::binary | std::ios::in | std::ios::out);
+            file.seekp(count_offset);
+            file.write(reinterpret_cast<const char*>(&huge_count), sizeof(huge_count));
+            file.close();
+
+            REQUIRE_THROWS_AS(GoldenTrajectory::Load(path), std::runtime_error);
+            std::remove(path.c_str());
+        }
+    }
+}